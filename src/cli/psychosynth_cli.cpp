@@ -21,7 +21,12 @@
  ***************************************************************************/
 
 #include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <iostream>
+#include <map>
 
+#include <boost/filesystem/path.hpp>
 #include <boost/optional.hpp>
 
 #include <psynth/net/osc_client.hpp>
@@ -31,6 +36,10 @@
 #include <psynth/net/osc_server_logger.hpp>
 #include <psynth/base/timer.hpp>
 #include <psynth/base/arg_parser.hpp>
+#include <psynth/base/config.hpp>
+#include <psynth/app/defaults.hpp>
+#include <psynth/new_graph/offline_render.hpp>
+#include <psynth/new_graph/core/patch_file.hpp>
 #include <psynth/version.hpp>
 
 #include "cli/psychosynth_cli.hpp"
@@ -56,7 +65,21 @@ void psychosynth_cli::print_help()
 	"  -C, --client <host>   Connect to the specified port.\n"
 	"  -p, --port            Use this server port instead of the default.\n"
 	"  -P, --client-port     Use this client port instead of the default.\n"
-    	"  -o, --osc <port>      Start passive OSC interface.\n";
+    	"  -o, --osc <port>      Start passive OSC interface.\n"
+	"\n"
+	"Render options:\n"
+	"  --render <patch>      Render the output of a patch file to a file, as\n"
+	"                        fast as possible, and exit.\n"
+	"  --seconds <value>     Length of the render, in seconds.\n"
+	"  --out <file>          File to render to. Its extension selects the\n"
+	"                        format: wav, aiff, au, ogg or flac.\n"
+	"\n"
+	"Monitoring options:\n"
+	"  --stats <seconds>     Print the timing of the device callbacks and,\n"
+	"                        with the profiler enabled, the DSP load of\n"
+	"                        every node periodically.\n"
+	"  --deadline-log <load> Log device callbacks taking more than this\n"
+	"                        fraction of their deadline, and underruns.\n";
 }
 
 void psychosynth_cli::print_version()
@@ -79,16 +102,31 @@ void psychosynth_cli::prepare (psynth::base::arg_parser& ap)
     ap.add ('p', "port", &m_server_port);
     ap.add ('P', "client-port", &m_client_port);
     ap.add ('o', "osc", &m_osc_port);
+    ap.add (0, "render", &m_render_patch);
+    ap.add (0, "seconds", &m_render_seconds);
+    ap.add (0, "out", &m_render_out);
+    ap.add (0, "stats", &m_stats_period);
+    ap.add (0, "deadline-log", &m_deadline_log);
 }
 
 int psychosynth_cli::execute ()
 {
     int ret_val = -1;
 
-    if (m_host.empty() && !m_run_server)
+#ifndef PSYNTH_HAVE_PROFILER
+    if (m_stats_period > 0)
+	cout << "Built without the profiler, --stats only shows the device."
+	     << endl;
+#endif
+
+    if (!m_render_patch.empty ())
+        ret_val = run_render ();
+    else if (m_host.empty() && !m_run_server)
 	cout << "Not enough parameters. Use -h or --help." << endl;
     else {
 	setup_synth ();
+	if (get_output ())
+	    get_output ()->set_deadline_log_threshold (m_deadline_log);
 	if (m_run_server)
 	    ret_val = run_server ();
 	else if (!m_host.empty())
@@ -107,6 +145,56 @@ void psychosynth_cli::init ()
     m_client_port = PSYNTH_DEFAULT_CLIENT_PORT_STR;
     m_server_port = PSYNTH_DEFAULT_SERVER_PORT_STR;
     m_host.clear();
+    m_render_seconds = 10.0f;
+    m_stats_period = 0;
+    m_stats_elapsed = 0;
+    m_deadline_log = 0;
+}
+
+void psychosynth_cli::update_stats (int delta_ms)
+{
+    if (get_output ())
+	get_output ()->log_deadline_report ();
+
+    if (m_stats_period <= 0)
+	return;
+
+    m_stats_elapsed += delta_ms;
+    if (m_stats_elapsed < m_stats_period * 1000)
+	return;
+    m_stats_elapsed = 0;
+
+    auto out = get_output ();
+    if (out) {
+	io::deadline_stats dev = out->get_deadline_stats ();
+	cout << "Device: " << dev.callbacks << " callbacks, "
+	     << dev.mean_load * 100 << "% mean load, "
+	     << dev.max_load * 100 << "% max load, "
+	     << dev.late << " late, " << dev.xruns << " underruns, "
+	     << dev.recoveries << " recovered." << endl
+	     << "Device headroom histogram (0% to 100%, late):";
+	for (auto count : dev.headroom)
+	    cout << " " << count;
+	cout << endl;
+	out->reset_deadline_stats ();
+    }
+
+#ifdef PSYNTH_HAVE_PROFILER
+    cout << "DSP load, microseconds per block:" << endl
+	 << setw (6) << "id" << "  " << setw (16) << left << "node" << right
+	 << setw (10) << "blocks" << setw (10) << "mean"
+	 << setw (10) << "p99" << setw (10) << "max" << endl;
+
+    for (auto& node : get_world ()->get_dsp_stats ())
+	cout << setw (6) << node.id << "  "
+	     << setw (16) << left << node.name << right
+	     << setw (10) << node.stats.blocks
+	     << setw (10) << node.stats.mean_ns / 1000.0
+	     << setw (10) << node.stats.p99_ns / 1000.0
+	     << setw (10) << node.stats.max_ns / 1000.0 << endl;
+
+    get_world ()->reset_dsp_stats ();
+#endif
 }
 
 int psychosynth_cli::run_client ()
@@ -133,6 +221,7 @@ int psychosynth_cli::run_client ()
 	client.update (timer.delta_ticks());
 
 	get_world ()->update ();
+	update_stats (timer.delta_ticks ());
 
 	if (client.get_state () == osc_client::IDLE)
 	    ret_val = -1;
@@ -162,6 +251,7 @@ int psychosynth_cli::run_server ()
 	server.update (timer.delta_ticks ());
 
 	get_world ()->update ();
+	update_stats (timer.delta_ticks ());
 
 	if (server.get_state () == osc_server::IDLE)
 	    ret_val = -1;
@@ -185,7 +275,58 @@ int psychosynth_cli::run_osc ()
 
 	while (server.receive (TIME_OUT));
         get_world ()->update ();
+	update_stats (timer.delta_ticks ());
     }
 
     return ret_val;
 }
+
+int psychosynth_cli::run_render ()
+{
+#ifdef PSYNTH_HAVE_WAV
+    static const std::map<std::string, io::file_fmt> formats = {
+        { ".wav",  io::file_fmt::wav },
+        { ".aiff", io::file_fmt::aiff },
+        { ".au",   io::file_fmt::au },
+        { ".ogg",  io::file_fmt::ogg },
+        { ".flac", io::file_fmt::flac }
+    };
+
+    if (m_render_out.empty ()) {
+	cout << "Missing render output file. Use --out <file>." << endl;
+	return ERR_GENERIC;
+    }
+
+    std::string ext = boost::filesystem::path (m_render_out).extension ().string ();
+    std::transform (ext.begin (), ext.end (), ext.begin (), ::tolower);
+    auto fmt = formats.find (ext);
+    if (fmt == formats.end ()) {
+	cout << "Unknown render output format: " << ext << endl;
+	return ERR_GENERIC;
+    }
+
+    base::conf_node& conf = base::config::self ().child ("psychosynth");
+    conf.child ("sample_rate").def (int (PSYNTH_DEFAULT_SAMPLE_RATE));
+    conf.child ("block_size").def (int (PSYNTH_DEFAULT_BLOCK_SIZE));
+
+    try {
+	auto stats = graph::render_offline_to_file (
+	    graph::core::load_patch (m_render_patch),
+	    m_render_out, fmt->second, m_render_seconds,
+	    conf.child ("block_size").get<int> (),
+	    conf.child ("sample_rate").get<int> ());
+
+	cout << "Rendered " << stats.duration () << " seconds in "
+	     << stats.elapsed << " seconds ("
+	     << stats.realtime_factor () << "x realtime)." << endl;
+    } catch (base::exception& err) {
+	cout << "Render failed: " << err.what () << endl;
+	return ERR_GENERIC;
+    }
+
+    return SUCCESS;
+#else
+    cout << "This build has no audio file support to render to." << endl;
+    return ERR_GENERIC;
+#endif
+}
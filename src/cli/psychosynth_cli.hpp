@@ -37,6 +37,12 @@ private:
     std::string m_server_port;
     std::string m_host;
     std::string m_osc_port;
+    std::string m_render_patch;
+    std::string m_render_out;
+    float m_render_seconds;
+    float m_stats_period;
+    int m_stats_elapsed;
+    float m_deadline_log;
 
     void print_help ();
     void print_version ();
@@ -47,6 +53,9 @@ private:
     int run_server ();
     int run_client ();
     int run_osc ();
+    int run_render ();
+
+    void update_stats (int delta_ms);
 };
 
 #endif /* PSYCHOSYNTH_CLI_H */
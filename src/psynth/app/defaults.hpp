@@ -42,5 +42,8 @@
 #define PSYNTH_DEFAULT_NUM_CHANNELS  2
 #define PSYNTH_DEFAULT_BLOCK_SIZE    256
 #define PSYNTH_DEFAULT_SAMPLE_RATE   44100
+#define PSYNTH_DEFAULT_NUM_THREADS   1
+#define PSYNTH_DEFAULT_RENDER_AHEAD  0
+#define PSYNTH_DEFAULT_SAMPLE_CACHE  0
 
 #endif /* PSYNTH_DEFAULTS_H */
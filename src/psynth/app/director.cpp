@@ -32,6 +32,7 @@
 #include <algorithm>
 #include "app/director.hpp"
 #include "app/defaults.hpp"
+#include "io/sample_cache.hpp"
 #include "world/patcher_dynamic.hpp"
 
 using namespace std;
@@ -89,6 +90,9 @@ void director::register_config ()
     m_config->child ("sample_rate") .def (int (PSYNTH_DEFAULT_SAMPLE_RATE));
     m_config->child ("block_size")  .def (int (PSYNTH_DEFAULT_BLOCK_SIZE));
     m_config->child ("num_channels").def (int (PSYNTH_DEFAULT_NUM_CHANNELS));
+    m_config->child ("num_threads") .def (int (PSYNTH_DEFAULT_NUM_THREADS));
+    m_config->child ("render_ahead").def (int (PSYNTH_DEFAULT_RENDER_AHEAD));
+    m_config->child ("sample_cache").def (int (PSYNTH_DEFAULT_SAMPLE_CACHE));
     m_config->child ("output")      .def (string (PSYNTH_DEFAULT_OUTPUT));
 
     m_on_output_change_slot =
@@ -118,8 +122,13 @@ void director::start (base::conf_node& conf, const boost::filesystem::path& home
     m_info.num_channels = conf.child ("num_channels").get<int> ();
     m_info.block_size = conf.child ("block_size").get<int> ();
 
+    if (conf.child ("sample_cache").get<int> ())
+        io::sample_cache::self ().set_disk_path (home_path / "cache");
+
     m_world = new world (m_info);
     m_world->set_patcher (base::manage (new patcher_dynamic));
+    m_world->set_num_threads (conf.child ("num_threads").get<int> ());
+    m_world->set_render_ahead (conf.child ("render_ahead").get<int> ());
 
     start_output ();
 }
@@ -148,6 +157,8 @@ void director::on_config_nudge (base::conf_node& node)
     node.child ("output").get (out);
 
     m_world->set_info (m_info);
+    m_world->set_num_threads (node.child ("num_threads").get<int> ());
+    m_world->set_render_ahead (node.child ("render_ahead").get<int> ());
 
     stop_output ();
     start_output ();
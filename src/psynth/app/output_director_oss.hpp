@@ -67,7 +67,8 @@ class output_director_oss : public output_director
         auto device = conf.child ("out_device").get<std::string> ();
 	m_output = io::new_buffered_async_output<
             graph::audio_const_range,
-            io::oss_output<sound::stereo16s_range> >(device, 1024, 44100);
+            io::oss_output<sound::stereo16s_range>,
+            sound::dither_converter>(device, 1024, 44100);
         return m_output;
     }
 
@@ -77,7 +77,10 @@ bool psynth_app::parse_args (int argc, const char* argv[])
     ap.add('s', "sample-rate", new base::option_conf<int>(conf.child ("sample_rate")));
     ap.add('b', "buffer-size", new base::option_conf<int>(conf.child ("block_size")));
     ap.add('c', "channels", new base::option_conf<int>(conf.child ("num_channels")));
+    ap.add('t', "threads", new base::option_conf<int>(conf.child ("num_threads")));
+    ap.add('r', "render-ahead", new base::option_conf<int>(conf.child ("render_ahead")));
     ap.add('o', "output", new base::option_conf<string>(conf.child ("output")));
+    ap.add(0, "sample-cache", new base::option_conf<int>(conf.child ("sample_cache")));
 
 #ifdef PSYNTH_HAVE_ALSA
     ap.add(0, "alsa-device", new base::option_conf<string>(conf.path ("alsa.out_device")));
@@ -124,7 +127,14 @@ void psynth_app::print_base_options (ostream& out)
 	"  -b, --buffer-size <value>  Set buffer size. Low values may cause clicking but\n"
 	"                             high values rise latency.\n"
 	"  -c, --channels <value>     Set the number of channels.\n"
+	"  -t, --threads <value>      Set the number of threads used to process the\n"
+	"                             synth. Independent chains run in parallel.\n"
+	"  -r, --render-ahead <value> Render this many frames ahead of the device in\n"
+	"                             a separate thread. Adds latency but makes slow\n"
+	"                             blocks less likely to cause clicks. 0 disables.\n"
 	"  -o, --output <system>      Set the preferred audio output system.\n"
+	"  --sample-cache <value>     When not 0, keep decoded samples in\n"
+	"                             ~/.psychosynth/cache to load them faster.\n"
 #ifdef PSYNTH_HAVE_ALSA
 	"  --alsa-device <device>     Set the ALSA playback device.\n"
 #endif
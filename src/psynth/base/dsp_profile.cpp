@@ -0,0 +1,121 @@
+/**
+ *  Time-stamp:  <2011-07-10 13:03:20 raskolnikov>
+ *
+ *  @file        dsp_profile.cpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sun Jul 10 11:14:09 2011
+ *
+ *  @brief Lock-free statistics of the time spent processing.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <thread>
+#include "dsp_profile.hpp"
+
+namespace psynth
+{
+namespace base
+{
+
+namespace
+{
+
+typedef std::chrono::steady_clock calibration_clock;
+
+const calibration_clock::time_point calibration_start =
+    calibration_clock::now ();
+const dsp_clock::tick_type calibration_start_ticks = dsp_clock::now ();
+
+} /* anonymous namespace */
+
+double dsp_clock::ns_per_tick ()
+{
+    const auto min_elapsed = std::chrono::milliseconds (10);
+    std::this_thread::sleep_until (calibration_start + min_elapsed);
+
+    const auto ticks = now () - calibration_start_ticks;
+    const auto elapsed = calibration_clock::now () - calibration_start;
+    return double (std::chrono::duration_cast<std::chrono::nanoseconds> (
+                       elapsed).count ()) / ticks;
+}
+
+constexpr std::size_t dsp_profile::sub_buckets;
+constexpr std::size_t dsp_profile::num_buckets;
+
+dsp_profile::dsp_profile ()
+{
+    reset_stats ();
+}
+
+std::uint64_t dsp_profile::bucket_top (std::size_t bucket)
+{
+    if (bucket < sub_buckets)
+        return bucket;
+
+    const std::size_t msb = bucket / sub_buckets;
+    const std::uint64_t sub = bucket % sub_buckets;
+    return ((sub_buckets + sub + 1) << (msb - 2)) - 1;
+}
+
+dsp_stats dsp_profile::stats (double ns_per_tick) const
+{
+    const std::uint64_t blocks = _blocks.load (std::memory_order_relaxed);
+    const std::uint64_t max    = _max.load (std::memory_order_relaxed);
+    const std::uint64_t total  = _total.load (std::memory_order_relaxed);
+
+    dsp_stats res;
+    res.blocks  = blocks;
+    res.max_ns  = max * ns_per_tick;
+    res.mean_ns = blocks ? total * ns_per_tick / blocks : 0;
+    res.p99_ns  = 0;
+
+    std::uint64_t count = 0;
+    for (std::size_t i = 0; i < num_buckets; ++i)
+        count += _buckets [i].load (std::memory_order_relaxed);
+
+    const std::uint64_t rank = count - count / 100;
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < num_buckets && count; ++i)
+    {
+        seen += _buckets [i].load (std::memory_order_relaxed);
+        if (seen >= rank)
+        {
+            res.p99_ns = std::min (bucket_top (i), max) * ns_per_tick;
+            break;
+        }
+    }
+
+    return res;
+}
+
+void dsp_profile::reset_stats ()
+{
+    _blocks.store (0, std::memory_order_relaxed);
+    _total.store (0, std::memory_order_relaxed);
+    _max.store (0, std::memory_order_relaxed);
+    for (auto& bucket : _buckets)
+        bucket.store (0, std::memory_order_relaxed);
+}
+
+} /* namespace base */
+} /* namespace psynth */
@@ -0,0 +1,181 @@
+/**
+ *  Time-stamp:  <2011-07-10 13:02:51 raskolnikov>
+ *
+ *  @file        dsp_profile.hpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sun Jul 10 11:14:09 2011
+ *
+ *  @brief Lock-free statistics of the time spent processing.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_BASE_DSP_PROFILE_HPP_
+#define PSYNTH_BASE_DSP_PROFILE_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined (__i386__) || defined (__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include <psynth/version.hpp>
+#include <psynth/base/scope_guard.hpp>
+#include <psynth/base/util.hpp>
+
+namespace psynth
+{
+namespace base
+{
+
+/**
+ * Statistics of the time spent in the blocks measured by a
+ * dsp_profile, in nanoseconds.
+ */
+struct dsp_stats
+{
+    std::uint64_t blocks;
+    std::uint64_t mean_ns;
+    /** Upper bound of the 99th percentile, precise up to 25%. */
+    std::uint64_t p99_ns;
+    std::uint64_t max_ns;
+};
+
+/**
+ * The cheapest clock available. It reads the cycle counter on x86,
+ * which must be invariant, and counts nanoseconds elsewhere.
+ */
+struct dsp_clock
+{
+    typedef std::uint64_t tick_type;
+
+    static tick_type now ()
+    {
+#if defined (__i386__) || defined (__x86_64__)
+        return __rdtsc ();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds> (
+            std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+#endif
+    }
+
+    /**
+     * Calibrates the ticks against the steady clock since the program
+     * started. The first call may sleep for a few milliseconds.
+     */
+    static double ns_per_tick ();
+};
+
+/**
+ * Accumulates the time spent processing blocks, in dsp_clock ticks.
+ * Only one thread may add measures at a time, but any thread can read
+ * the statistics without locking.
+ *
+ * The percentile comes from a histogram with four buckets per power
+ * of two, so adding a measure is only a handful of instructions.
+ */
+class dsp_profile : public boost::noncopyable
+{
+public:
+    dsp_profile ();
+
+    void add (dsp_clock::tick_type ticks)
+    {
+        auto& bucket = _buckets [bucket_of (ticks)];
+        bucket.store (bucket.load (std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+        _blocks.store (_blocks.load (std::memory_order_relaxed) + 1,
+                       std::memory_order_relaxed);
+        _total.store (_total.load (std::memory_order_relaxed) + ticks,
+                      std::memory_order_relaxed);
+        if (ticks > _max.load (std::memory_order_relaxed))
+            _max.store (ticks, std::memory_order_relaxed);
+    }
+
+    dsp_stats stats () const
+    { return stats (dsp_clock::ns_per_tick ()); }
+
+    /** Statistics converting the ticks with the given factor. */
+    dsp_stats stats (double ns_per_tick) const;
+
+    /**
+     * Starts the statistics again. Measures added meanwhile may be
+     * partially lost.
+     */
+    void reset_stats ();
+
+private:
+    static constexpr std::size_t sub_buckets = 4;
+    static constexpr std::size_t num_buckets = 64 * sub_buckets;
+
+    static std::size_t bucket_of (std::uint64_t ticks)
+    {
+        if (ticks < sub_buckets)
+            return ticks;
+        const unsigned msb = 63 - __builtin_clzll (ticks);
+        return msb * sub_buckets + ((ticks >> (msb - 2)) & (sub_buckets - 1));
+    }
+
+    static std::uint64_t bucket_top (std::size_t bucket);
+
+    std::atomic<std::uint64_t> _blocks;
+    std::atomic<std::uint64_t> _total;
+    std::atomic<std::uint64_t> _max;
+    std::atomic<std::uint32_t> _buckets [num_buckets];
+};
+
+/**
+ * Measures the time until it is destroyed in a dsp_profile.
+ */
+class dsp_profile_scope : public boost::noncopyable
+{
+public:
+    explicit dsp_profile_scope (dsp_profile& profile)
+        : _profile (profile)
+        , _start (dsp_clock::now ())
+    {}
+
+    ~dsp_profile_scope ()
+    { _profile.add (dsp_clock::now () - _start); }
+
+private:
+    dsp_profile&           _profile;
+    dsp_clock::tick_type   _start;
+};
+
+} /* namespace base */
+} /* namespace psynth */
+
+/**
+ * Measures the rest of the current scope in @a profile when the
+ * profiler is enabled, does nothing otherwise.
+ */
+#ifdef PSYNTH_HAVE_PROFILER
+#define PSYNTH_PROFILE_SCOPE(profile)                                   \
+    ::psynth::base::dsp_profile_scope                                   \
+    PSYNTH_ANONYMOUS_VARIABLE (psynth_profile_scope) (profile)
+#else
+#define PSYNTH_PROFILE_SCOPE(profile)
+#endif
+
+#endif /* PSYNTH_BASE_DSP_PROFILE_HPP_ */
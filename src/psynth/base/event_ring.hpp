@@ -0,0 +1,156 @@
+/**
+ *  Time-stamp:  <2011-07-08 20:12:37 raskolnikov>
+ *
+ *  @file        event_ring.hpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Fri Jul  8 17:03:19 2011
+ *
+ *  @brief Lock-free queue of polymorphic events.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_BASE_EVENT_RING_HPP_
+#define PSYNTH_BASE_EVENT_RING_HPP_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+#include <psynth/base/util.hpp>
+#include <psynth/base/scope_guard.hpp>
+
+namespace psynth
+{
+namespace base
+{
+
+/**
+ * A bounded queue of polymorphic objects with a common base, with
+ * many producers and one consumer, that never locks nor allocates
+ * once built.
+ *
+ * Every element lives in a slot of @a SlotSize bytes, including some
+ * bookkeeping, and pushing an element that does not fit fails to
+ * compile. Elements are consumed in the order they were pushed.
+ *
+ * Base should define a virtual destructor.
+ */
+template <class Base, std::size_t SlotSize = 128>
+class event_ring : public boost::noncopyable
+{
+    struct slot_header
+    {
+        std::atomic<std::size_t> seq;
+        Base*                    access;
+    };
+
+public:
+    /** Bytes available to an element in every slot. */
+    static constexpr std::size_t storage_size =
+        SlotSize - sizeof (slot_header);
+
+    /**
+     * Creates a ring of at least @a slots slots, rounded up to a power
+     * of two.
+     */
+    explicit event_ring (std::size_t slots = 1);
+
+    /** Destroys the pending elements, counting them as dropped. */
+    ~event_ring ();
+
+    /**
+     * Constructs a new element at the end of the queue. Can be called
+     * from any thread. Returns false, and counts it as overflowed, when
+     * the queue is full.
+     */
+    template <class Concrete, typename ...Args>
+    bool push_back (Args&& ... args);
+
+    template <class Concrete>
+    bool push_back (Concrete&& arg)
+    {
+        return this->push_back<
+            typename std::decay<Concrete>::type,
+            decltype (std::forward<Concrete> (arg))> (
+                std::forward<Concrete> (arg));
+    }
+
+    /**
+     * Calls @a fn with the elements that were in the queue when it was
+     * called, then destroys them. Only one thread can consume. Returns
+     * the number of elements consumed.
+     */
+    template <class Fn>
+    std::size_t consume (Fn fn);
+
+    /**
+     * Destroys the pending elements without consuming them, counting
+     * them as dropped. Only the consumer thread can clear.
+     */
+    std::size_t clear ();
+
+    /**
+     * Whether there are no elements. Can be called from any thread, but
+     * it is only exact for the consumer when nobody else pushes.
+     */
+    bool empty () const;
+
+    std::size_t capacity () const
+    { return _mask + 1; }
+
+    /** Number of elements that did not fit in the queue. */
+    std::size_t overflowed () const
+    { return _overflowed.load (std::memory_order_relaxed); }
+
+    /** Number of elements destroyed without being consumed. */
+    std::size_t dropped () const
+    { return _dropped.load (std::memory_order_relaxed); }
+
+private:
+    struct slot : slot_header
+    {
+        typename std::aligned_storage<
+            storage_size, alignof (std::max_align_t)>::type storage;
+    };
+
+    static_assert (SlotSize > sizeof (slot_header),
+                   "event_ring slots are too small");
+
+    template <class Fn>
+    std::size_t take (Fn fn);
+
+    std::unique_ptr<slot[]>  _slots;
+    std::size_t              _mask;
+    std::atomic<std::size_t> _head;
+    std::atomic<std::size_t> _tail;
+
+    std::atomic<std::size_t> _overflowed;
+    std::atomic<std::size_t> _dropped;
+};
+
+} /* namespace base */
+} /* namespace psynth */
+
+#include <psynth/base/event_ring.tpp>
+
+#endif /* PSYNTH_BASE_EVENT_RING_HPP_ */
@@ -0,0 +1,175 @@
+/**
+ *  Time-stamp:  <2011-07-08 20:12:44 raskolnikov>
+ *
+ *  @file        event_ring.tpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Fri Jul  8 17:03:19 2011
+ *
+ *  @brief Lock-free queue of polymorphic events.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_BASE_EVENT_RING_TPP_
+#define PSYNTH_BASE_EVENT_RING_TPP_
+
+#include <psynth/base/event_ring.hpp>
+
+namespace psynth
+{
+namespace base
+{
+
+/*
+ * The slots carry a sequence number, as in Dmitry Vyukov's bounded
+ * queue. A slot is free for the producer that claims position @c pos
+ * when its number is @c pos, and holds an element for the consumer
+ * when it is <tt>pos + 1</tt>.
+ */
+
+template <class B, std::size_t S>
+event_ring<B, S>::event_ring (std::size_t slots)
+    : _head (0)
+    , _tail (0)
+    , _overflowed (0)
+    , _dropped (0)
+{
+    std::size_t size = 1;
+    while (size < slots)
+        size <<= 1;
+
+    _slots.reset (new slot [size]);
+    _mask = size - 1;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        _slots [i].seq.store (i, std::memory_order_relaxed);
+        _slots [i].access = 0;
+    }
+}
+
+template <class B, std::size_t S>
+event_ring<B, S>::~event_ring ()
+{
+    clear ();
+}
+
+template <class B, std::size_t S>
+template <class Concrete, typename ...Args>
+bool event_ring<B, S>::push_back (Args&& ... args)
+{
+    static_assert (sizeof (Concrete) <= storage_size,
+                   "element too big for the slots of the event_ring");
+    static_assert (alignof (Concrete) <= alignof (std::max_align_t),
+                   "element alignment not supported by event_ring");
+
+    std::size_t pos = _head.load (std::memory_order_relaxed);
+    slot* s;
+
+    for (;;)
+    {
+        s = &_slots [pos & _mask];
+        const std::size_t seq = s->seq.load (std::memory_order_acquire);
+        const std::ptrdiff_t diff = std::ptrdiff_t (seq - pos);
+
+        if (diff == 0)
+        {
+            if (_head.compare_exchange_weak (pos, pos + 1,
+                                             std::memory_order_relaxed))
+                break;
+        }
+        else if (diff < 0)
+        {
+            _overflowed.fetch_add (1, std::memory_order_relaxed);
+            return false;
+        }
+        else
+            pos = _head.load (std::memory_order_relaxed);
+    }
+
+    // If the constructor throws the slot is published empty, so the
+    // consumer skips it instead of stalling.
+    s->access = 0;
+    auto publish = base::make_guard ([&] {
+            s->seq.store (pos + 1, std::memory_order_release);
+        });
+    s->access = new (&s->storage) Concrete (std::forward<Args> (args)...);
+
+    return true;
+}
+
+template <class B, std::size_t S>
+template <class Fn>
+std::size_t event_ring<B, S>::take (Fn fn)
+{
+    const std::size_t last = _head.load (std::memory_order_acquire);
+    std::size_t tail = _tail.load (std::memory_order_relaxed);
+    std::size_t count = 0;
+
+    while (tail != last)
+    {
+        slot& s = _slots [tail & _mask];
+        if (s.seq.load (std::memory_order_acquire) != tail + 1)
+            break; // Still being constructed
+
+        auto release = base::make_guard ([&] {
+                if (s.access)
+                    s.access->~B ();
+                s.access = 0;
+                s.seq.store (tail + _mask + 1, std::memory_order_release);
+                _tail.store (++ tail, std::memory_order_release);
+            });
+
+        if (s.access)
+        {
+            ++ count;
+            fn (*s.access);
+        }
+    }
+
+    return count;
+}
+
+template <class B, std::size_t S>
+template <class Fn>
+std::size_t event_ring<B, S>::consume (Fn fn)
+{
+    return take (fn);
+}
+
+template <class B, std::size_t S>
+std::size_t event_ring<B, S>::clear ()
+{
+    const std::size_t count = take ([] (B&) {});
+    _dropped.fetch_add (count, std::memory_order_relaxed);
+    return count;
+}
+
+template <class B, std::size_t S>
+bool event_ring<B, S>::empty () const
+{
+    return _head.load (std::memory_order_acquire) ==
+        _tail.load (std::memory_order_acquire);
+}
+
+} /* namespace base */
+} /* namespace psynth */
+
+#endif /* PSYNTH_BASE_EVENT_RING_TPP_ */
@@ -36,6 +36,7 @@
 #ifndef PSYNTH_BASE_SCOPE_GUARD_H_
 #define PSYNTH_BASE_SCOPE_GUARD_H_
 
+#include <utility>
 #include <boost/utility.hpp>
 #include <psynth/base/util.hpp>
 
@@ -38,9 +38,11 @@
  */
 
 #include <psynth/sound/buffer.hpp>
+#include <psynth/sound/buffer_allocator.hpp>
 #include <psynth/sound/ring_buffer.hpp>
 #include <psynth/sound/buffer_range.hpp>
 #include <psynth/sound/ring_buffer_range.hpp>
+#include <psynth/sound/spsc_ring_buffer.hpp>
 
 #include <psynth/sound/typedefs.hpp>
 
@@ -49,15 +51,23 @@ namespace psynth
 namespace graph
 {
 
-typedef sound::stereo32sf_planar_buffer            audio_buffer;
+/*
+ * The buffers of the nodes start and end at a cache line, so nodes
+ * processed by different threads do not share any.
+ */
+typedef sound::buffer<sound::stereo32sf_frame, true,
+                      sound::aligned_allocator<unsigned char> > audio_buffer;
 typedef sound::stereo32sf_planar_range             audio_range;
 typedef sound::stereo32sfc_planar_range            audio_const_range;
 typedef sound::stereo32sf_planar_ring_buffer       audio_ring_buffer;
 typedef sound::stereo32sf_planar_ring_range        audio_ring_range;
+typedef sound::stereo32sf_planar_spsc_ring_buffer  audio_spsc_ring_buffer;
+typedef sound::stereo32sf_planar_spsc_ring_range   audio_spsc_ring_range;
 typedef audio_range::value_type                    audio_frame;
 typedef sound::bits32sf                            audio_sample;
 
-typedef sound::mono32sf_buffer                     sample_buffer;
+typedef sound::buffer<sound::mono32sf_frame, false,
+                      sound::aligned_allocator<unsigned char> > sample_buffer;
 typedef sound::mono32sf_range                      sample_range;
 typedef sound::mono32sfc_range                     sample_const_range;
 typedef sound::mono32sf_ring_buffer                sample_ring_buffer;
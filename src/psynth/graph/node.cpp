@@ -37,6 +37,8 @@ namespace psynth
 namespace graph
 {
 
+std::atomic<unsigned> node0::s_topology_version (0);
+
 node0::node0(const audio_info& info, int type,
 	       const std::string& name,
 	       int n_in_audio, int n_in_control,
@@ -45,13 +47,17 @@ node0::node0(const audio_info& info, int type,
     m_audioinfo(info),
     m_outdata_audio(n_out_audio, audio_buffer (info.block_size)),
     m_outdata_control(n_out_control, sample_buffer (info.block_size)),
+    m_envelope_data(info.block_size),
     m_nparam(0),
+    m_params_dirty(0),
+    m_params_out_pending(0),
     m_id(NULL_ID),
     m_type(type),
     m_name(name),
     m_param_position(0,0),
     m_param_radious(5.0f),
     m_param_mute(false),
+    m_in_place(false),
     m_updated(false),
     m_single_update(single_update)
 {
@@ -68,6 +74,7 @@ node0::node0(const audio_info& info, int type,
     m_out_stable_value[LINK_AUDIO].resize(n_out_audio, 0.0f);
     m_out_stable_value[LINK_CONTROL].resize(n_out_control, 0.0f);
 
+    use_own_outputs ();
     set_envelopes_deltas();
 }
 
@@ -97,6 +104,7 @@ void node0::set_envelopes_deltas()
 void node0::add_param (const std::string& name, int type, void* val)
 {
     m_params.push_back(new node_param);
+    m_params[m_nparam]->m_dirty = &m_params_dirty;
     m_params[m_nparam]->configure(m_nparam, name, type, val);
     m_nparam++;
 }
@@ -105,6 +113,7 @@ void node0::add_param(const std::string& name, int type, void* val,
 		     node_param::event ev)
 {
     m_params.push_back(new node_param);
+    m_params[m_nparam]->m_dirty = &m_params_dirty;
     m_params[m_nparam]->configure(m_nparam, name, type, val, ev);
     m_nparam++;
 }
@@ -195,10 +204,12 @@ void node0::force_connect_in (int type, int in_socket, node0* src, int out_socke
 
     if (src)
 	src->m_out_sockets[type][out_socket].add_reference (this, in_socket);
+
+    ++s_topology_version;
 }
 
-inline bool node0::can_update (const node0* caller, int caller_port_type,
-			      int caller_port)
+bool node0::can_update (const node0* caller, int caller_port_type,
+			int caller_port)
 {
     bool ret;
 
@@ -213,39 +224,103 @@ inline bool node0::can_update (const node0* caller, int caller_port_type,
     return ret;
 }
 
+void node0::reset_updated ()
+{
+    m_updated = false;
+    if (!m_single_update) {
+	m_updated_links[LINK_AUDIO].clear();
+	m_updated_links[LINK_CONTROL].clear();
+    }
+}
+
+void node0::use_own_outputs ()
+{
+    size_t i;
+
+    m_out_audio.resize (m_outdata_audio.size ());
+    for (i = 0; i < m_outdata_audio.size (); ++i)
+	m_out_audio[i] = &m_outdata_audio[i];
+
+    m_out_control.resize (m_outdata_control.size ());
+    for (i = 0; i < m_outdata_control.size (); ++i)
+	m_out_control[i] = &m_outdata_control[i];
+}
+
 void node0::in_socket::update_input (const node0* caller, int caller_port_type,
 				    int caller_port)
 {
-    if (m_srcobj) {
+    if (m_srcobj)
 	m_srcobj->update(caller, caller_port_type, caller_port);
+}
 
-	if (m_type == LINK_AUDIO) {
-	    const audio_buffer* buf =
-		m_srcobj->get_output <audio_buffer> (m_type, m_srcport);
-	    if (buf)
-		for (list<watch*>::iterator it = m_watchs.begin();
-		     it != m_watchs.end(); ++it)
-		    (*it)->update (sound::const_range (*buf));
-	} else {
-	    const sample_buffer* buf =
-		m_srcobj->get_output <sample_buffer> (m_type, m_srcport);
-	    if (buf)
-		for (list<watch*>::iterator it = m_watchs.begin();
-		     it != m_watchs.end(); ++it) {
-		    (*it)->update (sound::const_range (*buf));
-		}
-	}
+void node0::in_socket::update_watchs ()
+{
+    if (!m_srcobj || m_watchs.empty ())
+	return;
+
+    if (m_type == LINK_AUDIO) {
+	const audio_buffer* buf =
+	    m_srcobj->get_output <audio_buffer> (m_type, m_srcport);
+	if (buf)
+	    for (list<watch*>::iterator it = m_watchs.begin();
+		 it != m_watchs.end(); ++it)
+		(*it)->update (sound::const_range (*buf));
+    } else {
+	const sample_buffer* buf =
+	    m_srcobj->get_output <sample_buffer> (m_type, m_srcport);
+	if (buf)
+	    for (list<watch*>::iterator it = m_watchs.begin();
+		 it != m_watchs.end(); ++it) {
+		(*it)->update (sound::const_range (*buf));
+	    }
     }
 }
 
 void node0::blend_buffer (sample* buf, int n_elem,
 			 sample stable_value, link_envelope env)
 {
-    while (n_elem--)
-    {
-        auto env_val = (float) (link_envelope::sample_type) env.update();
-	*buf = (*buf * env_val) + (stable_value * (1 - env_val));
-        buf++;
+    const float env_val = (float) (link_envelope::sample_type) env.value ();
+
+    if (stable_value == 0.0f)
+        env.apply (sample_range (n_elem, (sample_frame*) buf));
+    else if (env.flat () && env_val == 0.0f)
+        std::fill (buf, buf + n_elem, stable_value);
+    else if (!env.flat () || env_val != 1.0f) {
+        const sample* env_buf = fill_envelope (env, n_elem);
+        while (n_elem--) {
+            *buf = (*buf * *env_buf) + (stable_value * (1 - *env_buf));
+            ++buf;
+            ++env_buf;
+        }
+    }
+}
+
+const sample* node0::fill_envelope (link_envelope& env, int n_elem)
+{
+    sample_range data (n_elem, &range (m_envelope_data) [0]);
+    env.fill (data);
+    return (const sample*) &data [0];
+}
+
+void node0::apply_trigger (sample* buf, const sample* trig, int n_elem,
+                           link_envelope env)
+{
+    const float env_val = (float) (link_envelope::sample_type) env.value ();
+
+    if (env.flat () && env_val == 0.0f)
+        return;
+
+    if (env.flat () && env_val == 1.0f)
+        while (n_elem--)
+            *buf++ *= *trig++;
+    else {
+        const sample* env_buf = fill_envelope (env, n_elem);
+        while (n_elem--) {
+            *buf = *buf * ((1.0f - *env_buf) + (*env_buf * *trig));
+            ++buf;
+            ++trig;
+            ++env_buf;
+        }
     }
 }
 
@@ -260,16 +335,16 @@ void node0::update_envelopes ()
 	    it->update (m_audioinfo.block_size);
 
     /* Apply envelopes to output (for soft muting) */
-    for (i = 0; i < m_outdata_audio.size(); ++i)
+    for (i = 0; i < m_out_audio.size(); ++i)
     {
 	for (j = 0; j < m_audioinfo.num_channels; ++j)
-	    blend_buffer ((sample*)&range (m_outdata_audio[i])[0][j],
+	    blend_buffer ((sample*)&range (*m_out_audio[i])[0][j],
                           m_audioinfo.block_size,
                           m_out_stable_value[LINK_AUDIO][i], m_out_envelope);
     }
 
-    for (i = 0; i < m_outdata_control.size(); ++i)
-	blend_buffer((sample*)&range (m_outdata_control[i])[0],
+    for (i = 0; i < m_out_control.size(); ++i)
+	blend_buffer((sample*)&range (*m_out_control[i])[0],
                      m_audioinfo.block_size,
 		     m_out_stable_value[LINK_CONTROL][i], m_out_envelope);
 
@@ -295,8 +370,20 @@ void node0::update_in_sockets ()
 
 void node0::update_params_in ()
 {
-  for (vector<node_param*>::iterator i = m_params.begin(); i != m_params.end(); ++i)
-	(*i)->update_in ();
+    std::uint64_t dirty = m_params_dirty.exchange (0, std::memory_order_acquire);
+    std::uint64_t retry = 0;
+
+    while (dirty) {
+	const int bit = __builtin_ctzll (dirty);
+	dirty &= dirty - 1;
+
+	for (size_t i = bit; i < m_params.size (); i += node_param::dirty_bits)
+	    if (m_params[i]->pending () && !m_params[i]->update_in ())
+		retry |= node_param::dirty_bit (i);
+    }
+
+    if (retry)
+	m_params_dirty.fetch_or (retry, std::memory_order_relaxed);
 
     if (m_param_mute)
 	m_out_envelope.release ();
@@ -304,10 +391,24 @@ void node0::update_params_in ()
 	m_out_envelope.press ();
 }
 
+void node0::publish_param (int id)
+{
+    if (!m_params[id]->update_out ())
+	m_params_out_pending |= node_param::dirty_bit (id);
+}
+
 void node0::update_params_out ()
 {
-    for (vector<node_param*>::iterator i = m_params.begin(); i != m_params.end(); ++i)
-	(*i)->update_out ();
+    std::uint64_t pending = m_params_out_pending;
+    m_params_out_pending = 0;
+
+    while (pending) {
+	const int bit = __builtin_ctzll (pending);
+	pending &= pending - 1;
+
+	for (size_t i = bit; i < m_params.size (); i += node_param::dirty_bits)
+	    publish_param (i);
+    }
 }
 
 void node0::update_inputs ()
@@ -319,20 +420,47 @@ void node0::update_inputs ()
 	    m_in_sockets[i][j].update_input(this, i, j);
 }
 
-void node0::update (const node0* caller, int caller_port_type, int caller_port)
+void node0::update_watchs ()
 {
-    if (can_update (caller, caller_port_type, caller_port)) {
-	update_params_in();
+    size_t j, i;
 
-	if (!m_param_mute || !m_out_envelope.finished()) {
-	    update_inputs ();
-	    do_update (caller, caller_port_type, caller_port);
+    for (i = 0; i < LINK_TYPES; ++i)
+	for (j = 0; j < m_in_sockets[i].size(); ++j)
+	    m_in_sockets[i][j].update_watchs ();
+}
 
-	}
+bool node0::update_begin ()
+{
+    update_params_in ();
+    return !m_param_mute || !m_out_envelope.finished ();
+}
+
+void node0::update_process (const node0* caller, int caller_port_type,
+			    int caller_port, bool active)
+{
+    if (active) {
+	update_watchs ();
+	PSYNTH_PROFILE_SCOPE (m_profile);
+	do_update (caller, caller_port_type, caller_port);
+    }
+
+    update_params_out ();
+    update_envelopes ();
+}
+
+void node0::update_end ()
+{
+    update_in_sockets ();
+}
 
-	update_params_out ();
-	update_envelopes ();
-	update_in_sockets ();
+void node0::update (const node0* caller, int caller_port_type, int caller_port)
+{
+    if (can_update (caller, caller_port_type, caller_port)) {
+	bool active = update_begin ();
+	if (active)
+	    update_inputs ();
+	update_process (caller, caller_port_type, caller_port, active);
+	update_end ();
     }
 }
 
@@ -343,9 +471,11 @@ void node0::set_info (const audio_info& info)
     for (i = 0; i < m_outdata_audio.size(); ++i)
 	m_outdata_audio[i].recreate (info.block_size); //.set_info(info);
 
-    if (m_audioinfo.block_size != info.block_size)
+    if (m_audioinfo.block_size != info.block_size) {
 	for (i = 0; i < m_outdata_control.size(); ++i)
 	    m_outdata_control[i].recreate (info.block_size);
+        m_envelope_data.recreate (info.block_size);
+    }
 
     m_audioinfo = info;
 
@@ -30,9 +30,11 @@
 #include <iostream>
 #include <algorithm>
 #include <thread>
+#include <atomic>
 
 #include <psynth/base/vector_2d.hpp>
 #include <psynth/base/pointer.hpp>
+#include <psynth/base/dsp_profile.hpp>
 #include <psynth/synth/simple_envelope.hpp>
 #include <psynth/synth/audio_info.hpp>
 
@@ -45,6 +47,8 @@ namespace psynth
 namespace graph
 {
 
+class node_manager;
+
 class node0
 {
 public:
@@ -134,6 +138,7 @@ public:
 	}
 
 	void update_input (const node0* caller, int caller_port_type, int caller_port);
+	void update_watchs ();
 
 	template <typename SocketDataType>
 	const SocketDataType* get_data (int type) const {
@@ -186,6 +191,12 @@ private:
 
     std::vector<audio_buffer> m_outdata_audio;
     std::vector<sample_buffer> m_outdata_control;
+    sample_buffer m_envelope_data;
+
+    /* The buffers written by the outputs, the ones above unless the
+     * node_manager shares its own among the nodes. */
+    std::vector<audio_buffer*> m_out_audio;
+    std::vector<sample_buffer*> m_out_control;
 
     std::vector<out_socket> m_out_sockets[LINK_TYPES];
     std::vector<sample> m_out_stable_value[LINK_TYPES];
@@ -197,6 +208,11 @@ private:
     node_param m_null_param;
     int m_nparam;
 
+    /* Bit node_param::dirty_bit (id) is set when a parameter with that
+     * id may have changed, the rest are not looked at. */
+    std::atomic<std::uint64_t> m_params_dirty;
+    std::uint64_t m_params_out_pending;
+
     int m_id;
     int m_type;
     std::string m_name;
@@ -204,6 +220,7 @@ private:
     base::vector_2f m_param_position;
     float m_param_radious;
     int m_param_mute;
+    bool m_in_place;
 
     /* For !m_single_update, contains the nodes that has
      * been updated (<obj_id, port_id>) */
@@ -213,6 +230,16 @@ private:
 
     std::mutex m_paramlock;
 
+#ifdef PSYNTH_HAVE_PROFILER
+    base::dsp_profile m_profile;
+#endif
+
+    /* Bumped whenever a link is actually changed, so node_managers
+     * know when their execution plan is stale. */
+    static std::atomic<unsigned> s_topology_version;
+
+    friend class node_manager;
+
     void blend_buffer (sample* buf,
                        int n_elem,
 		       sample stable_value,
@@ -220,11 +247,27 @@ private:
 
     void update_params_out ();
     void update_inputs ();
+    void update_watchs ();
     void update_in_sockets ();
     void set_envelopes_deltas ();
     void update_envelopes ();
     bool can_update (const node0* caller, int caller_port_type,
 		     int caller_port);
+    void reset_updated ();
+    void use_own_outputs ();
+
+    /**
+     * Split version of update() without the recursion, used to run
+     * the node from a flat execution plan. update_begin() returns
+     * whether the node should process its inputs this block and the
+     * result must be passed to update_process(). update_end()
+     * applies pending reconnections, which modify the sockets of
+     * other nodes, so it must not run concurrently with other nodes.
+     */
+    bool update_begin ();
+    void update_process (const node0* caller, int caller_port_type,
+                         int caller_port, bool active);
+    void update_end ();
 
 protected:
     template <typename SocketDataType>
@@ -235,10 +278,10 @@ protected:
 	/* TODO: Find a way to do type checking */
 	switch(type) {
 	case LINK_AUDIO:
-	    return reinterpret_cast<SocketDataType*>(&(m_outdata_audio[socket]));
+	    return reinterpret_cast<SocketDataType*>(m_out_audio[socket]);
 	    break;
 	case LINK_CONTROL:
-	    return reinterpret_cast<SocketDataType*>(&(m_outdata_control[socket]));
+	    return reinterpret_cast<SocketDataType*>(m_out_control[socket]);
 	    break;
 	default:
 	    break;
@@ -251,6 +294,17 @@ protected:
 	m_out_stable_value[sock_type][sock_num] = value;
     }
 
+    /**
+     * Lets the node_manager give the output of the node the buffer of
+     * one of its inputs of the same type, when nothing else reads it
+     * later. The node must then work when get_output() and
+     * get_input() return the same buffer. Only for nodes with a
+     * single output.
+     */
+    void set_in_place (bool in_place) {
+	m_in_place = in_place;
+    }
+
     virtual void do_update (const node0* caller, int caller_port_type, int caller_port) = 0;
     virtual void do_advance () = 0;
     virtual void on_info_change () = 0;
@@ -259,9 +313,28 @@ protected:
     void add_param (const std::string&, int type, void* val);
     void add_param (const std::string&, int type, void* val, node_param::event ev);
 
+    /**
+     * Makes a change to a parameter done in the audio thread visible
+     * to node_param::get.
+     */
+    void publish_param (int id);
+
     link_envelope get_in_envelope (int type, int sock)
     { return m_in_envelope[type][sock]; }
 
+    /**
+     * Evaluates the next @a n_elem values of @a env into a scratch
+     * buffer of the node. The data is valid until the next call.
+     */
+    const sample* fill_envelope (link_envelope& env, int n_elem);
+
+    /**
+     * Modulates @a buf with the trigger signal @a trig as it fades
+     * in with @a env, this is <tt>buf * ((1 - env) + env * trig)</tt>.
+     */
+    void apply_trigger (sample* buf, const sample* trig, int n_elem,
+                        link_envelope env);
+
 public:
     node0 (const audio_info& prop, int type,
 	  const std::string& name,
@@ -279,17 +352,30 @@ public:
 	return m_name;
     }
 
+    /**
+     * Time spent in do_update() per block. Always empty unless the
+     * library was built with the profiler.
+     */
+    base::dsp_stats get_dsp_stats () const {
+#ifdef PSYNTH_HAVE_PROFILER
+	return m_profile.stats ();
+#else
+	return base::dsp_stats ();
+#endif
+    }
+
+    void reset_dsp_stats () {
+#ifdef PSYNTH_HAVE_PROFILER
+	m_profile.reset_stats ();
+#endif
+    }
+
     void update_params_in ();
     void update (const node0* caller, int caller_port_type, int caller_port);
 
     void advance () {
-	m_updated = false;
-	if (!m_single_update) {
-	    m_updated_links[LINK_AUDIO].clear();
-	    m_updated_links[LINK_CONTROL].clear();
-	}
-
-	do_advance();
+	reset_updated ();
+	do_advance ();
     }
 
     const audio_info& get_info () const {
@@ -345,6 +431,36 @@ public:
 	return m_in_sockets[type][socket];
     }
 
+    /**
+     * Returns the node whose output is currently read by the given
+     * input socket. Unlike get_in_socket().get_source_node() this
+     * ignores connections that are pending for the fade out of the
+     * previous link to finish.
+     */
+    node0* get_linked_node (int type, int socket) const {
+	return m_in_sockets[type][socket].m_srcobj;
+    }
+
+    /**
+     * Returns the output socket read by the given input socket, for
+     * the node returned by get_linked_node().
+     */
+    int get_linked_socket (int type, int socket) const {
+	return m_in_sockets[type][socket].m_srcport;
+    }
+
+    bool is_single_update () const {
+	return m_single_update;
+    }
+
+    bool is_in_place () const {
+	return m_in_place;
+    }
+
+    static unsigned topology_version () {
+	return s_topology_version.load ();
+    }
+
     int get_num_output (int type) const {
 	return m_out_sockets[type].size();
     }
@@ -76,6 +76,15 @@ int node_delay::do_update_channel (int chan)
 
     link_envelope in_env = get_in_envelope (LINK_AUDIO, IN_A_INPUT);
 
+    /* Envelope the input in the output buffer. Each sample is read
+       back before it gets overwritten. */
+    if (in_buf) {
+	std::copy (in_buf, in_buf + get_info ().block_size, out_buf);
+	in_env.apply (sample_range (get_info ().block_size,
+                                    (sample_frame*) out_buf));
+	in_buf = out_buf;
+    }
+
     float delay, the_delay;
     size_t i;
     int   pos = m_pos;
@@ -86,7 +95,7 @@ int node_delay::do_update_channel (int chan)
     delay = m_param_delay * get_info().sample_rate;
     for (i = 0; i < get_info().block_size; ++i) {
 	if (in_buf)
-	    in_val = *in_buf++ * (float) (audio_sample) in_env.update();
+	    in_val = *in_buf++;
 	else
 	    in_val = 0;
 
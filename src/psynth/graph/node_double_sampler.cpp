@@ -53,9 +53,6 @@ node_double_sampler::node_double_sampler(const audio_info& info):
 	  N_IN_C_SOCKETS,
 	  N_OUT_A_SOCKETS,
 	  N_OUT_C_SOCKETS),
-    m_fetcher_one (m_reader_one),
-    m_fetcher_two (m_reader_two),
-    m_inbuf_one (info.block_size),
     m_inbuf_two (info.block_size),
     m_param_ampl (0.75f),
     m_param_blend (1.0f),
@@ -63,43 +60,27 @@ node_double_sampler::node_double_sampler(const audio_info& info):
 {
     add_param ("file_one", node_param::STRING, &m_param_file_one,
 	       boost::bind (&node_double_sampler::on_file_one_change, this, _1));
-    add_param ("file_two", node_param::STRING, &m_param_file_one,
+    add_param ("file_two", node_param::STRING, &m_param_file_two,
 	       boost::bind (&node_double_sampler::on_file_two_change, this, _1));
     add_param ("amplitude", node_param::FLOAT, &m_param_ampl);
     add_param ("blend", node_param::FLOAT, &m_param_blend);
-
-    m_fetcher_one.set_chunk_size (info.block_size);
-    m_fetcher_two.set_chunk_size (info.block_size);
-    m_fetcher_one.start ();
-    m_fetcher_two.start ();
 }
 
 node_double_sampler::~node_double_sampler ()
 {
-    m_fetcher_one.stop ();
-    m_fetcher_two.stop ();
 }
 
 void node_double_sampler::on_file_one_change (node_param& par)
 {
-    std::string val;
-    boost::filesystem::path path;
-
-    par.get (val);
-    path = base::file_manager::self ().path("psychosynth.samples").find (val);
-
-    std::unique_lock<mutex> (m_update_mutex);
-    m_reader_one = io::new_file_input <interleaved_range> (path.string ());
-    m_fetcher_one.set_input (m_reader_one);
-
-    if (m_reader_one) {
-        m_inbuf_one.recreate (get_info ().block_size);
-        // m_scaler.set_channels (2); // HACK HACK
-	// m_scaler.setSampleRate(m_fetcher.get_info().sample_rate);
-    }
+    load_file (par, m_cursor_one);
 }
 
 void node_double_sampler::on_file_two_change (node_param& par)
+{
+    load_file (par, m_cursor_two);
+}
+
+void node_double_sampler::load_file (node_param& par, io::sample_cursor& cursor)
 {
     std::string val;
     boost::filesystem::path path;
@@ -107,17 +88,17 @@ void node_double_sampler::on_file_two_change (node_param& par)
     par.get (val);
     path = base::file_manager::self ().path("psychosynth.samples").find (val);
 
-    std::unique_lock<mutex> (m_update_mutex);
-    m_reader_two = io::new_file_input <interleaved_range> (path.string ());
-    m_fetcher_two.set_input (m_reader_two);
-
-    if (m_reader_two) {
-        m_inbuf_two.recreate (get_info ().block_size);
-        // m_scaler.set_channels (2); // HACK HACK
-	// m_scaler.setSampleRate(m_fetcher.get_info().sample_rate);
+    io::sample_data_ptr data;
+    try {
+        data = io::sample_cache::self ().get (path.string ());
+    } catch (io::file_error& err) {
+        err.log ();
     }
-}
 
+    /* The previous sample is released after unlocking. */
+    std::unique_lock<std::mutex> lock (m_update_mutex);
+    cursor.swap_data (data);
+}
 
 void node_double_sampler::do_update (const node0* caller, int caller_port_type, int caller_port)
 {
@@ -130,7 +111,9 @@ void node_double_sampler::do_update (const node0* caller, int caller_port_type,
     size_t start = 0;
     size_t end = get_info ().block_size;
 
-    if (m_reader_one && m_reader_two)
+    std::unique_lock<std::mutex> lock (m_update_mutex);
+
+    if (!m_cursor_one.empty () && !m_cursor_two.empty ())
     {
 	while (start < get_info ().block_size) {
 	    if (m_restart) {
@@ -161,28 +144,18 @@ void node_double_sampler::do_update (const node0* caller, int caller_port_type,
 	*buf++ *= m_param_ampl;
 
     /* Apply trigger envelope. */
-    if (trig_buf) {
+    if (trig_buf)
 	for (size_t i = 0; i < get_info ().num_channels; ++i)
-        {
-            sample* buf = (sample*) &range (*out)[0][i];
-	    int n_samp = get_info ().block_size;
-	    trig_buf = (const sample*) &const_range (*trig)[0];
-	    trig_env = get_in_envelope (LINK_CONTROL, IN_C_TRIGGER);
-
-	    while (n_samp--) {
-		float env_val = (audio_sample) trig_env.update();
-		*buf = *buf * ((1.0f - env_val) + (env_val * *trig_buf));
-		++buf;
-		++trig_buf;
-	    }
-	}
-    }
+	    apply_trigger ((sample*) &range (*out)[0][i],
+                           (const sample*) &const_range (*trig)[0],
+                           get_info ().block_size,
+                           get_in_envelope (LINK_CONTROL, IN_C_TRIGGER));
 }
 
 void node_double_sampler::restart()
 {
-    m_fetcher_one.seek (0, io::seek_dir::beg);
-    m_fetcher_two.seek (0, io::seek_dir::beg);
+    m_cursor_one.seek (0);
+    m_cursor_two.seek (0);
 }
 
 void node_double_sampler::read (audio_buffer& buf, int start, int end)
@@ -192,50 +165,16 @@ void node_double_sampler::read (audio_buffer& buf, int start, int end)
     const sample* blend_buf = blend ?
         (const sample*) &const_range (*blend)[0] : 0;
 
-    size_t must_read;
-    size_t nread;
-    size_t tbeg, tend;
-
-    std::unique_lock<std::mutex> lock (m_update_mutex);
-
-    must_read = end - start;
-    tbeg = tend = 0;
+    /* The first file goes straight to the output. */
+    auto out = sub_range (range (buf), start, end - start);
+    auto two = sub_range (range (m_inbuf_two), 0, end - start);
+    m_cursor_one.take (out);
+    m_cursor_two.take (two);
 
-    while (must_read) {
-	nread = m_fetcher_one.take (sub_range (range (m_inbuf_one), 0, must_read));
-
-	if (nread) {
-	    must_read -= nread;
-	    tend += nread;
-	    for (size_t i = 0; i < range (buf).num_samples (); ++i) {
-		for (size_t j = tbeg; j < tend; j++) {
-		    range (buf)[j][i] =
-			range (m_inbuf_one) [j - tbeg][i]
-			* (m_param_blend * (blend ? blend_buf [j] : 1.0));
-		}
-	    }
-	    tbeg += nread;
-	} else
-	    m_fetcher_one.seek (0, io::seek_dir::beg);
-    }
-
-    must_read = end - start;
-    tbeg = tend = 0;
-    while (must_read) {
-	nread = m_fetcher_two.take (sub_range (range (m_inbuf_two), 0, must_read));
-	if (nread) {
-	    must_read -= nread;
-	    tend += nread;
-	    for (size_t i = 0; i < range (buf).num_samples (); ++i) {
-                for (size_t j = tbeg; j < tend; j++) {
-		    range (buf)[j][i] +=
-			range (m_inbuf_two) [j - tbeg][i]
-			* (1 - m_param_blend * (blend ? blend_buf [j] : 1.0));
-		}
-	    }
-	    tbeg += nread;
-	} else
-	    m_fetcher_two.seek (0, io::seek_dir::beg);
+    for (size_t j = 0; j < out.size (); ++j) {
+        float factor = m_param_blend * (blend ? blend_buf [start + j] : 1.0);
+        for (size_t i = 0; i < out.num_samples (); ++i)
+            out[j][i] = out[j][i] * factor + two[j][i] * (1 - factor);
     }
 }
 
@@ -24,8 +24,7 @@
 #define PSYNTH_NODE_DOUBLE_SAMPLER_H
 
 #include <psynth/graph/node.hpp>
-#include <psynth/io/file_input.hpp>
-#include <psynth/io/caching_file_input.hpp>
+#include <psynth/io/sample_cache.hpp>
 #include <psynth/graph/node_factory.hpp>
 #include <psynth/synth/scaler.hpp>
 
@@ -65,19 +64,10 @@ public:
     };
 
 private:
-    typedef sound::stereo32sf_range  interleaved_range;
-    typedef sound::stereo32sf_buffer interleaved_buffer;
+    io::sample_cursor m_cursor_one;
+    io::sample_cursor m_cursor_two;
 
-    io::file_input_ptr<interleaved_range> m_reader_one;
-    io::caching_file_input_adapter<interleaved_range,
-                                   decltype (m_reader_one)>
-    m_fetcher_one;
-    io::file_input_ptr<interleaved_range> m_reader_two;
-    io::caching_file_input_adapter<interleaved_range, decltype (m_reader_two)>
-    m_fetcher_two;
-
-    interleaved_buffer m_inbuf_one;
-    interleaved_buffer m_inbuf_two;
+    audio_buffer m_inbuf_two;
 
     float m_param_ampl;
     float m_param_blend;
@@ -91,6 +81,7 @@ private:
 
     void on_file_one_change (node_param& par);
     void on_file_two_change (node_param& par);
+    void load_file (node_param& par, io::sample_cursor& cursor);
     void read (audio_buffer& buf, int start, int end);
     void restart();
 
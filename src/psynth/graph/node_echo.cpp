@@ -53,6 +53,7 @@ node_echo::node_echo(const audio_info& prop) :
     add_param ("feedback", node_param::FLOAT, &m_param_feedback);
 
     fill_frames (range (m_buffer), audio_frame (0.0f));
+    set_in_place (true);
 }
 
 void node_echo::on_info_change ()
@@ -81,6 +82,17 @@ int node_echo::do_update_channel (int chan)
 
     link_envelope in_env = get_in_envelope (LINK_AUDIO, IN_A_INPUT);
 
+    /* Envelope the input in the output buffer, if they are not the
+       same already. Each sample is read back before it gets
+       overwritten. */
+    if (in_buf) {
+	if (in_buf != out_buf)
+	    std::copy (in_buf, in_buf + get_info ().block_size, out_buf);
+	in_env.apply (sample_range (get_info ().block_size,
+                                    (sample_frame*) out_buf));
+	in_buf = out_buf;
+    }
+
     float delay;
     float in_val;
     std::size_t i;
@@ -92,7 +104,7 @@ int node_echo::do_update_channel (int chan)
 	if (pos > delay)
 	    pos = 0;
 
-	in_val = in_buf ? *in_buf++ * (float)(audio_sample)in_env.update() : 0;
+	in_val = in_buf ? *in_buf++ : 0;
 	val = tmp_buf[pos];
 
 	//*out_buf++ = val;
@@ -44,17 +44,21 @@ node_filter::node_filter(const audio_info& prop, int mode) :
     m_param_type(mode),
     m_param_cutoff(DEFAULT_CUTOFF),
     m_param_resonance(DEFAULT_RESONANCE),
+    m_param_control_step(DEFAULT_CONTROL_STEP),
     m_filter_values((filter_values::type) m_param_type,
 		    m_param_cutoff,
 		    m_param_resonance,
 		    prop.sample_rate),
-    m_filter (prop.num_channels, filter (&m_filter_values))
+    m_filter (&m_filter_values)
 {
     add_param ("type", node_param::INT, &m_param_type);
     add_param ("cutoff", node_param::FLOAT, &m_param_cutoff);
     add_param ("resonance", node_param::FLOAT, &m_param_resonance);
+    add_param ("control_step", node_param::INT, &m_param_control_step);
 
     //for (int i = 0; i < prop.num_channels; ++i)
+
+    set_in_place (true);
 }
 
 /* TODO cambiar el numero de canales. */
@@ -79,29 +83,42 @@ void node_filter::do_update (const node0* caller,
 				      m_param_resonance,
 				      get_info().sample_rate);
 
-	for (size_t i = 0; i < get_info().num_channels; ++i) {
-	    sample* outbuf = (sample*) &range (*output) [0][i];
-	    const sample* inbuf = (sample*) &const_range (*input) [0][i];;
-	    filter& filter = m_filter[i];
-	    link_envelope env = get_in_envelope (LINK_AUDIO, IN_A_INPUT);
-	    if (!cutoff)
-		for (size_t j = 0; j < (size_t) output->size(); ++j)
-		    *outbuf++ = filter.update(
-                        *inbuf++ * (float) (link_envelope::sample_type) env.update());
-	    else {
-		link_envelope mod_env = get_in_envelope (LINK_CONTROL,
-                                                         IN_C_CUTOFF);
-		const sample* cutoff_buf = (const sample*) &const_range (*cutoff) [0];
-
-		for (size_t j = 0; j < (size_t) output->size(); ++j) {
-		    /* FIXME: Slow */
-		    m_filter_values.calculate(m_param_cutoff
-					      + *cutoff_buf++
-					      * m_param_cutoff
-					      * (float) (link_envelope::sample_type) mod_env.update());
-		    *outbuf++ = filter.update(*inbuf++ * (float) (link_envelope::sample_type) env.update());
-		}
+	const size_t n_samples = output->size();
+	link_envelope env = get_in_envelope (LINK_AUDIO, IN_A_INPUT);
+
+	/* Envelope the input in the output buffer, then filter all the
+	   channels together in place. They may already be the same. */
+	if (input != output)
+	    copy_frames (const_range (*input), range (*output));
+	env.apply (range (*output));
+
+	if (!cutoff)
+	    m_filter.process (range (*output), range (*output));
+	else {
+	    link_envelope mod_env = get_in_envelope (LINK_CONTROL,
+						     IN_C_CUTOFF);
+	    const sample* cutoff_buf = (const sample*) &const_range (*cutoff) [0];
+	    const sample* mod_buf = fill_envelope (mod_env, n_samples);
+	    const size_t step = std::max (m_param_control_step, 1);
+	    auto freq = [&] (size_t j) {
+		return m_param_cutoff
+		    + cutoff_buf[j] * m_param_cutoff * mod_buf[j];
+	    };
+
+	    /* Sweep the coefficients towards the cutoff at the start of
+	       the next chunk, computing them once per chunk. */
+	    m_filter_values.calculate (freq (0));
+	    for (size_t j = 0; j < n_samples; j += step) {
+		const size_t len = std::min (step, n_samples - j);
+		auto chunk = sub_range (range (*output), j, len);
+		m_filter_values.sweep (
+		    freq (std::min (j + len, n_samples - 1)), len);
+		m_filter.process (chunk, chunk);
 	    }
+
+	    /* Stop the last sweep, or the coefficients keep drifting
+	       when the modulation goes away. */
+	    m_filter_values.calculate ();
 	}
     } else {
 	fill_frames (range (*output),
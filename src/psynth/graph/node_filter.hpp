@@ -23,8 +23,6 @@
 #ifndef PSYNTH_OBJECTFILTER_H
 #define PSYNTH_OBJECTFILTER_H
 
-#include <vector>
-
 #include <psynth/graph/node.hpp>
 #include <psynth/graph/node_factory.hpp>
 #include <psynth/synth/filter.hpp>
@@ -71,19 +69,27 @@ public:
 	PARAM_TYPE = node0::N_COMMON_PARAMS,
 	PARAM_CUTOFF,
 	PARAM_RESONANCE,
+	PARAM_CONTROL_STEP,
 	N_PARAM
     };
 
     static constexpr float DEFAULT_CUTOFF    = 660.0f;
     static constexpr float DEFAULT_RESONANCE = 0.5f;
 
+    /**
+     * Number of samples between two calculations of the coefficients
+     * when the cutoff is modulated. They are interpolated in between.
+     */
+    static constexpr int DEFAULT_CONTROL_STEP = 16;
+
 private:
     int m_param_type;
     float m_param_cutoff;
     float m_param_resonance;
+    int m_param_control_step;
 
     filter_values m_filter_values;
-    std::vector<filter> m_filter;
+    filter m_filter;
 
     void do_update (const node0* caller, int caller_port_type, int caller_port);
     void do_advance () {}
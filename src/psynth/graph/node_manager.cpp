@@ -29,14 +29,38 @@ namespace psynth
 namespace graph
 {
 
+namespace
+{
+
+/* Returned by build_plan_visit when the node is still being visited
+ * because of a cycle in the graph. */
+const size_t no_plan_entry = static_cast<size_t> (-1);
+
+/* An output of the plan, as <entry, type, socket>. */
+typedef std::tuple<size_t, int, int> plan_output;
+
+} /* anonymous namespace */
+
 node_manager::node_manager ()
     : m_node_map()
     , m_outputs()
+    , m_plan_dirty (true)
+    , m_plan_version (0)
+    , m_plan_parallel (false)
+    , m_plan_share (false)
+    , m_num_threads (1)
 {
 }
 
 node_manager::~node_manager ()
 {
+    /* Outputs may be updating us from their own threads. */
+    list<node_output*>::iterator i;
+    for (i = m_outputs.begin(); i != m_outputs.end(); ++i)
+	(*i)->set_manager (0);
+
+    for (auto& n : m_node_map)
+	n.second->use_own_outputs ();
 }
 
 bool node_manager::add_node (base::mgr_ptr<node0> obj, int id)
@@ -57,6 +81,7 @@ bool node_manager::add_node (base::mgr_ptr<node0> obj, int id)
 	m_outputs.push_back (out);
     }
 
+    m_plan_dirty = true;
     return true;
 }
 
@@ -71,7 +96,9 @@ void node_manager::do_delete_node (iterator it)
     }
 
     (*it)->set_id (node0::NULL_ID);
+    (*it)->use_own_outputs ();
     m_node_map.erase (it);
+    m_plan_dirty = true;
 }
 
 bool node_manager::delete_node (int id)
@@ -98,6 +125,54 @@ void node_manager::delete_node (iterator it)
 	m_delete_list.push_back (*it);
 }
 
+void node_manager::set_num_threads (size_t num_threads)
+{
+    unique_lock<mutex> lock (m_update_mutex);
+
+    if (num_threads < 1)
+	num_threads = 1;
+    if (num_threads == m_num_threads)
+	return;
+
+    m_num_threads = num_threads;
+    m_pool.reset ();
+    if (num_threads > 1)
+	m_pool.reset (new node_worker_pool (
+			  num_threads - 1,
+			  std::bind (&node_manager::run_plan_job, this,
+				     std::placeholders::_1)));
+    m_plan_dirty = true;
+}
+
+size_t node_manager::get_num_shared_buffers () const
+{
+    unique_lock<mutex> lock (m_update_mutex);
+    return m_audio_pool.size () + m_control_pool.size ();
+}
+
+vector<node_dsp_stats> node_manager::get_dsp_stats () const
+{
+    vector<node_dsp_stats> res;
+#ifdef PSYNTH_HAVE_PROFILER
+    unique_lock<mutex> lock (m_update_mutex);
+
+    for (auto& n : m_node_map)
+	res.push_back (node_dsp_stats {
+		n.first, n.second->get_name (), n.second->get_dsp_stats () });
+#endif
+    return res;
+}
+
+void node_manager::reset_dsp_stats ()
+{
+#ifdef PSYNTH_HAVE_PROFILER
+    unique_lock<mutex> lock (m_update_mutex);
+
+    for (auto& n : m_node_map)
+	n.second->reset_dsp_stats ();
+#endif
+}
+
 void node_manager::set_info (const audio_info& info)
 {
     unique_lock<mutex> lock (m_update_mutex);
@@ -109,6 +184,257 @@ void node_manager::set_info (const audio_info& info)
     {
 	map_iter->second->set_info (info);
     }
+
+    /* The shared buffers are resized with the new plan. */
+    m_plan_dirty = true;
+}
+
+std::size_t node_manager::build_plan_visit (node0* obj, const node0* caller,
+                                            int caller_port_type,
+                                            int caller_port,
+                                            map<plan_key, size_t>& done)
+{
+    const bool single = obj->is_single_update () || !caller;
+    const plan_key key = single ?
+        plan_key (obj, 0, -1, -1) :
+        plan_key (obj, caller, caller_port_type, caller_port);
+
+    /* Use the same bookkeeping as node0::update so the plan visits
+     * the nodes exactly in the same order. */
+    if (!obj->can_update (caller, caller_port_type, caller_port)) {
+        map<plan_key, size_t>::iterator it = done.find (key);
+        if (it != done.end ())
+            return it->second;
+        /* Feedback loop, the caller reads the output of the previous
+         * block, which is racy if we run the nodes in parallel and
+         * lost if the buffer is given to another node meanwhile. */
+        m_plan_parallel = false;
+        m_plan_share = false;
+        return no_plan_entry;
+    }
+
+    if (!single) {
+        m_plan_parallel = false;
+        m_plan_share = false;
+    }
+
+    vector<size_t> sources;
+    for (int i = 0; i < node0::LINK_TYPES; ++i)
+        for (int j = 0; j < obj->get_num_input (i); ++j) {
+            node0* src = obj->get_linked_node (i, j);
+            if (src) {
+                size_t idx = build_plan_visit (src, obj, i, j, done);
+                if (idx != no_plan_entry)
+                    sources.push_back (idx);
+            }
+        }
+
+    plan_entry entry;
+    entry.node = obj;
+    entry.caller = caller;
+    entry.caller_port_type = caller_port_type;
+    entry.caller_port = caller_port;
+    entry.sources.swap (sources);
+    entry.active = false;
+    entry.pulling = false;
+    m_plan.push_back (entry);
+
+    return done [key] = m_plan.size () - 1;
+}
+
+void node_manager::build_plan ()
+{
+    m_plan_dirty = false;
+    m_plan_version = node0::topology_version ();
+    m_plan_parallel = true;
+    m_plan_share = true;
+    m_plan.clear ();
+
+    map<plan_key, size_t> done;
+    for (list<node_output*>::iterator out_iter = m_outputs.begin();
+	 out_iter != m_outputs.end();
+	 ++out_iter)
+	build_plan_visit (*out_iter, 0, -1, -1, done);
+
+    for (map<int, base::mgr_ptr<node0> >::iterator map_iter = m_node_map.begin();
+	 map_iter != m_node_map.end();
+	 ++map_iter)
+    {
+	map_iter->second->reset_updated ();
+	map_iter->second->use_own_outputs ();
+    }
+
+    if (m_pool && m_plan_parallel) {
+        m_pool->reset (m_plan.size ());
+        for (size_t i = 0; i < m_plan.size (); ++i)
+            for (vector<size_t>::iterator s = m_plan [i].sources.begin();
+                 s != m_plan [i].sources.end();
+                 ++s)
+                m_pool->add_dependency (i, *s);
+    } else if (m_plan_share && !m_plan.empty ()) {
+        share_buffers ();
+        return;
+    }
+
+    /* The nodes use their own buffers. */
+    m_audio_pool.clear ();
+    m_control_pool.clear ();
+}
+
+/*
+ * Gives the outputs of the nodes in the plan buffers from the pools,
+ * as a register allocator would. A buffer is free again after the
+ * last entry that reads it, and an in place node takes the buffer of
+ * the input that it reads for the last time. This is only valid when
+ * the plan is run serially, without feedback loops, and every node
+ * in it is run once.
+ */
+void node_manager::share_buffers ()
+{
+    map<const node0*, size_t> index;
+    for (size_t i = 0; i < m_plan.size (); ++i)
+        index [m_plan [i].node] = i;
+
+    /* Where the output connected to the given input is. */
+    auto source = [&] (const node0* obj, int type, int sock,
+                       plan_output& out) -> bool {
+        map<const node0*, size_t>::iterator it =
+            index.find (obj->get_linked_node (type, sock));
+        if (it == index.end ())
+            return false;
+        out = plan_output (it->second, type,
+                           obj->get_linked_socket (type, sock));
+        return true;
+    };
+
+    /* Last entry that reads every output. */
+    map<plan_output, size_t> last;
+    for (size_t i = 0; i < m_plan.size (); ++i) {
+        const node0* obj = m_plan [i].node;
+        plan_output out;
+        for (int t = 0; t < node0::LINK_TYPES; ++t) {
+            for (int o = 0; o < obj->get_num_output (t); ++o)
+                last [plan_output (i, t, o)] = i;
+            for (int s = 0; s < obj->get_num_input (t); ++s)
+                if (source (obj, t, s, out))
+                    last [out] = std::max (last [out], i);
+        }
+    }
+
+    map<plan_output, size_t> buffer;
+    vector<size_t> unused [node0::LINK_TYPES];
+    size_t count [node0::LINK_TYPES] = { 0, 0 };
+
+    for (size_t i = 0; i < m_plan.size (); ++i) {
+        const node0* obj = m_plan [i].node;
+
+        /* Inputs by the number of sockets that read them. */
+        map<plan_output, int> reads;
+        plan_output out;
+        for (int t = 0; t < node0::LINK_TYPES; ++t)
+            for (int s = 0; s < obj->get_num_input (t); ++s)
+                if (source (obj, t, s, out))
+                    ++reads [out];
+
+        for (int t = 0; t < node0::LINK_TYPES; ++t)
+            for (int o = 0; o < obj->get_num_output (t); ++o) {
+                size_t& b = buffer [plan_output (i, t, o)];
+                map<plan_output, int>::iterator in = reads.end ();
+
+                if (obj->is_in_place ())
+                    for (in = reads.begin (); in != reads.end (); ++in)
+                        if (std::get<1> (in->first) == t &&
+                            in->second == 1 && last [in->first] == i)
+                            break;
+
+                if (in != reads.end ()) {
+                    b = buffer [in->first];
+                    reads.erase (in);
+                } else if (!unused [t].empty ()) {
+                    b = unused [t].back ();
+                    unused [t].pop_back ();
+                } else
+                    b = count [t]++;
+            }
+
+        for (map<plan_output, int>::iterator in = reads.begin ();
+             in != reads.end ();
+             ++in)
+            if (last [in->first] == i)
+                unused [std::get<1> (in->first)].push_back (buffer [in->first]);
+
+        for (int t = 0; t < node0::LINK_TYPES; ++t)
+            for (int o = 0; o < obj->get_num_output (t); ++o)
+                if (last [plan_output (i, t, o)] == i)
+                    unused [t].push_back (buffer [plan_output (i, t, o)]);
+    }
+
+    const size_t block_size = m_plan.front ().node->get_info ().block_size;
+
+    m_audio_pool.resize (count [node0::LINK_AUDIO]);
+    for (auto& buf : m_audio_pool)
+        buf.recreate (block_size);
+
+    m_control_pool.resize (count [node0::LINK_CONTROL]);
+    for (auto& buf : m_control_pool)
+        buf.recreate (block_size);
+
+    for (map<plan_output, size_t>::iterator it = buffer.begin ();
+         it != buffer.end ();
+         ++it) {
+        node0* obj = m_plan [std::get<0> (it->first)].node;
+        const int sock = std::get<2> (it->first);
+        if (std::get<1> (it->first) == node0::LINK_AUDIO)
+            obj->m_out_audio [sock] = &m_audio_pool [it->second];
+        else
+            obj->m_out_control [sock] = &m_control_pool [it->second];
+    }
+}
+
+void node_manager::run_plan_job (size_t idx)
+{
+    plan_entry& e = m_plan [idx];
+    e.node->update_process (e.caller, e.caller_port_type,
+                            e.caller_port, e.pulling);
+}
+
+void node_manager::run_plan ()
+{
+    vector<plan_entry>::iterator it;
+    vector<plan_entry>::reverse_iterator rit;
+
+    for (it = m_plan.begin(); it != m_plan.end(); ++it)
+        it->active = !it->caller;
+
+    /* Consumers always come after their sources in the plan, so a
+     * backwards pass finds which nodes are actually pulled. */
+    for (rit = m_plan.rbegin(); rit != m_plan.rend(); ++rit)
+        if (rit->active) {
+            rit->pulling = rit->node->update_begin ();
+            if (rit->pulling)
+                for (vector<size_t>::iterator s = rit->sources.begin();
+                     s != rit->sources.end();
+                     ++s)
+                    m_plan [*s].active = true;
+        }
+
+    if (m_pool && m_plan_parallel) {
+        for (size_t i = 0; i < m_plan.size (); ++i)
+            m_pool->set_active (i, m_plan [i].active);
+        m_pool->run ();
+
+        /* Reconnections only affect the next block, so it is safe
+         * to apply them after all the nodes are processed. */
+        for (it = m_plan.begin(); it != m_plan.end(); ++it)
+            if (it->active)
+                it->node->update_end ();
+    } else {
+        for (size_t i = 0; i < m_plan.size (); ++i)
+            if (m_plan [i].active) {
+                run_plan_job (i);
+                m_plan [i].node->update_end ();
+            }
+    }
 }
 
 void node_manager::update()
@@ -123,13 +449,9 @@ void node_manager::update()
 	(*map_iter).second->advance();
     }
 
-    list<node_output*>::iterator out_iter;
-    for (out_iter = m_outputs.begin();
-	 out_iter != m_outputs.end();
-	 ++out_iter)
-    {
-	(*out_iter)->update (0, -1, -1);
-    }
+    if (m_plan_dirty || m_plan_version != node0::topology_version ())
+        build_plan ();
+    run_plan ();
 
     list<node0*>::iterator del_iter;
     for (del_iter = m_delete_list.begin();
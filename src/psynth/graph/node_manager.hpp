@@ -23,18 +23,36 @@
 #ifndef PSYNTH_NODE_MANAGER_H
 #define PSYNTH_NODE_MANAGER_H
 
+#include <deque>
 #include <map>
+#include <tuple>
+#include <vector>
+#include <memory>
 #include <thread>
+#include <atomic>
+#include <string>
 
 #include <psynth/base/pointer.hpp>
+#include <psynth/base/dsp_profile.hpp>
 #include <psynth/base/iterator.hpp>
 #include <psynth/graph/node_output.hpp>
+#include <psynth/graph/node_worker_pool.hpp>
 
 namespace psynth
 {
 namespace graph
 {
 
+/**
+ * DSP load of a node, as returned by node_manager::get_dsp_stats().
+ */
+struct node_dsp_stats
+{
+    int             id;
+    std::string     name;
+    base::dsp_stats stats;
+};
+
 class node_manager
 {
 public:
@@ -42,14 +60,56 @@ public:
     typedef base::map_const_iterator <int, base::mgr_ptr<node0>> const_iterator;
 
 private:
+    /**
+     * One step of the flat execution plan. A node appears once in
+     * the plan, unless it is not single-update, in which case it
+     * appears once per different link that pulls from it.
+     */
+    struct plan_entry
+    {
+	node0*       node;
+	const node0* caller;
+	int          caller_port_type;
+	int          caller_port;
+
+	/** Entries that are pulled when this one processes its inputs. */
+	std::vector<std::size_t> sources;
+
+	bool         active;
+	bool         pulling;
+    };
+
+    typedef std::tuple<const node0*, const node0*, int, int> plan_key;
+
     base::mgr_assoc <std::map <int, base::mgr_ptr <node0>>> m_node_map;
     std::list <node_output*> m_outputs;
     std::list <node0*> m_delete_list;
 
-    std::mutex m_update_mutex;
+    std::vector<plan_entry> m_plan;
+    std::atomic<bool> m_plan_dirty;
+    unsigned m_plan_version;
+    bool m_plan_parallel;
+    bool m_plan_share;
+
+    /* Output buffers shared by the nodes in a serial plan. */
+    std::deque<audio_buffer> m_audio_pool;
+    std::deque<sample_buffer> m_control_pool;
+
+    std::size_t m_num_threads;
+    std::unique_ptr<node_worker_pool> m_pool;
+
+    mutable std::mutex m_update_mutex;
 
     void do_delete_node (iterator it);
 
+    void build_plan ();
+    void share_buffers ();
+    std::size_t build_plan_visit (node0* obj, const node0* caller,
+                                  int caller_port_type, int caller_port,
+                                  std::map<plan_key, std::size_t>& done);
+    void run_plan ();
+    void run_plan_job (std::size_t idx);
+
 public:
     node_manager ();
     ~node_manager ();
@@ -85,18 +145,51 @@ public:
 
     void set_info (const audio_info& info);
 
+    /**
+     * Sets the number of threads used to update the graph. When more
+     * than one, independent branches of the graph are updated in
+     * parallel by a pool of worker threads, with the same results
+     * as the serial update. Graphs with feedback loops or nodes that
+     * are not single-update are always updated serially.
+     */
+    void set_num_threads (std::size_t num_threads);
+
+    std::size_t get_num_threads () const {
+	return m_num_threads;
+    }
+
+    /**
+     * Number of buffers shared by the outputs of the nodes in the
+     * current plan, zero when every node uses its own.
+     */
+    std::size_t get_num_shared_buffers () const;
+
     /**
      * Makes a full new update of the objects. This means that it first resets
-     * the is-updated property of the objects and then calls update() on all
-     * the attached node_outputs. The update is propagated via DFS. Some
-     * objects may not be updated if not conected to a subgraph containing an
-     * OutputObject.
+     * the is-updated property of the objects and then updates all the nodes
+     * that the attached node_outputs depend on. Some objects may not be
+     * updated if not conected to a subgraph containing an OutputObject.
+     *
+     * The nodes are run from a flat execution plan in the same order
+     * that a DFS from the outputs would visit them. The plan is only
+     * rebuilt when a node is added or deleted or some link changes.
+     * When run serially, an output buffer is reused by later nodes
+     * once all its readers are done with it, and in place nodes
+     * write over their input, so only a few buffers are touched.
      *
      * This function may be called by an OutputObject if a registered Output
      * system calls for new data and not enought data is availible in its
      * buffer.
      */
     void update ();
+
+    /**
+     * Time spent processing every node. The list is empty unless the
+     * library was built with the profiler.
+     */
+    std::vector<node_dsp_stats> get_dsp_stats () const;
+
+    void reset_dsp_stats ();
 };
 
 } /* namespace graph */
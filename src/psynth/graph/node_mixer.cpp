@@ -23,6 +23,7 @@
 #include <algorithm>
 
 #include "sound/output.hpp"
+#include "synth/mix.hpp"
 #include "graph/node_types.hpp"
 #include "graph/node_mixer.hpp"
 
@@ -41,17 +42,20 @@ void node_control_mixer::do_update (const node0* caller,
 {
     sample_buffer* buf = get_output<sample_buffer>(LINK_CONTROL, OUT_C_OUTPUT);
     const sample_buffer* in  = NULL;
-    size_t j;
+    size_t j, k;
     bool input = false;
+    const size_t first = in_place_input (LINK_CONTROL, buf);
 
-    init ((sample*) &range (*buf)[0], get_info().block_size);
+    if (first == m_numchan)
+	init ((sample*) &range (*buf)[0], get_info().block_size);
 
-    for (j = 0; j < m_numchan; ++j)
-	if ((in = get_input <sample_buffer> (LINK_CONTROL, j))) {
+    for (k = 0; k < m_numchan; ++k)
+	if ((in = get_input <sample_buffer> (
+		 LINK_CONTROL, j = (first + k) % m_numchan))) {
 	    link_envelope env = get_in_envelope (LINK_CONTROL, j);
 	    mix ((sample*) &range (*buf)[0],
                  (const sample*) &const_range (*in)[0],
-                 env, get_info().block_size);
+                 env, get_info().block_size, j == first);
 	    input = true;
 	}
 
@@ -68,22 +72,25 @@ void node_audio_mixer::do_update (const node0* caller,
     audio_buffer* buf = get_output<audio_buffer> (LINK_AUDIO, OUT_A_OUTPUT);
     const audio_buffer* in = NULL;
     const sample_buffer* ampl = get_input<sample_buffer> (LINK_CONTROL, IN_C_AMPLITUDE);
-    size_t i, j;
+    size_t i, j, k;
     bool input = false;
+    const size_t first = in_place_input (LINK_AUDIO, buf);
 
     for (i = 0; i < get_info().num_channels; ++i)
     {
-	init ((sample*) &range (*buf) [0][i],
-              get_info().block_size);
+	if (first == m_numchan)
+	    init ((sample*) &range (*buf) [0][i],
+		  get_info().block_size);
 
-	for (j = 0; j < m_numchan; ++j)
-	    if ((in = get_input <audio_buffer> (LINK_AUDIO, j))) {
+	for (k = 0; k < m_numchan; ++k)
+	    if ((in = get_input <audio_buffer> (
+		     LINK_AUDIO, j = (first + k) % m_numchan))) {
 		link_envelope env = get_in_envelope(LINK_AUDIO, j);
 
 		if (!ampl)
 		    mix((sample*) &range (*buf) [0][i],
                         (const sample*) &const_range (*in) [0][i],
-			env, get_info().block_size);
+			env, get_info().block_size, j == first);
 		else {
 		    link_envelope ctrl_env = get_in_envelope(LINK_CONTROL,
                                                              IN_C_AMPLITUDE);
@@ -91,7 +98,7 @@ void node_audio_mixer::do_update (const node0* caller,
 		    mix((sample*) &range (*buf) [0][i],
                         (const sample*) &const_range (*in) [0][i],
                         (const sample*) &const_range (*ampl) [0],
-			env, ctrl_env, get_info().block_size);
+			env, ctrl_env, get_info().block_size, j == first);
 		}
 		input = true;
 	    }
@@ -122,60 +129,73 @@ node_mixer::node_mixer (const audio_info& info,
 {
     add_param ("amplitude", node_param::FLOAT, &m_param_ampl);
     add_param ("mixop", node_param::INT, &m_param_mixop);
+    set_in_place (true);
 }
 
-void node_mixer::mix (sample* dest, const sample* src, size_t n_samples)
+static synth::mix_ramp envelope_ramp (const node0::link_envelope& env)
+{
+    return synth::mix_ramp {
+        (float) (node0::link_envelope::sample_type) env.value (),
+        env.delta () };
+}
+
+bool node_mixer::get_mix_op (synth::mix_op& op, bool assign) const
 {
     if (m_param_mixop == MIX_SUM)
-	while (n_samples--)
-	    *dest++ += *src++ * m_param_ampl;
+        op = synth::mix_op::sum;
     else if (m_param_mixop == MIX_PRODUCT)
-	while (n_samples--)
-	    *dest++ *= *src++ * m_param_ampl;
+        op = synth::mix_op::product;
+    else
+        return false;
+    if (assign)
+        op = synth::mix_op::assign;
+    return true;
+}
+
+void node_mixer::mix (sample* dest, const sample* src, size_t n_samples,
+		      bool assign)
+{
+    synth::mix_op op;
+    if (get_mix_op (op, assign))
+        synth::mix_block (op, (float*) dest, (const float*) src,
+                          m_param_ampl, n_samples);
 }
 
 void node_mixer::mix (sample* dest, const sample* src,
-		      const sample* ampl, size_t n_samples)
+		      const sample* ampl, size_t n_samples, bool assign)
 {
-    if (m_param_mixop == MIX_SUM)
-	while (n_samples--)
-	    *dest++ += *src++ * (m_param_ampl + m_param_ampl * *ampl++);
-    else if (m_param_mixop == MIX_PRODUCT)
-	while (n_samples--)
-	    *dest++ *= *src++ * (m_param_ampl + m_param_ampl * *ampl++);
+    synth::mix_op op;
+    if (get_mix_op (op, assign))
+        synth::mix_block (op, (float*) dest, (const float*) src,
+                          (const float*) ampl, m_param_ampl, n_samples);
 }
 
 void node_mixer::mix (sample* dest, const sample* src,
-		      link_envelope& env, size_t n_samples)
+		      link_envelope& env, size_t n_samples, bool assign)
 {
-    if (m_param_mixop == MIX_SUM)
-	while (n_samples--)
-	    *dest++ += *src++ * m_param_ampl *
-                (float) (link_envelope::sample_type) env.update();
-    else if (m_param_mixop == MIX_PRODUCT)
-	while (n_samples--)
-	    *dest++ *= *src++ * m_param_ampl *
-                (float) (link_envelope::sample_type) env.update();
+    synth::mix_op op;
+    if (get_mix_op (op, assign)) {
+        synth::mix_block (op, (float*) dest, (const float*) src,
+                          m_param_ampl, envelope_ramp (env), n_samples);
+        env.update (n_samples);
+    }
 }
 
 void node_mixer::mix (sample* dest, const sample* src,
 		      const sample* ampl,
 		      link_envelope& env,
 		      link_envelope& ctrl_env,
-		      size_t n_samples)
+		      size_t n_samples, bool assign)
 {
-    if (m_param_mixop == MIX_SUM)
-	while (n_samples--)
-	    *dest++ +=
-		*src++ * (m_param_ampl + m_param_ampl * *ampl++ *
-                          (float) (link_envelope::sample_type) ctrl_env.update()) *
-                (float) (link_envelope::sample_type) env.update();
-    else if (m_param_mixop == MIX_PRODUCT)
-	while (n_samples--)
-	    *dest++ *=
-		*src++ * (m_param_ampl + m_param_ampl * *ampl++ *
-                          (float) (link_envelope::sample_type) ctrl_env.update()) *
-                (float) (link_envelope::sample_type) env.update();
+    synth::mix_op op;
+    if (get_mix_op (op, assign)) {
+        synth::mix_block (op, (float*) dest, (const float*) src,
+                          (const float*) ampl, m_param_ampl,
+                          envelope_ramp (ctrl_env), envelope_ramp (env),
+                          n_samples);
+        env.update (n_samples);
+        ctrl_env.update (n_samples);
+    }
 }
 
 void node_mixer::init (sample* dest, size_t n_samples)
@@ -23,6 +23,7 @@
 #ifndef PSYNTH_OBJECTMIXER_H
 #define PSYNTH_OBJECTMIXER_H
 
+#include <psynth/synth/mix.hpp>
 #include <psynth/graph/node_types.hpp>
 #include <psynth/graph/node.hpp>
 #include <psynth/graph/node_factory.hpp>
@@ -60,24 +61,50 @@ public:
 protected:
     size_t m_numchan;
 
-    void mix (sample* dest, const sample* src, size_t n_samples);
+    /*
+     * With @a assign the source overwrites @a dest instead, as if it
+     * had been init() before.
+     */
+    void mix (sample* dest, const sample* src, size_t n_samples,
+	      bool assign = false);
 
     void mix (sample* dest, const sample* src,
-	     const sample* ampl, size_t n_samples);
+	      const sample* ampl, size_t n_samples, bool assign = false);
 
     void mix (sample* dest, const sample* src,
-	     link_envelope& env, size_t n_samples);
+	      link_envelope& env, size_t n_samples, bool assign = false);
 
     void mix (sample* dest, const sample* src, const sample* ampl,
               link_envelope& env, link_envelope& ctrl_env,
-              size_t n_samples);
+              size_t n_samples, bool assign = false);
 
     void init (sample* dest, size_t n_samples);
 
+    /**
+     * Returns the input of type @a type that shares the buffer @a out
+     * of the output, when the node is run in place, or m_numchan
+     * otherwise. That input must be mixed first, with assign, and
+     * the output must not be init() before.
+     */
+    template <class Buffer>
+    size_t in_place_input (int type, const Buffer* out) const
+    {
+	synth::mix_op op;
+	if (get_mix_op (op))
+	    for (size_t j = 0; j < m_numchan; ++j)
+		if (get_input<Buffer> (type, j) == out &&
+		    get_linked_node (type, j) != this)
+		    return j;
+	return m_numchan;
+    }
+
 private:
     float m_param_ampl;
     int m_param_mixop;
 
+    /** Maps the mixop parameter, false when it is not a valid one. */
+    bool get_mix_op (synth::mix_op& op, bool assign = false) const;
+
 public:
     node_mixer (const audio_info& info,
 		int obj_type,
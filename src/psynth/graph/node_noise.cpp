@@ -22,6 +22,7 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstdlib>
 #include "graph/node_noise.hpp"
 
 namespace psynth
@@ -69,6 +70,8 @@ node_noise::node_noise (const audio_info& prop,
 	  n_control_out),
     m_param_type (NOISE_PINK),
     m_param_ampl (DEFAULT_AMPL),
+    m_generator (rand ()),
+    m_white (-1.0f, 1.0f),
     m_b0 (0.0f),
     m_b1 (0.0f),
     m_b2 (0.0f),
@@ -90,7 +93,6 @@ void node_noise::update_noise (sample* buf)
     const sample_buffer* ampl_buf = get_input <sample_buffer>(LINK_CONTROL, IN_C_AMPLITUDE);
     const sample_buffer* trig_buf = get_input <sample_buffer>(LINK_CONTROL, IN_C_TRIGGER);
     link_envelope mod_env = get_in_envelope (LINK_CONTROL, IN_C_AMPLITUDE);
-    link_envelope trig_env =  get_in_envelope (LINK_CONTROL, IN_C_TRIGGER);
 
     const sample* ampl = ampl_buf ? (const sample*) &const_range (*ampl_buf)[0] : NULL;
 
@@ -112,18 +114,10 @@ void node_noise::update_noise (sample* buf)
 		*out++ = update_white () * m_param_ampl;
 
     /* Modulate amplitude with trigger envelope. */
-    if (trig_buf) {
-	n_samp = get_info().block_size;
-	out = buf;
-	const sample* trig = (const sample*) &const_range (*trig_buf)[0];
-	trig_env = get_in_envelope (LINK_CONTROL, IN_C_TRIGGER);
-	while (n_samp--) {
-	    float env_val = (float) (audio_sample) trig_env.update();
-	    *out = *out * ((1.0f - env_val) + (env_val * *trig));
-	    ++out;
-	    ++trig;
-	}
-    }
+    if (trig_buf)
+	apply_trigger (buf, (const sample*) &const_range (*trig_buf)[0],
+                       get_info().block_size,
+                       get_in_envelope (LINK_CONTROL, IN_C_TRIGGER));
 }
 
 sample node_noise::update_pink ()
@@ -147,7 +141,7 @@ sample node_noise::update_pink ()
 
 sample node_noise::update_white()
 {
-    return 1.0f - ((rand () % INT_MAX) / (float)INT_MAX * 2.0);
+    return m_white (m_generator);
 }
 
 } /* namespace graph */
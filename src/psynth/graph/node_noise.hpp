@@ -23,6 +23,7 @@
 #ifndef PSYNTH_OBJECTNOISE_H
 #define PSYNTH_OBJECTNOISE_H
 
+#include <psynth/synth/noise.hpp>
 #include <psynth/graph/node.hpp>
 #include <psynth/graph/node_types.hpp>
 #include <psynth/graph/node_factory.hpp>
@@ -68,6 +69,11 @@ private:
     int   m_param_type;
     float m_param_ampl;
 
+    /* Every node has its own generator so the result does not
+     * depend on the order in which noise nodes are updated. */
+    synth::default_noise_generator m_generator;
+    std::uniform_real_distribution<float> m_white;
+
     /* Pink noise factors. */
     sample m_b0;
     sample m_b1;
@@ -111,6 +111,29 @@ struct do_restart : public boost::static_visitor<void>
     { osc.restart (); }
 };
 
+struct do_set_wave_table : public boost::static_visitor<void>
+{
+    bool _wave_table;
+    do_set_wave_table (bool wave_table) : _wave_table (wave_table) {}
+    template <class Osc> void operator () (Osc& osc) const
+    { osc.set_wave_table (_wave_table); }
+};
+
+/*
+ * Builds the wave tables of every generator, so it is not done in
+ * the audio thread when the wave is changed. Only the audio rate
+ * oscillators read them.
+ */
+void init_wave_tables ()
+{
+    synth::oscillator<synth::sine_generator>::table ();
+    synth::oscillator<synth::square_generator>::table ();
+    synth::oscillator<synth::triangle_generator>::table ();
+    synth::oscillator<synth::sawtooth_generator>::table ();
+    synth::oscillator<synth::moogsaw_generator>::table ();
+    synth::oscillator<synth::exp_generator>::table ();
+}
+
 } /* anonymous namespace */
 
 PSYNTH_DEFINE_NODE_FACTORY (node_lfo);
@@ -143,7 +166,8 @@ node_oscillator::node_oscillator (const audio_info& prop,
 				  int obj_type,
 				  const std::string& name,
 				  int n_audio_out,
-				  int n_control_out) :
+				  int n_control_out,
+				  bool wave_table) :
     node0 (prop,
 	  obj_type,
 	  name,
@@ -157,13 +181,16 @@ node_oscillator::node_oscillator (const audio_info& prop,
     m_param_mod (MOD_FM),
     m_param_freq (DEFAULT_FREQ),
     m_param_ampl (DEFAULT_AMPL),
-    m_restart (false)
+    m_restart (false),
+    m_wave_table (wave_table)
 {
     add_param ("wave", node_param::INT, &m_param_wave);
     add_param ("modulator", node_param::INT, &m_param_mod);
     add_param ("frequency", node_param::FLOAT, &m_param_freq);
     add_param ("amplitude", node_param::FLOAT, &m_param_ampl);
 
+    if (wave_table)
+        init_wave_tables ();
     update_osc_params();
 }
 
@@ -185,6 +212,8 @@ void node_oscillator::update_osc_params ()
         case OSC_EXP: m_oscillator = synth::oscillator<synth::exp_generator> (get_info ().sample_rate); break;
         default: assert (false);
         }
+        boost::apply_visitor (do_set_wave_table (m_wave_table),
+                              m_oscillator);
 
         m_param_wave_new = m_param_wave;
     }
@@ -244,17 +273,9 @@ void node_oscillator::update_osc (sample* out)
 
     /* Modulate amplitude with trigger envelope. */
     if (trig_buf)
-    {
-	int n_samp = get_info().block_size;
-	const sample* trig = (const sample*) &const_range (*trig_buf) [0];
-	trig_env = get_in_envelope (LINK_CONTROL, IN_C_TRIGGER);
-	while (n_samp--) {
-	    auto env_val = (float) (audio_sample) trig_env.update();
-	    *out = *out * ((1.0f - env_val) + (env_val * *trig));
-	    ++out;
-	    ++trig;
-	}
-    }
+	apply_trigger (out, (const sample*) &const_range (*trig_buf) [0],
+                       get_info().block_size,
+                       get_in_envelope (LINK_CONTROL, IN_C_TRIGGER));
 }
 
 } /* namespace graph */
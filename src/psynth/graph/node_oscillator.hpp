@@ -101,13 +101,15 @@ public:
     float m_param_freq;
     float m_param_ampl;
     bool  m_restart;
+    bool  m_wave_table;
 
 public:
     node_oscillator (const audio_info& prop,
 		     int obj_type,
 		     const std::string& name,
 		     int n_audio_out,
-		     int n_control_out);
+		     int n_control_out,
+		     bool wave_table);
 
     ~node_oscillator ();
 };
@@ -131,7 +133,8 @@ public:
 			 NODE_OSCILLATOR,
 			 "oscillator",
 			 N_OUT_A_SOCKETS,
-			 0)
+			 0,
+			 true)
 	{};
 };
 
@@ -154,7 +157,8 @@ public:
 			 NODE_LFO,
 			 "lfo",
 			 0,
-			 N_OUT_C_SOCKETS)
+			 N_OUT_C_SOCKETS,
+			 false)
 	{};
 };
 
@@ -22,6 +22,8 @@
 
 #define PSYNTH_MODULE_NAME "psynth.graph.node_output"
 
+#include <algorithm>
+
 #include "base/logger.hpp"
 #include "graph/node_types.hpp"
 #include "graph/node_output.hpp"
@@ -40,9 +42,9 @@ PSYNTH_DEFINE_NODE_FACTORY(node_output);
 
 node_output::slot::slot (audio_async_output_ptr out,
                          node_output* parent,
-                         audio_ring_range::position ptr,
                          const audio_info& info)
-    : m_ptr (ptr)
+    : m_ring ((out->buffer_size () + info.block_size) * SAFETY_FACTOR +
+              parent->get_render_ahead ())
     , m_out (out)
     , m_parent (parent)
     , m_buf (out->buffer_size ())
@@ -58,6 +60,8 @@ void node_output::slot::callback (std::size_t nframes)
 
 node_output::~node_output()
 {
+    m_render->soft_stop ();
+
     // for (auto i = m_slots.begin(); i != m_slots.end(); ++i)
     //     delete *i;
 
@@ -69,11 +73,12 @@ node_output::~node_output()
 
 void node_output::on_info_change ()
 {
-    m_buffer.recreate (get_info ().block_size);
-    //.set_info (get_info());
-    for (std::list<slot*>::iterator i = m_slots.begin(); i != m_slots.end(); ++i)
+    for (std::list<slot*>::iterator i = m_slots.begin(); i != m_slots.end(); ++i) {
+	(*i)->m_ring.recreate (((*i)->m_out->buffer_size () +
+                                get_info ().block_size) * SAFETY_FACTOR +
+                               m_render_ahead);
 	(*i)->m_buf.recreate (get_info ().block_size); //.set_info (get_info());
-
+    }
 }
 
 void node_output::do_update (const node0* caller,
@@ -81,10 +86,15 @@ void node_output::do_update (const node0* caller,
 {
     const audio_buffer* in;
 
+    /*
+      This is the only writer of the slot rings, and it is always run
+      with the node manager update lock held, so every ring still has a
+      single producer at a time even when several devices pull from
+      different threads.
+    */
     if ((in = get_input<audio_buffer>(LINK_AUDIO, IN_A_INPUT))) {
-	//m_buflock.writeLock();
-    	range (m_buffer).write (const_range (*in));
-	//m_buflock.unlock();
+	for (auto it = m_slots.begin (); it != m_slots.end (); ++it)
+	    range ((*it)->m_ring).write (const_range (*in));
 
 	//m_passive_lock.lock();
 	for (auto it = m_passive_slots.begin();
@@ -93,11 +103,10 @@ void node_output::do_update (const node0* caller,
 	    (*it)->put (const_range (*in));
 	//m_passive_lock.unlock();
     } else {
-    	//m_buflock.writeLock();
         // FIXME: This is slow.
         auto zero_buf = audio_buffer (get_info ().block_size, audio_frame (0), 0);
-	range (m_buffer).write (const_range (zero_buf));
-	//m_buflock.unlock();
+	for (auto it = m_slots.begin (); it != m_slots.end (); ++it)
+	    range ((*it)->m_ring).write (const_range (zero_buf));
     }
 }
 
@@ -109,16 +118,60 @@ node_output::node_output (const audio_info& info) :
 	  N_IN_C_SOCKETS,
 	  N_OUT_A_SOCKETS,
 	  N_OUT_C_SOCKETS),
-    m_buffer (16384), // HACK this should be calculated from the
-                      // maximum buffer size of the outputs.
-    m_manager (NULL)
+    m_manager (NULL),
+    m_render_ahead (0),
+    m_render (new io::render_ahead (
+                  std::bind (&node_output::needs_render, this),
+                  std::bind (&node_output::render, this)))
+{
+}
+
+void node_output::set_render_ahead (std::size_t frames)
+{
+    m_render_ahead = frames;
+    update_render_thread ();
+}
+
+void node_output::update_render_thread ()
 {
+    const bool enable = m_manager && m_render_ahead;
+
+    if (!enable)
+	m_render->soft_stop ();
+    else if (m_render->state () == io::async_state::idle)
+	m_render->start ();
 }
 
 /*
-  TODO:
-  Hay que pensarse bien como sincronizar esto. Aunque no lo necesitamos
-  aún.
+  Called from the render thread. We render until every slot is at
+  least at the watermark, or as full as it can get while leaving room
+  for a whole block.
+*/
+bool node_output::needs_render ()
+{
+    const std::ptrdiff_t watermark = m_render_ahead;
+    const std::ptrdiff_t block_size = get_info ().block_size;
+
+    for (auto it = m_slots.begin (); it != m_slots.end (); ++it) {
+	auto& rng = range ((*it)->m_ring);
+	const std::ptrdiff_t fill = rng.size () - rng.write_available ();
+	if (fill < std::min (watermark, rng.size () - block_size))
+	    return true;
+    }
+
+    return false;
+}
+
+void node_output::render ()
+{
+    m_manager->update ();
+}
+
+/*
+  Runs in the device thread, which is the only reader of the slot
+  ring. The ring can not be resized from here while the graph may be
+  writing to it, so bigger requests are served in several chunks
+  that leave room for a whole block to be written.
 */
 void node_output::do_output (slot& slot, size_t nframes)
 {
@@ -126,24 +179,37 @@ void node_output::do_output (slot& slot, size_t nframes)
 	slot.m_buf.recreate (nframes);
     }
 
-    if (nframes > (size_t) m_buffer.size ()) {
-	m_buffer.recreate (nframes * SAFETY_FACTOR);
+    auto& rng = range (slot.m_ring);
+
+    if (m_render->state () == io::async_state::running) {
+	// Never render from here, late frames become silence.
+	const size_t avail = rng.read_available ();
+	const auto dst = range (slot.m_buf);
+	const size_t got = rng.read (dst, nframes);
+	fill_frames (sub_range (dst, got, nframes - got), audio_frame (0));
+	m_render->consumed (avail, nframes);
+	slot.m_out->put (sub_range (dst, 0, nframes));
+	return;
     }
 
-    if (m_manager) {
-	size_t avail;
-        auto& rng = range (m_buffer);
-	avail = rng.available (slot.m_ptr);
+    const size_t chunk = std::max<size_t> (rng.size () / SAFETY_FACTOR, 1);
+    size_t done = 0;
 
-	while (avail < nframes)
-        {
-	    m_manager->update ();
-            avail = rng.available (slot.m_ptr);
+    while (done < nframes) {
+	const size_t want = std::min (nframes - done, chunk);
+	if (m_manager)
+	    while ((size_t) rng.read_available () < want)
+		m_manager->update ();
+
+	const auto dst = sub_range (range (slot.m_buf), done, nframes - done);
+	const size_t got = rng.read (dst);
+	if (!got) {
+	    fill_frames (dst, audio_frame (0));
+	    break;
 	}
+	done += got;
     }
 
-    range (m_buffer).read (slot.m_ptr, range (slot.m_buf), nframes);
-
     slot.m_out->put (sub_range (range (slot.m_buf), 0, nframes));
 }
 
@@ -24,9 +24,12 @@
 #define PSYNTH_NODE_OUTPUT_H
 
 #include <list>
+#include <memory>
+#include <atomic>
 #include <functional>
 
 #include <psynth/io/output.hpp>
+#include <psynth/io/render_ahead.hpp>
 #include <psynth/graph/node.hpp>
 #include <psynth/graph/node_factory.hpp>
 
@@ -42,27 +45,31 @@ typedef io::async_output_ptr<audio_const_range> audio_async_output_ptr;
 
 class node_output : public node0
 {
+    /*
+     * Every slot has its own ring buffer, which is written by
+     * do_update () and read from the device thread in do_output ().
+     */
     struct slot
     {
-        audio_ring_range::position  m_ptr;
+        audio_spsc_ring_buffer      m_ring;
         audio_async_output_ptr      m_out;
 	node_output* m_parent;
 	audio_buffer m_buf;
 
 	slot (audio_async_output_ptr out,
               node_output* parent,
-              audio_ring_range::position ptr,
               const audio_info& info);
 
         void callback (std::size_t nframes);
     };
 
-    audio_ring_buffer m_buffer;
-
     node_manager* m_manager;
     std::list<slot*> m_slots;
     std::list<audio_output_ptr > m_passive_slots;
 
+    std::atomic<std::size_t> m_render_ahead;
+    std::unique_ptr<io::render_ahead> m_render;
+
     /*
       RWLock m_buflock;
       Mutex m_passive_lock;
@@ -71,6 +78,10 @@ class node_output : public node0
 
     void do_output (slot& slot, size_t nframes);
 
+    bool needs_render ();
+    void render ();
+    void update_render_thread ();
+
     void do_update (const node0* caller, int caller_port_type, int caller_port);
     void do_advance () {}
     void on_info_change ();
@@ -105,16 +116,38 @@ public:
 	if (m_manager != NULL && mgr != NULL)
 	    return false; /* Already attached */
 
+	m_render->soft_stop ();
 	m_manager = mgr;
+	update_render_thread ();
 	return true;
     }
 
+    /**
+     * Keeps the buffers of the asynchronous outputs filled this many
+     * frames ahead from a separate thread, so the device callbacks
+     * only have to copy data. Zero disables it and the graph is then
+     * processed from the callbacks themselves.
+     *
+     * Outputs attached afterwards get buffers big enough for the
+     * given amount.
+     */
+    void set_render_ahead (std::size_t frames);
+
+    std::size_t get_render_ahead () const {
+	return m_render_ahead;
+    }
+
+    io::render_ahead_stats get_render_stats () const {
+	return m_render->stats ();
+    }
+
+    void reset_render_stats () {
+	m_render->reset_stats ();
+    }
+
     void attach_output (audio_async_output_ptr out)
     {
-	//m_buflock.readLock();
-	m_slots.push_back(
-            new slot (out, this, range (m_buffer).begin_pos(), get_info()));
-	//m_buflock.unlock();
+	m_slots.push_back (new slot (out, this, get_info ()));
     }
 
     void detach_output (audio_async_output_ptr out)
@@ -33,65 +33,152 @@ namespace psynth
 namespace graph
 {
 
-void node_param::update_in ()
+namespace
 {
-    m_mutex.lock();
-    if (m_changed) {
-	switch(m_type) {
-	case INT:
-	    *static_cast<int*>(m_dest) = *static_cast<int*>(m_src);
-	    break;
-	case FLOAT:
-	    *static_cast<float*>(m_dest) = *static_cast<float*>(m_src);
-	    break;
-	case STRING:
-	    *static_cast<std::string*>(m_dest) = *static_cast<std::string*>(m_src);
-	    break;
-	case VECTOR2F:
-	    *static_cast<vector_2f*>(m_dest) = *static_cast<vector_2f*>(m_src);
-	    break;
-	default: break;
-	};
-	m_changed = false;
+
+template <typename T>
+void delete_value (void*& p)
+{
+    delete static_cast<T*>(p);
+    p = NULL;
+}
+
+template <typename T>
+void* new_value (const void* init)
+{
+    return new T (*static_cast<const T*>(init));
+}
+
+template <typename T>
+void read_out (const atomic<unsigned>& seq, const void* src, void* dest)
+{
+    T value;
+    unsigned before;
+    do {
+	before = seq.load (std::memory_order_acquire);
+	value = *static_cast<const T*>(src);
+	std::atomic_thread_fence (std::memory_order_acquire);
+    } while ((before & 1) || seq.load (std::memory_order_relaxed) != before);
+    *static_cast<T*>(dest) = value;
+}
+
+} /* anonymous namespace */
+
+template <typename T>
+bool node_param::update_in_value ()
+{
+    const unsigned seq = m_src_seq.load (std::memory_order_acquire);
+    if (seq & 1)
+	return false;
+
+    const T value = *static_cast<T*>(m_src);
+    std::atomic_thread_fence (std::memory_order_acquire);
+    if (m_src_seq.load (std::memory_order_relaxed) != seq)
+	return false;
+
+    *static_cast<T*>(m_dest) = value;
+    write_out (value);
+    m_read_seq.store (seq, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+void node_param::write_out (const T& value)
+{
+    begin_write (m_out_seq);
+    *static_cast<T*>(m_out) = value;
+    end_write (m_out_seq);
+}
+
+bool node_param::update_in ()
+{
+    switch(m_type) {
+    case INT:
+	return update_in_value<int> ();
+    case FLOAT:
+	return update_in_value<float> ();
+    case VECTOR2F:
+	return update_in_value<vector_2f> ();
+    case STRING: {
+	unique_lock<mutex> lock (m_mutex, try_to_lock);
+	if (!lock)
+	    return false;
+	*static_cast<string*>(m_dest) = *static_cast<string*>(m_src);
+	*static_cast<string*>(m_out) = *static_cast<string*>(m_src);
+	m_read_seq.store (m_src_seq.load (std::memory_order_relaxed),
+			  std::memory_order_release);
+	return true;
     }
-    m_mutex.unlock();
+    default:
+	return true;
+    };
 }
 
-void node_param::update_out ()
+bool node_param::update_out ()
 {
-    m_mutex.lock();
     switch(m_type) {
-	case INT:
-	    *static_cast<int*>(m_src) = *static_cast<int*>(m_dest);
-	    break;
-	case FLOAT:
-	    *static_cast<float*>(m_src) = *static_cast<float*>(m_dest);
-	    break;
-	case STRING:
-	    *static_cast<std::string*>(m_src) = *static_cast<std::string*>(m_dest);
-	    break;
-	case VECTOR2F:
-	    *static_cast<vector_2f*>(m_src) = *static_cast<vector_2f*>(m_dest);
-	    break;
-	default: break;
+    case INT:
+	write_out (*static_cast<int*>(m_dest));
+	return true;
+    case FLOAT:
+	write_out (*static_cast<float*>(m_dest));
+	return true;
+    case VECTOR2F:
+	write_out (*static_cast<vector_2f*>(m_dest));
+	return true;
+    case STRING: {
+	unique_lock<mutex> lock (m_mutex, try_to_lock);
+	if (!lock)
+	    return false;
+	*static_cast<string*>(m_out) = *static_cast<string*>(m_dest);
+	return true;
+    }
+    default:
+	return true;
+    };
+}
+
+/*
+ * Called with m_mutex held, so strings are never being written by the
+ * audio thread.
+ */
+void node_param::get_out (void* d) const
+{
+    switch(m_type) {
+    case INT:
+	read_out<int> (m_out_seq, m_out, d);
+	break;
+    case FLOAT:
+	read_out<float> (m_out_seq, m_out, d);
+	break;
+    case STRING:
+	*static_cast<std::string*>(d) = *static_cast<std::string*>(m_out);
+	break;
+    case VECTOR2F:
+	read_out<vector_2f> (m_out_seq, m_out, d);
+	break;
+    default: break;
     };
-    m_mutex.unlock();
 }
 
 void node_param::clear ()
 {
     switch(m_type) {
     case INT:
-	delete static_cast<int*>(m_src);
+	delete_value<int> (m_src);
+	delete_value<int> (m_out);
 	break;
     case FLOAT:
-	delete static_cast<float*>(m_src);
+	delete_value<float> (m_src);
+	delete_value<float> (m_out);
 	break;
     case STRING:
-	delete static_cast<std::string*>(m_src);
+	delete_value<string> (m_src);
+	delete_value<string> (m_out);
 	break;
     case VECTOR2F:
-	delete static_cast<vector_2f*>(m_src);
+	delete_value<vector_2f> (m_src);
+	delete_value<vector_2f> (m_out);
 	break;
     default: break;
     }
@@ -118,24 +205,21 @@ void node_param::configure (int id, std::string name,
 	m_type = type;
 
 	switch(m_type) {
-	case NONE:
-	    m_src = NULL;
-	    break;
 	case INT:
-	    m_src = new int;
-	    *static_cast<int*>(m_src) = *static_cast<int*>(m_dest);
+	    m_src = new_value<int> (m_dest);
+	    m_out = new_value<int> (m_dest);
 	    break;
 	case FLOAT:
-	    m_src = new float;
-	    *static_cast<float*>(m_src) = *static_cast<float*>(m_dest);
+	    m_src = new_value<float> (m_dest);
+	    m_out = new_value<float> (m_dest);
 	    break;
 	case STRING:
-	    m_src = new string;
-	    *static_cast<string*>(m_src) = *static_cast<string*>(m_dest);
+	    m_src = new_value<string> (m_dest);
+	    m_out = new_value<string> (m_dest);
 	    break;
 	case VECTOR2F:
-	    m_src = new vector_2f;
-	    *static_cast<vector_2f*>(m_src) = *static_cast<vector_2f*>(m_dest);
+	    m_src = new_value<vector_2f> (m_dest);
+	    m_out = new_value<vector_2f> (m_dest);
 	    break;
 	default: break;
 	}
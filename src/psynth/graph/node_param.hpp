@@ -23,6 +23,8 @@
 #ifndef PSYNTH_OBJPARAM
 #define PSYNTH_OBJPARAM
 
+#include <atomic>
+#include <cstdint>
 #include <mutex>
 
 #include <boost/function.hpp>
@@ -33,6 +35,15 @@ namespace psynth
 namespace graph
 {
 
+/**
+ * A parameter of a node. It is set and read from the user threads
+ * while the audio thread keeps its own copy in the node.
+ *
+ * The values going in and out of the audio thread are each protected
+ * by a sequence lock, so the audio thread never waits: when it finds
+ * a value being written it just tries again in the next block. String
+ * values can not be copied that way and use a @c try_lock instead.
+ */
 class node_param
 {
 public:
@@ -50,14 +61,23 @@ public:
 
     node_param () :
 	m_type(NONE),
-	m_changed(false),
 	m_src(NULL),
-	m_dest(NULL)
+	m_out(NULL),
+	m_dest(NULL),
+	m_src_seq(0),
+	m_read_seq(0),
+	m_out_seq(0),
+	m_dirty(NULL)
 	{}
 
     node_param (const node_param& obj) :
 	m_type(NONE),
-	m_changed(false) {
+	m_src(NULL),
+	m_out(NULL),
+	m_src_seq(0),
+	m_read_seq(0),
+	m_out_seq(0),
+	m_dirty(obj.m_dirty) {
 	configure(obj.m_id, obj.m_name, obj.m_type, obj.m_dest, obj.m_event);
     }
 
@@ -66,8 +86,10 @@ public:
     }
 
     node_param& operator= (const node_param& obj) {
-	if (this != &obj)
+	if (this != &obj) {
+	    m_dirty = obj.m_dirty;
 	    configure(obj.m_id, obj.m_name, obj.m_type, obj.m_dest, obj.m_event);
+	}
 
 	return *this;
     }
@@ -88,38 +110,88 @@ public:
     void set (const T& d) {
 	{
 	    std::unique_lock<std::mutex> lock (m_mutex);
-	    m_changed = true;
+	    begin_write (m_src_seq);
 	    *static_cast<T*>(m_src) = d;
+	    end_write (m_src_seq);
 	}
+	if (m_dirty)
+	    m_dirty->fetch_or (dirty_bit (m_id), std::memory_order_release);
 	if (!m_event.empty()) m_event(*this);
     }
 
+    /**
+     * Returns the last value set, or the value that the node is
+     * using when that has already been applied.
+     */
     template <typename T>
     void get (T& d) const {
-	m_mutex.lock ();
-	d = *static_cast<T*>(m_src);
-	m_mutex.unlock ();
+	std::unique_lock<std::mutex> lock (m_mutex);
+	if (m_src_seq.load (std::memory_order_relaxed) !=
+	    m_read_seq.load (std::memory_order_acquire))
+	    d = *static_cast<T*>(m_src);
+	else
+	    get_out (&d);
+    }
+
+    /** Parameters sharing a bit in the dirty mask of the node. */
+    static const int dirty_bits = 64;
+
+    static std::uint64_t dirty_bit (int id) {
+	return std::uint64_t (1) << (id % dirty_bits);
     }
 
 private:
     friend class node0;
 
+    /*
+     * Serializes the writers of m_src. The audio thread only takes it,
+     * without waiting, for string values.
+     */
     mutable std::mutex m_mutex;
 
     std::string m_name;
     int m_id;
     int m_type;
-    bool m_changed;
     event m_event;
-    void* m_src;
+    void* m_src;  /* Written by set. */
+    void* m_out;  /* Written by the audio thread, read by get. */
     void* m_dest;
 
+    std::atomic<unsigned> m_src_seq;
+    std::atomic<unsigned> m_read_seq; /* m_src_seq last applied. */
+    std::atomic<unsigned> m_out_seq;
+    std::atomic<std::uint64_t>* m_dirty;
+
+    static void begin_write (std::atomic<unsigned>& seq) {
+	seq.store (seq.load (std::memory_order_relaxed) + 1,
+		   std::memory_order_relaxed);
+	std::atomic_thread_fence (std::memory_order_release);
+    }
+
+    static void end_write (std::atomic<unsigned>& seq) {
+	seq.store (seq.load (std::memory_order_relaxed) + 1,
+		   std::memory_order_release);
+    }
+
     void clear ();
     void configure (int id, std::string name, int type, void* dest);
     void configure (int id, std::string name, int type, void* dest, event ev);
+    void get_out (void* d) const;
+
+    bool pending () const {
+	return m_src_seq.load (std::memory_order_acquire) !=
+	    m_read_seq.load (std::memory_order_relaxed);
+    }
+
+    /*
+     * These are called from the audio thread and return false when
+     * the value was being written and they should be retried.
+     */
+    bool update_in ();
+    bool update_out ();
 
-    void update_in ();
-    void update_out ();
+    template <typename T> bool update_in_value ();
+    template <typename T> void write_out (const T& value);
 };
 
 } /* namespace graph */
@@ -56,7 +56,6 @@ node_sampler::node_sampler(const audio_info& info):
 	  N_IN_C_SOCKETS,
 	  N_OUT_A_SOCKETS,
 	  N_OUT_C_SOCKETS),
-    m_fetcher (m_reader),
     m_inbuf (info.block_size),
     m_scaler (info.sample_rate),
     m_ctrl_pos (0),
@@ -75,14 +74,10 @@ node_sampler::node_sampler(const audio_info& info):
 
     m_scaler.set_rate (1.0);
     m_scaler.set_frame_rate (info.sample_rate);
-
-    m_fetcher.set_chunk_size (info.block_size);
-    m_fetcher.start ();
 }
 
 node_sampler::~node_sampler ()
 {
-    m_fetcher.stop ();
 }
 
 void node_sampler::on_file_change (node_param& par)
@@ -93,16 +88,17 @@ void node_sampler::on_file_change (node_param& par)
     par.get (val);
     path = base::file_manager::self ().path("psychosynth.samples").find (val);
 
-    std::unique_lock<std::mutex> lock (m_update_mutex);
-
-    m_reader = io::new_file_input <interleaved_range> (path.string ());
-    m_fetcher.set_input (m_reader);
-
-    if (m_reader) {
-        m_inbuf.recreate (get_info ().block_size);
-        // m_scaler.set_channels (2); // HACK HACK
-	// m_scaler.setSampleRate(m_fetcher.get_info().sample_rate);
+    io::sample_data_ptr data;
+    try {
+        data = io::sample_cache::self ().get (path.string ());
+    } catch (io::file_error& err) {
+        err.log ();
     }
+
+    /* The previous sample is released after unlocking. */
+    std::unique_lock<std::mutex> lock (m_update_mutex);
+    m_cursor.swap_data (data);
+    m_scaler.clear ();
 }
 
 void node_sampler::do_update (const node0* caller, int caller_port_type, int caller_port)
@@ -116,7 +112,9 @@ void node_sampler::do_update (const node0* caller, int caller_port_type, int cal
     size_t start = 0;
     size_t end = get_info ().block_size;
 
-    if (m_reader)
+    std::unique_lock<std::mutex> lock (m_update_mutex);
+
+    if (!m_cursor.empty ())
     {
 	while (start < get_info ().block_size) {
 	    if (m_restart) {
@@ -151,27 +149,18 @@ void node_sampler::do_update (const node0* caller, int caller_port_type, int cal
         });
 
     /* Apply trigger envelope. */
-    if (trig_buf) {
-	for (size_t i = 0; i < get_info ().num_channels; ++i) {
-	    sample* buf = (sample*) &range (*out)[0][i];
-	    int n_samp = get_info ().block_size;
-	    trig_buf = (const sample*) &const_range (*trig)[0];
-	    trig_env = get_in_envelope (LINK_CONTROL, IN_C_TRIGGER);
-
-	    while (n_samp--) {
-		float env_val = (float) (audio_sample) trig_env.update();
-		*buf = *buf * ((1.0f - env_val) + (env_val * *trig_buf));
-		++buf;
-		++trig_buf;
-	    }
-	}
-    }
+    if (trig_buf)
+	for (size_t i = 0; i < get_info ().num_channels; ++i)
+	    apply_trigger ((sample*) &range (*out)[0][i],
+                           (const sample*) &const_range (*trig)[0],
+                           get_info ().block_size,
+                           get_in_envelope (LINK_CONTROL, IN_C_TRIGGER));
 
 }
 
 void node_sampler::restart()
 {
-    m_fetcher.seek (0, io::seek_dir::beg);
+    m_cursor.seek (0);
     m_scaler.clear();
 }
 
@@ -182,7 +171,7 @@ void node_sampler::read (audio_buffer& buf, int start, int end)
     const sample* rate_buf = rate ? (const sample*) &const_range (*rate) [0] : 0;
 
     float base_factor =
-	(float) m_reader->frame_rate () / get_info ().sample_rate * m_param_rate;
+	(float) m_cursor.frame_rate () / get_info ().sample_rate * m_param_rate;
 
     int must_read;
     int nread;
@@ -191,12 +180,8 @@ void node_sampler::read (audio_buffer& buf, int start, int end)
     bool backwards = false;;
     bool high_latency = false;
 
-    if (m_update_mutex.try_lock ())
-    {
-        m_scaler.set_tempo (m_param_tempo);
-        m_scaler.set_pitch (m_param_pitch);
-        m_update_mutex.unlock ();
-    }
+    m_scaler.set_tempo (m_param_tempo);
+    m_scaler.set_pitch (m_param_pitch);
 
     if (m_param_tempo != 1.0f ||
 	m_param_pitch != 1.0f)
@@ -216,8 +201,8 @@ void node_sampler::read (audio_buffer& buf, int start, int end)
         if (rate)
 	    factor = base_factor + base_factor * rate_buf[(int) m_ctrl_pos];
 
-	if (backwards != m_fetcher.is_backwards ())
-	    m_fetcher.set_backwards (backwards);
+	if (backwards != m_cursor.is_backwards ())
+	    m_cursor.set_backwards (backwards);
 
 	if (factor < 0.2)
 	    factor = 0.2;
@@ -228,8 +213,7 @@ void node_sampler::read (audio_buffer& buf, int start, int end)
 	else
 	    must_read = must_read;
 
-	m_update_mutex.lock();
-	nread = m_fetcher.take (sub_range (range (m_inbuf), 0, must_read));
+	nread = m_cursor.take (sub_range (range (m_inbuf), 0, must_read));
 
 	if (nread)
         {
@@ -241,13 +225,9 @@ void node_sampler::read (audio_buffer& buf, int start, int end)
             m_scaler.set_rate (factor);
 	    m_scaler.update (sub_range (range (m_inbuf), 0, nread));
 	}
-
-	m_update_mutex.unlock();
     }
 
-    m_update_mutex.lock();
     m_scaler.receive (sub_range (range (m_inbuf), 0, end - start));
-    m_update_mutex.unlock();
 
     copy_and_convert_frames (sub_range (range (m_inbuf), 0, end - start),
                              sub_range (range (buf), start, end - start));
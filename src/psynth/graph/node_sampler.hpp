@@ -26,8 +26,7 @@
 #include <mutex>
 
 #include <psynth/graph/node.hpp>
-#include <psynth/io/file_input.hpp>
-#include <psynth/io/caching_file_input.hpp>
+#include <psynth/io/sample_cache.hpp>
 #include <psynth/graph/node_factory.hpp>
 #include <psynth/synth/scaler.hpp>
 
@@ -73,11 +72,9 @@ private:
     typedef sound::stereo32sf_range  interleaved_range;
     typedef sound::stereo32sf_buffer interleaved_buffer;
 
-    io::file_input_ptr<interleaved_range> m_reader;
-    io::caching_file_input_adapter<interleaved_range,
-                                   decltype (m_reader)> m_fetcher;
+    io::sample_cursor m_cursor;
 
-    interleaved_buffer m_inbuf;;
+    interleaved_buffer m_inbuf;
     synth::scaler<interleaved_range> m_scaler;
 
     float m_ctrl_pos;
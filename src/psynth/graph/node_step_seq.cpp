@@ -85,6 +85,7 @@ void node_step_seq::do_update (const node0* caller,
     const sample_buffer* bpmbuf = get_input<sample_buffer> (LINK_CONTROL, IN_C_BPM);
     const sample* bpm = bpmbuf ? (const sample*) &const_range (*bpmbuf) [0] : 0;
     size_t i;
+    int old_step = m_cur_step;
 
     update_envelope_values ();
 
@@ -104,6 +105,9 @@ void node_step_seq::do_update (const node0* caller,
 	}
     }
 
+    if (m_cur_step != old_step)
+	publish_param (PARAM_CURRENT_STEP);
+
     m_old_param_shape = m_param_shape;
     m_old_param_high = m_param_high;
 }
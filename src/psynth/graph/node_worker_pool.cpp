@@ -0,0 +1,238 @@
+/***************************************************************************
+ *                                                                         *
+ *   PSYCHOSYNTH                                                           *
+ *   ===========                                                           *
+ *                                                                         *
+ *   Copyright (C) Juan Pedro Bolivar Puente 2007                          *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                         *
+ ***************************************************************************/
+
+#include <thread>
+#include <chrono>
+
+#include "io/thread_async.hpp"
+#include "graph/node_worker_pool.hpp"
+
+using namespace std;
+
+namespace psynth
+{
+namespace graph
+{
+
+namespace
+{
+
+/* How many times an idle worker polls for a new run before going to
+ * sleep until the next one. The sleep is bounded only so that
+ * stopping the workers never waits long. */
+const int WORKER_SPIN_COUNT = 64;
+const int WORKER_SLEEP_MS = 100;
+
+} /* anonymous namespace */
+
+class node_worker_pool::worker : public io::thread_async
+{
+public:
+    worker (node_worker_pool& pool, bool realtime)
+        : io::thread_async (callback_type (), realtime)
+        , m_pool (pool)
+        , m_generation (0)
+    {}
+
+    ~worker ()
+    { soft_stop (); }
+
+protected:
+    void prepare ()
+    { m_generation = m_pool.m_generation.load (); }
+
+    void iterate ()
+    { m_pool.worker_iterate (m_generation); }
+
+private:
+    node_worker_pool& m_pool;
+    unsigned m_generation;
+};
+
+node_worker_pool::node_worker_pool (size_t num_workers, job_fn fn,
+                                    bool realtime)
+    : m_fn (fn)
+    , m_num_jobs (0)
+    , m_head (0)
+    , m_tail (0)
+    , m_remaining (0)
+    , m_generation (0)
+    , m_open (false)
+    , m_busy (0)
+    , m_sleeping (0)
+{
+    for (size_t i = 0; i < num_workers; ++i) {
+        m_workers.push_back (unique_ptr<worker> (new worker (*this, realtime)));
+        m_workers.back ()->start ();
+    }
+}
+
+node_worker_pool::~node_worker_pool ()
+{
+    for (size_t i = 0; i < m_workers.size (); ++i)
+        m_workers [i]->soft_stop ();
+    {
+        unique_lock<mutex> lock (m_wait_mutex);
+        m_wait_cond.notify_all ();
+    }
+    m_workers.clear ();
+}
+
+void node_worker_pool::reset (size_t num_jobs)
+{
+    m_num_jobs = num_jobs;
+    m_jobs.reset (new job [num_jobs]);
+    m_queue.reset (new atomic<size_t> [num_jobs]);
+    for (size_t i = 0; i < num_jobs; ++i)
+        m_jobs [i].active = false;
+}
+
+void node_worker_pool::add_dependency (size_t job, size_t before)
+{
+    m_jobs [before].dependents.push_back (job);
+}
+
+void node_worker_pool::run ()
+{
+    size_t i, active = 0;
+
+    for (i = 0; i < m_num_jobs; ++i) {
+        m_jobs [i].pending.store (0, memory_order_relaxed);
+        m_queue [i].store (0, memory_order_relaxed);
+    }
+
+    for (i = 0; i < m_num_jobs; ++i)
+        if (m_jobs [i].active) {
+            ++active;
+            for (vector<size_t>::iterator d = m_jobs [i].dependents.begin();
+                 d != m_jobs [i].dependents.end(); ++d)
+                if (m_jobs [*d].active)
+                    m_jobs [*d].pending.fetch_add (1, memory_order_relaxed);
+        }
+
+    m_head.store (0, memory_order_relaxed);
+    m_tail.store (0, memory_order_relaxed);
+    m_remaining.store (active, memory_order_relaxed);
+
+    for (i = 0; i < m_num_jobs; ++i)
+        if (m_jobs [i].active &&
+            m_jobs [i].pending.load (memory_order_relaxed) == 0)
+            push (i);
+
+    m_open = true;
+    ++m_generation;
+
+    /* Only wake up the workers when some may be asleep. Taking the
+     * mutex makes sure the ones about to sleep see the new run. */
+    if (m_sleeping.load () > 0) {
+        unique_lock<mutex> lock (m_wait_mutex);
+        m_wait_cond.notify_all ();
+    }
+
+    work ();
+
+    /* Wait for the workers that may still be looking at the queue
+     * before we can reuse it in the next run. */
+    m_open = false;
+    while (m_busy.load () != 0)
+        this_thread::yield ();
+}
+
+void node_worker_pool::work ()
+{
+    size_t job;
+
+    while (m_remaining.load (memory_order_acquire) > 0) {
+        if (pop (job)) {
+            m_fn (job);
+            finish (job);
+        } else
+            this_thread::yield ();
+    }
+}
+
+void node_worker_pool::finish (size_t j)
+{
+    vector<size_t>& deps = m_jobs [j].dependents;
+
+    for (vector<size_t>::iterator d = deps.begin(); d != deps.end(); ++d)
+        if (m_jobs [*d].active &&
+            m_jobs [*d].pending.fetch_sub (1, memory_order_acq_rel) == 1)
+            push (*d);
+
+    m_remaining.fetch_sub (1, memory_order_release);
+}
+
+void node_worker_pool::push (size_t job)
+{
+    size_t idx = m_tail.fetch_add (1, memory_order_acq_rel);
+    m_queue [idx].store (job + 1, memory_order_release);
+}
+
+bool node_worker_pool::pop (size_t& job)
+{
+    size_t idx = m_head.load (memory_order_acquire);
+
+    if (idx >= m_tail.load (memory_order_acquire) ||
+        !m_head.compare_exchange_weak (idx, idx + 1))
+        return false;
+
+    /* The slot is reserved but the pusher may not have written it yet. */
+    size_t val;
+    while ((val = m_queue [idx].load (memory_order_acquire)) == 0)
+        this_thread::yield ();
+
+    job = val - 1;
+    return true;
+}
+
+void node_worker_pool::worker_iterate (unsigned& generation)
+{
+    unsigned current = m_generation.load ();
+
+    for (int i = 0; current == generation && i < WORKER_SPIN_COUNT; ++i) {
+        this_thread::yield ();
+        current = m_generation.load ();
+    }
+
+    if (current == generation) {
+        /* Counted before checking, so run() either sees us sleeping
+         * or we see its new generation. */
+        unique_lock<mutex> lock (m_wait_mutex);
+        ++m_sleeping;
+        if (m_generation.load () == generation)
+            m_wait_cond.wait_for (lock,
+                                  chrono::milliseconds (WORKER_SLEEP_MS));
+        --m_sleeping;
+        return;
+    }
+
+    generation = current;
+
+    ++m_busy;
+    if (m_open)
+        work ();
+    --m_busy;
+}
+
+} /* namespace graph */
+} /* namespace psynth */
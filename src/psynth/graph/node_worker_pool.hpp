@@ -0,0 +1,123 @@
+/***************************************************************************
+ *                                                                         *
+ *   PSYCHOSYNTH                                                           *
+ *   ===========                                                           *
+ *                                                                         *
+ *   Copyright (C) Juan Pedro Bolivar Puente 2007                          *
+ *                                                                         *
+ *   This program is free software: you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation, either version 3 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ *                                                                         *
+ ***************************************************************************/
+
+#ifndef PSYNTH_NODE_WORKER_POOL_H
+#define PSYNTH_NODE_WORKER_POOL_H
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+#include <boost/noncopyable.hpp>
+
+namespace psynth
+{
+namespace graph
+{
+
+/**
+ * Runs a set of jobs with dependencies among them using a fixed set
+ * of pre-spawned worker threads, that get RT priority when possible.
+ * The thread calling run() participates in the processing and spins
+ * until the last job is finished.
+ *
+ * Idle workers spin for a while and then sleep until the next run().
+ * run() only takes the mutex, to wake them up, when some of them are
+ * asleep, so workers fed at block rate never miss a run.
+ */
+class node_worker_pool : private boost::noncopyable
+{
+public:
+    typedef std::function<void (std::size_t)> job_fn;
+
+    node_worker_pool (std::size_t num_workers, job_fn fn,
+                      bool realtime = true);
+    ~node_worker_pool ();
+
+    std::size_t num_workers () const
+    { return m_workers.size (); }
+
+    /**
+     * Sets up the storage for @a num_jobs jobs without any
+     * dependencies, all of them inactive. Not RT safe.
+     */
+    void reset (std::size_t num_jobs);
+
+    /**
+     * Makes @a job wait for @a before to finish. Not RT safe.
+     */
+    void add_dependency (std::size_t job, std::size_t before);
+
+    /**
+     * Sets whether a job should be run in the next call to
+     * run(). Inactive jobs are ignored, also as dependencies.
+     */
+    void set_active (std::size_t job, bool active)
+    { m_jobs [job].active = active; }
+
+    /**
+     * Runs all the active jobs and returns when they are done.
+     */
+    void run ();
+
+private:
+    class worker;
+
+    struct job
+    {
+        std::vector<std::size_t> dependents;
+        bool active;
+        std::atomic<int> pending;
+    };
+
+    void work ();
+    void finish (std::size_t job);
+    void push (std::size_t job);
+    bool pop (std::size_t& job);
+    void worker_iterate (unsigned& generation);
+
+    job_fn m_fn;
+    std::vector<std::unique_ptr<worker> > m_workers;
+
+    std::size_t m_num_jobs;
+    std::unique_ptr<job[]> m_jobs;
+    std::unique_ptr<std::atomic<std::size_t>[]> m_queue;
+    std::atomic<std::size_t> m_head;
+    std::atomic<std::size_t> m_tail;
+    std::atomic<std::size_t> m_remaining;
+
+    std::atomic<unsigned> m_generation;
+    std::atomic<bool> m_open;
+    std::atomic<int> m_busy;
+    std::atomic<int> m_sleeping;
+
+    std::mutex m_wait_mutex;
+    std::condition_variable m_wait_cond;
+};
+
+} /* namespace graph */
+} /* namespace psynth */
+
+#endif /* PSYNTH_NODE_WORKER_POOL_H */
@@ -105,6 +105,7 @@ alsa_raw_output::alsa_raw_output (const char*       device,
         PSYNTH_LOG << base::log::warning
                    << "ALSA does not like the selected frame rate and instead "
                    << "it chose: " << actual_rate;
+    deadline ().set_frame_rate (actual_rate);
 
     PSYNTH_ALSA_CHECK (snd_pcm_hw_params_set_channels (
                            _handle, _hw_params, channels),
@@ -198,7 +199,7 @@ alsa_raw_output::~alsa_raw_output ()
 namespace
 {
 
-int alsa_xrun_recovery (snd_pcm_t* handle)
+int alsa_xrun_recovery (snd_pcm_t* handle, deadline_monitor& monitor)
 {
     snd_pcm_status_t *status;
     int res;
@@ -221,6 +222,7 @@ int alsa_xrun_recovery (snd_pcm_t* handle)
     }
 
     if (snd_pcm_status_get_state(status) == SND_PCM_STATE_XRUN) {
+        monitor.add_xrun ();
 #if PSYNTH_ALSA_REPORT_XRUN
         struct timeval now, diff, tstamp;
         snd_pcm_status_get_tstamp (status,&now);
@@ -232,6 +234,11 @@ int alsa_xrun_recovery (snd_pcm_t* handle)
             "Buffer underrun of at least " <<
             delayed_usecs / 1000.0 << " msecs.";
 #endif
+        if ((res = snd_pcm_prepare (handle)) < 0)
+            PSYNTH_LOG << base::log::error <<
+                "Error preparing after underrun: " << snd_strerror(res);
+        else
+            monitor.add_recovery ();
     }
 
     return res;
@@ -245,7 +252,7 @@ std::size_t alsa_raw_output::put_i (const void* data, std::size_t frames)
 
     res = snd_pcm_writei (_handle, data, frames);
 
-    if (res < 0 && alsa_xrun_recovery (_handle) < 0)
+    if (res < 0 && alsa_xrun_recovery (_handle, deadline ()) < 0)
     {
         PSYNTH_LOG << "Write error: " << snd_strerror (res);
         return 0;
@@ -260,7 +267,7 @@ std::size_t alsa_raw_output::put_n (const void* const* data, std::size_t frames)
 
     res = snd_pcm_writen (_handle, (void**) data, frames);
 
-    if (res < 0 && alsa_xrun_recovery (_handle) < 0)
+    if (res < 0 && alsa_xrun_recovery (_handle, deadline ()) < 0)
     {
         PSYNTH_LOG << "Write error: " << snd_strerror (res);
         return 0;
@@ -310,10 +317,17 @@ void alsa_raw_output::iterate ()
 
     if (nframes_or_err < 0)
     {
-        alsa_xrun_recovery(_handle);
+        alsa_xrun_recovery (_handle, deadline ());
     }
     else
     {
+        // The device does not stop on underruns, it just keeps
+        // playing whatever is in the buffer until we catch up.
+        if (std::size_t (nframes_or_err) > _buffer_size)
+        {
+            deadline ().add_xrun ();
+            deadline ().add_recovery ();
+        }
         process (std::min<std::size_t> (nframes_or_err, _buffer_size));
     }
 }
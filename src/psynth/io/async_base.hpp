@@ -35,6 +35,7 @@
 #include <atomic>
 
 #include <psynth/io/exception.hpp>
+#include <psynth/io/deadline_monitor.hpp>
 
 namespace psynth
 {
@@ -63,6 +64,27 @@ public:
     virtual async_state state () const = 0;
     virtual void set_callback (callback_type cb) = 0;
 
+    /**
+     * Timing of the device callbacks. Devices that do not monitor
+     * them return empty statistics.
+     */
+    virtual deadline_stats get_deadline_stats () const
+    { return deadline_stats (); }
+
+    virtual void reset_deadline_stats () {}
+
+    /**
+     * Callbacks taking more than @a load of their deadline, and xruns,
+     * are logged when this is not zero.
+     */
+    virtual void set_deadline_log_threshold (float load) {}
+
+    /**
+     * Logs what went over the threshold since the last time. To be
+     * called periodically out of the device thread.
+     */
+    virtual void log_deadline_report () {}
+
     void soft_start ()
     {
         if (state () == async_state::idle)
@@ -118,17 +140,41 @@ public:
         _callback = cb;
     }
 
+    deadline_stats get_deadline_stats () const
+    { return _deadline.stats (); }
+
+    void reset_deadline_stats ()
+    { _deadline.reset_stats (); }
+
+    void set_deadline_log_threshold (float load)
+    { _deadline.set_log_threshold (load); }
+
+    void log_deadline_report ()
+    { _deadline.log_report (); }
+
 protected:
     void set_state (async_state state)
     { _state = (int) state; }
 
     void process (std::size_t nframes)
-    { _callback (nframes); }
+    {
+        _deadline.begin_callback ();
+        _callback (nframes);
+        _deadline.end_callback (nframes);
+    }
+
+    /**
+     * Implementations should set the frame rate of the monitor and
+     * count the xruns of the device.
+     */
+    deadline_monitor& deadline ()
+    { return _deadline; }
 
 private:
     std::atomic<int> _state; // FIXME: Why does GCC does not support
                              // this with an enum?
     callback_type    _callback;
+    deadline_monitor _deadline;
 };
 
 };
@@ -42,6 +42,7 @@
 
 #include <psynth/base/type_traits.hpp>
 #include <psynth/sound/metafunctions.hpp>
+#include <psynth/sound/dither.hpp>
 #include <psynth/io/output.hpp>
 
 namespace psynth
@@ -52,8 +53,17 @@ namespace io
 namespace detail
 {
 
+/** Converts the frames into the buffer as copy_and_convert_frames. */
+struct buffered_output_converter
+{
+    template <class Range1, class Range2>
+    void operator () (const Range1& src, const Range2& dst)
+    { copy_and_convert_frames (src, dst); }
+};
+
 template <class Base, // either output or async_output
-          class OutputPtr>
+          class OutputPtr,
+          class Converter = buffered_output_converter>
 class buffered_output_impl : public Base
 {
 public:
@@ -89,6 +99,16 @@ public:
     void set_buffer_size (std::size_t new_size)
     { _buffer.recreate (new_size); }
 
+    /**
+     * Dither applied by a sound::dither_converter. Asynchronous
+     * outputs must be idle to change it.
+     */
+    sound::dither_mode dither_mode () const
+    { return _converter.mode (); }
+
+    void set_dither_mode (sound::dither_mode mode)
+    { _converter.set_mode (mode); }
+
 protected:
     void set_output (OutputPtr ptr)
     {
@@ -97,14 +117,16 @@ protected:
 
     buffer_type _buffer;
     OutputPtr   _output_ptr;
+    Converter   _converter;
 };
 
-template <class Base, class OutputPtr>
+template <class Base, class OutputPtr,
+          class Converter = buffered_output_converter>
 class buffered_async_output_impl :
-        public buffered_output_impl<Base, OutputPtr>
+        public buffered_output_impl<Base, OutputPtr, Converter>
 {
 public:
-    typedef buffered_output_impl<Base, OutputPtr> base;
+    typedef buffered_output_impl<Base, OutputPtr, Converter> base;
     typedef typename base::callback_type callback_type;
 
     buffered_async_output_impl (OutputPtr output_ptr = 0)
@@ -127,17 +149,35 @@ public:
 
     void set_callback (callback_type cb)
     { this->_output_ptr->set_callback (cb); }
+
+    deadline_stats get_deadline_stats () const
+    { return this->_output_ptr->get_deadline_stats (); }
+
+    void reset_deadline_stats ()
+    { this->_output_ptr->reset_deadline_stats (); }
+
+    void set_deadline_log_threshold (float load)
+    { this->_output_ptr->set_deadline_log_threshold (load); }
+
+    void log_deadline_report ()
+    { this->_output_ptr->log_deadline_report (); }
 };
 
 } /* namespace detail */
 
 
-template <class Range, class OutputPtr>
+/**
+ * The buffered outputs convert the frames with @a Converter. Use
+ * sound::dither_converter to dither the frames when the output has
+ * integer samples, instead of just rounding them.
+ */
+template <class Range, class OutputPtr, class Converter>
 class buffered_output_adapter :
-    public detail::buffered_output_impl<output<Range>, OutputPtr>
+    public detail::buffered_output_impl<output<Range>, OutputPtr, Converter>
 {
 public:
-    typedef detail::buffered_output_impl<output<Range>, OutputPtr> base;
+    typedef detail::buffered_output_impl<output<Range>, OutputPtr,
+                                         Converter> base;
 
     buffered_output_adapter (OutputPtr out = 0)
         : base (out)
@@ -148,12 +188,13 @@ public:
 };
 
 
-template <class Range, class Output>
+template <class Range, class Output, class Converter>
 class buffered_output :
-    public detail::buffered_output_impl<output<Range>, Output*>
+    public detail::buffered_output_impl<output<Range>, Output*, Converter>
 {
 public:
-    typedef detail::buffered_output_impl<output<Range>, Output*> base;
+    typedef detail::buffered_output_impl<output<Range>, Output*,
+                                         Converter> base;
 
     template <typename... Args>
     buffered_output (Args... args)
@@ -166,13 +207,14 @@ private:
 };
 
 
-template <class Range, class OutputPtr>
+template <class Range, class OutputPtr, class Converter>
 class buffered_async_output_adapter :
-    public detail::buffered_async_output_impl<async_output<Range>, OutputPtr>
+    public detail::buffered_async_output_impl<async_output<Range>, OutputPtr,
+                                              Converter>
 {
 public:
     typedef detail::buffered_async_output_impl<async_output<Range>,
-                                               OutputPtr> base;
+                                               OutputPtr, Converter> base;
 
     buffered_async_output_adapter (OutputPtr out = 0)
         : base (out)
@@ -186,13 +228,14 @@ public:
 };
 
 
-template <class Range, class Output>
+template <class Range, class Output, class Converter>
 class buffered_async_output :
-    public detail::buffered_async_output_impl<async_output<Range>, Output*>
+    public detail::buffered_async_output_impl<async_output<Range>, Output*,
+                                              Converter>
 {
 public:
     typedef detail::buffered_async_output_impl<async_output<Range>,
-                                               Output*> base;
+                                               Output*, Converter> base;
 
     /**
      * @todo Use std::forward when available.
@@ -58,16 +58,16 @@ struct buffered_output_put_fn<R, R>
     { return out.output ().put (data); }
 };
 
-template <class Ir, class Op>
-std::size_t buffered_output_impl<Ir, Op>::put (const const_range& data)
+template <class Ir, class Op, class Cv>
+std::size_t buffered_output_impl<Ir, Op, Cv>::put (const const_range& data)
 {
     buffered_output_put_fn <const_range, output_const_range> p;
     return p (*this, data);
 }
 
-template <class Ir, class Op>
+template <class Ir, class Op, class Cv>
 template <class Range>
-std::size_t buffered_output_impl<Ir, Op>::put (const Range& data)
+std::size_t buffered_output_impl<Ir, Op, Cv>::put (const Range& data)
 {
     std::size_t block_size  = _buffer.size ();
     std::size_t total       = data.size ();
@@ -81,15 +81,15 @@ std::size_t buffered_output_impl<Ir, Op>::put (const Range& data)
         auto src = sub_range (data, written, to_write);
         auto dst = sub_range (sound::range (_buffer), 0, to_write);
         old_written = written;
-        copy_and_convert_frames (src, dst);
+        _converter (src, dst);
         written += _output_ptr->put (dst);
     }
 
     return written;
 }
 
-template <class Ir, class Op>
-void buffered_async_output_impl<Ir, Op>::fit_buffer ()
+template <class Ir, class Op, class Cv>
+void buffered_async_output_impl<Ir, Op, Cv>::fit_buffer ()
 {
     this->_output_ptr->check_idle ();
     std::size_t new_size = this->_output_ptr->buffer_size ();
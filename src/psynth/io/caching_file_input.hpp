@@ -37,7 +37,6 @@
 
 #include <type_traits>
 #include <mutex>
-#include <thread>
 #include <condition_variable>
 
 #include <boost/pointee.hpp>
@@ -46,6 +45,7 @@
 #include <psynth/sound/ring_buffer.hpp>
 #include <psynth/io/file_common.hpp>
 #include <psynth/io/async_base.hpp>
+#include <psynth/io/prefetch_pool.hpp>
 
 namespace psynth
 {
@@ -55,10 +55,15 @@ namespace io
 namespace detail
 {
 
+/**
+ * Reads ahead from a file into a ring buffer. The refills are done by
+ * the shared prefetch pool when the buffer goes under the threshold,
+ * filling it as much as possible each time.
+ */
 template <class Range,
           class InputPtr> // Models file_input_base
 class caching_file_input_impl : public file_input_base<Range>
-                              , private boost::noncopyable
+                              , private prefetch_stream
 {
 public:
     typedef Range range;
@@ -151,14 +156,16 @@ public:
     std::ptrdiff_t _read_pos;
     std::ptrdiff_t _new_read_pos;
 
-    std::atomic<bool> _finished;
+    bool           _started;
 
-    std::thread             _thread;
     std::mutex              _input_mutex;
     std::mutex              _buffer_mutex;
     std::condition_variable _cond;
 
-    void run ();
+    /** Must be called with the _buffer_mutex locked. */
+    void request_refill ();
+
+    void prefetch ();
 };
 
 } /* namespace detail */
@@ -44,23 +44,36 @@ namespace detail
 template <class R, class I>
 caching_file_input_impl<R, I>::~caching_file_input_impl ()
 {
-    // TODO!!
-    //if (!_finished)
-    //    stop ();
+    if (_started)
+        stop ();
 }
 
 template <class R, class I>
 void caching_file_input_impl<R, I>::start ()
 {
-    // TODO: Error checking
-    if (_thread.get_id () == std::thread::id ())
+    std::unique_lock<std::mutex> lock (_buffer_mutex);
+    if (!_started)
     {
-        _finished = false;
-        _thread = std::thread (
-            std::bind (&caching_file_input_impl::run, this));
+        _started = true;
+        request_refill ();
     }
 }
 
+template <class R, class I>
+void caching_file_input_impl<R, I>::request_refill ()
+{
+    if (!_started || !_input)
+        return;
+
+    // The buffer runs out once its frames have been played.
+    const std::ptrdiff_t avail = std::max<std::ptrdiff_t> (
+        _range.available (_read_ptr), 0);
+    const std::size_t rate = std::max<std::size_t> (_input->frame_rate (), 1);
+    prefetch_pool::self ().request (
+        *this, clock::now () + std::chrono::nanoseconds (
+            avail * INT64_C (1000000000) / std::ptrdiff_t (rate)));
+}
+
 template <class R, class I>
 caching_file_input_impl<R, I>::caching_file_input_impl (
     I           input,
@@ -71,14 +84,14 @@ caching_file_input_impl<R, I>::caching_file_input_impl (
     , _chunk_size (chunk_size)
     , _buffer_size (buffer_size)
     , _threshold (threshold)
-    , _tmp_buffer (threshold)
+    , _tmp_buffer (buffer_size)
     , _buffer (buffer_size)
     , _range (sound::range (_buffer))
     , _read_ptr (_range.end_pos ())
     , _backwards (false)
     , _read_pos (0)
     , _new_read_pos (_read_pos)
-    , _finished (true)
+    , _started (false)
 {
     assert (chunk_size < threshold && threshold < buffer_size);
 }
@@ -110,6 +123,8 @@ void caching_file_input_impl<R, I>::set_backwards (bool backwards)
 	    if (_new_read_pos >= std::ptrdiff_t (_chunk_size))
 		_new_read_pos -= _chunk_size;
 	}
+
+        request_refill ();
     }
 }
 
@@ -130,14 +145,10 @@ std::size_t caching_file_input_impl<R, I>::seek (
         _read_pos = _input->seek (offset, dir);
         _read_ptr = _range.end_pos ();
     }
-    _cond.notify_all();
+    request_refill ();
     return _read_pos;
 }
 
-/**
- * @todo Fix potential performance lost with the std::reverse, think
- * of an override in psynth::sound.
- */
 template <class R, class I>
 template <typename Range>
 std::size_t caching_file_input_impl<R, I>::take (const Range& buf)
@@ -149,7 +160,10 @@ std::size_t caching_file_input_impl<R, I>::take (const Range& buf)
 	std::unique_lock<std::mutex> lock (_buffer_mutex);
 
 	while (_range.available (_read_ptr) <= 0)
+        {
+            request_refill ();
             _cond.wait (lock);
+        }
 
 	nread = std::min<std::size_t> (nsamples, _range.available (_read_ptr));
 
@@ -159,11 +173,7 @@ std::size_t caching_file_input_impl<R, I>::take (const Range& buf)
 
             // TODO: Why is ring_buffer_range::size_type signed?
 	    if ((std::size_t) _range.available (_read_ptr) < _threshold)
-		_cond.notify_all ();
-
-	    lock.unlock ();
-	    if (_backwards)
-                std::reverse (buf.begin (), buf.begin () + nread);
+		request_refill ();
 	}
     }
 
@@ -178,88 +188,104 @@ void caching_file_input_impl<R, I>::do_seek (std::ptrdiff_t offst,
 }
 
 template <class R, class I>
-void caching_file_input_impl<R, I>::run ()
+void caching_file_input_impl<R, I>::prefetch ()
 {
     std::ptrdiff_t nread;
     std::ptrdiff_t must_read;
+    std::ptrdiff_t free_space;
+    int empty_reads = 0;
+
+    /*
+     * Fill the buffer as much as we can such that the stream is not
+     * scheduled again too soon.  An empty read at the end of the file
+     * loops to the beginning, a second one means there is nothing to
+     * read.
+     */
+    while (empty_reads < 2)
+    {
+        {
+            std::unique_lock<std::mutex> lock (_buffer_mutex);
+            free_space = _buffer_size - std::max<std::ptrdiff_t> (
+                _range.available (_read_ptr), 0);
+            if (!_started || free_space < (std::ptrdiff_t) _threshold)
+                break;
+        }
 
-    do {
 	/* Read the data. */
 	{
 	    nread = 0;
 	    std::unique_lock<std::mutex> lock (_input_mutex);
 
-	    if (_input)
+	    if (!_input)
+                break;
+
+            must_read = _threshold;
+
+            /*
+             * Backwards reading needs seeking, so we read all the
+             * free space at once to seek once per refill.
+             */
+            if (_backwards)
             {
-		must_read = _threshold;
-
-		/* Backwards reading needs seeking. */
-		if (_backwards)
-                {
-                    _new_read_pos -= must_read;
-                    if (_new_read_pos == -must_read)
-                        _new_read_pos += _input->length ();
-                    if (_new_read_pos < 0) {
-                        must_read += _new_read_pos;
-                        _new_read_pos = 0;
-                    }
+                must_read = free_space;
+                _new_read_pos -= must_read;
+                if (_new_read_pos == -must_read)
+                    _new_read_pos += _input->length ();
+                if (_new_read_pos < 0) {
+                    must_read += _new_read_pos;
+                    _new_read_pos = 0;
                 }
+            }
 
-                if (_new_read_pos >= (std::ptrdiff_t) _input->length ())
-                    _new_read_pos = 0;
+            if (_new_read_pos >= (std::ptrdiff_t) _input->length ())
+                _new_read_pos = 0;
 
-                assert (_new_read_pos >= 0);
-                assert (_new_read_pos <= _input->length ());
+            assert (_new_read_pos >= 0);
+            assert (_new_read_pos <= _input->length ());
 
-                /* Do we have to seek */
-                if (_new_read_pos != _read_pos)
-                {
-                    _read_pos = _new_read_pos;
-                    do_seek (_read_pos, seek_dir::beg);
-                }
+            /* Do we have to seek */
+            if (_new_read_pos != _read_pos)
+            {
+                _read_pos = _new_read_pos;
+                do_seek (_read_pos, seek_dir::beg);
+            }
 
-                auto block = sound::sub_range (
-                    sound::range (_tmp_buffer), 0, must_read);
-		nread = _input->take (block);
-
-		/* Check wether whe have finished reading and loop. */
-                if (!_backwards)
-                {
-                    _read_pos += nread;
-                    _new_read_pos = _read_pos;
-                    if (!nread)
-                        _new_read_pos = 0;
-                }
-	    }
+            auto block = sound::sub_range (
+                sound::range (_tmp_buffer), 0, must_read);
+            nread = _input->take (block);
+
+            /* Check wether whe have finished reading and loop. */
+            if (!_backwards)
+            {
+                _read_pos += nread;
+                _new_read_pos = _read_pos;
+                if (!nread)
+                    _new_read_pos = 0;
+            }
 	} /* lock _input_mutex */
 
 	/* Add it to the buffer. */
 	if (nread)
         {
+            empty_reads = 0;
 	    std::unique_lock<std::mutex> lock (_buffer_mutex);
             auto block = sound::sub_range (sound::range (_tmp_buffer), 0, nread);
             _range.write_and_convert (block);
             _cond.notify_all ();
 	}
-
-	/* Wait until more data is needed. */
-	{
-	    std::unique_lock<std::mutex> lock (_buffer_mutex);
-	    while (!_finished &&
-		   ((std::size_t) _range.available (_read_ptr) > _threshold
-                    || !_input))
-		_cond.wait (lock);
-	}
-    } while (!_finished);
+        else
+            ++ empty_reads;
+    }
 }
 
 template <class R, class I>
 void caching_file_input_impl<R, I>::stop ()
 {
-    _finished = true;
-    _cond.notify_all ();
-    _thread.join ();
-    _finished = false;
+    {
+        std::unique_lock<std::mutex> lock (_buffer_mutex);
+        _started = false;
+    }
+    prefetch_pool::self ().cancel (*this);
 }
 
 /** @todo use this to implement set_input */
@@ -271,7 +297,7 @@ void caching_file_input_impl<R, I>::set_input (I input)
         std::unique_lock<std::mutex> input_lock  (_input_mutex);
         _input = input;
     }
-    _cond.notify_all();
+    request_refill ();
 }
 
 } /* namespace detail */
@@ -0,0 +1,161 @@
+/**
+ *  Time-stamp:  <2011-07-10 18:21:12 raskolnikov>
+ *
+ *  @file        deadline_monitor.cpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sun Jul 10 16:02:33 2011
+ *
+ *  Timing of the callbacks of asynchronous devices.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#define PSYNTH_MODULE_NAME "psynth.io.deadline"
+
+#include <algorithm>
+
+#include "base/logger.hpp"
+#include "deadline_monitor.hpp"
+
+namespace psynth
+{
+namespace io
+{
+
+constexpr std::size_t deadline_stats::headroom_buckets;
+constexpr std::uint64_t deadline_monitor::load_scale;
+
+deadline_monitor::deadline_monitor ()
+    : _frame_rate (0)
+    , _log_threshold (0)
+    , _report_over (0)
+    , _report_max_load (0)
+    , _report_xruns (0)
+{
+    reset_stats ();
+}
+
+void deadline_monitor::end_callback (std::size_t frames)
+{
+    const auto now = clock::now ();
+    bump (_callbacks);
+
+    const std::uint64_t rate = frame_rate ();
+    if (!rate || !frames)
+        return;
+
+    const std::uint64_t elapsed =
+        std::chrono::duration_cast<std::chrono::nanoseconds> (
+            now - _start).count ();
+    const std::uint64_t deadline = frames * UINT64_C (1000000000) / rate;
+    const std::uint64_t load = elapsed * load_scale / std::max<std::uint64_t> (
+        deadline, 1);
+
+    bump (_total_load, load);
+    if (load > _max_load.load (std::memory_order_relaxed))
+        _max_load.store (load, std::memory_order_relaxed);
+
+    const std::size_t late_bucket = deadline_stats::headroom_buckets - 1;
+    if (load >= load_scale)
+    {
+        bump (_late);
+        bump (_headroom [late_bucket]);
+    }
+    else
+        bump (_headroom [std::min<std::size_t> (
+                  (load_scale - load) * late_bucket / load_scale,
+                  late_bucket - 1)]);
+
+    const float threshold = log_threshold ();
+    if (threshold > 0 && load > threshold * load_scale)
+    {
+        _report_over.fetch_add (1, std::memory_order_relaxed);
+        if (load > _report_max_load.load (std::memory_order_relaxed))
+            _report_max_load.store (load, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * The maximum load may miss a callback ending while we take it, which
+ * is fine for a warning.
+ */
+void deadline_monitor::log_report ()
+{
+    const float threshold = log_threshold ();
+    const auto  now = clock::now ();
+    if (threshold <= 0 || now - _last_report < std::chrono::seconds (1))
+        return;
+
+    const std::uint64_t xruns = _xruns.load (std::memory_order_relaxed);
+    const std::uint64_t new_xruns = xruns >= _report_xruns ?
+        xruns - _report_xruns : xruns;
+    const std::uint64_t over =
+        _report_over.exchange (0, std::memory_order_relaxed);
+    const std::uint64_t max_load =
+        _report_max_load.exchange (0, std::memory_order_relaxed);
+
+    if (over)
+        PSYNTH_LOG << base::log::warning
+                   << over << " device callbacks took more than "
+                   << threshold * 100 << "% of their deadline, "
+                   << "up to " << max_load * 100.0 / load_scale
+                   << "%.";
+    if (new_xruns)
+        PSYNTH_LOG << base::log::warning
+                   << new_xruns << " new buffer underruns.";
+
+    _last_report  = now;
+    _report_xruns = xruns;
+}
+
+deadline_stats deadline_monitor::stats () const
+{
+    deadline_stats res;
+    res.callbacks  = _callbacks.load (std::memory_order_relaxed);
+    res.late       = _late.load (std::memory_order_relaxed);
+    res.xruns      = _xruns.load (std::memory_order_relaxed);
+    res.recoveries = _recoveries.load (std::memory_order_relaxed);
+    res.max_load   = float (_max_load.load (std::memory_order_relaxed)) /
+        load_scale;
+    res.mean_load  = res.callbacks ?
+        float (_total_load.load (std::memory_order_relaxed)) /
+        load_scale / res.callbacks : 0;
+
+    for (std::size_t i = 0; i < deadline_stats::headroom_buckets; ++i)
+        res.headroom [i] = _headroom [i].load (std::memory_order_relaxed);
+
+    return res;
+}
+
+void deadline_monitor::reset_stats ()
+{
+    _callbacks.store (0, std::memory_order_relaxed);
+    _late.store (0, std::memory_order_relaxed);
+    _xruns.store (0, std::memory_order_relaxed);
+    _recoveries.store (0, std::memory_order_relaxed);
+    _total_load.store (0, std::memory_order_relaxed);
+    _max_load.store (0, std::memory_order_relaxed);
+    for (auto& bucket : _headroom)
+        bucket.store (0, std::memory_order_relaxed);
+}
+
+} /* namespace io */
+} /* namespace psynth */
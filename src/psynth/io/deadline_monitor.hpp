@@ -0,0 +1,166 @@
+/**
+ *  Time-stamp:  <2011-07-10 18:21:07 raskolnikov>
+ *
+ *  @file        deadline_monitor.hpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sun Jul 10 16:02:33 2011
+ *
+ *  Timing of the callbacks of asynchronous devices.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_IO_DEADLINE_MONITOR_H_
+#define PSYNTH_IO_DEADLINE_MONITOR_H_
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include <psynth/base/util.hpp>
+
+namespace psynth
+{
+namespace io
+{
+
+/**
+ * Statistics of the callbacks of an asynchronous device. The load of
+ * a callback is the time it took relative to the duration of the
+ * frames it produced, which is the deadline for the next one.
+ */
+struct deadline_stats
+{
+    static constexpr std::size_t headroom_buckets = 11;
+
+    std::uint64_t callbacks;
+    /** Callbacks that took longer than their deadline. */
+    std::uint64_t late;
+    /** Underruns reported by the device. */
+    std::uint64_t xruns;
+    /** Underruns after which the device was restarted successfully. */
+    std::uint64_t recoveries;
+
+    float mean_load;
+    float max_load;
+
+    /**
+     * Element @c i counts the callbacks that left between <tt>i *
+     * 10%</tt> and <tt>(i + 1) * 10%</tt> of their deadline free. The
+     * last one counts the late callbacks.
+     */
+    std::array<std::uint64_t, headroom_buckets> headroom;
+};
+
+/**
+ * Measures the callbacks of a device. Only the device thread can
+ * time callbacks, but the xruns can be counted from any thread and
+ * the statistics read without locking.
+ *
+ * When the log threshold is set, the device thread counts the
+ * callbacks going over that load. Logging is not real-time safe, so
+ * it is left to some other thread calling log_report periodically.
+ */
+class deadline_monitor : private boost::noncopyable
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    deadline_monitor ();
+
+    /** The frame rate of the device, without it loads are not known. */
+    void set_frame_rate (std::size_t rate)
+    { _frame_rate.store (rate, std::memory_order_relaxed); }
+
+    std::size_t frame_rate () const
+    { return _frame_rate.load (std::memory_order_relaxed); }
+
+    /** Zero disables logging, which is the default. */
+    void set_log_threshold (float load)
+    { _log_threshold.store (load, std::memory_order_relaxed); }
+
+    float log_threshold () const
+    { return _log_threshold.load (std::memory_order_relaxed); }
+
+    void begin_callback ()
+    { _start = clock::now (); }
+
+    void end_callback (std::size_t frames);
+
+    void add_xrun ()
+    { _xruns.fetch_add (1, std::memory_order_relaxed); }
+
+    void add_recovery ()
+    { _recoveries.fetch_add (1, std::memory_order_relaxed); }
+
+    deadline_stats stats () const;
+
+    /**
+     * Logs a warning, at most once per second, if some callback went
+     * over the log threshold or there were new xruns since the last
+     * one. Not to be called from the device thread.
+     */
+    void log_report ();
+
+    /**
+     * Starts the statistics again. Callbacks ending meanwhile may be
+     * partially lost.
+     */
+    void reset_stats ();
+
+private:
+    /** Loads are kept in thousandths. */
+    static constexpr std::uint64_t load_scale = 1000;
+
+    template <typename T>
+    static void bump (std::atomic<T>& x, T delta = 1)
+    {
+        x.store (x.load (std::memory_order_relaxed) + delta,
+                 std::memory_order_relaxed);
+    }
+
+    std::atomic<std::size_t> _frame_rate;
+    std::atomic<float>       _log_threshold;
+
+    clock::time_point _start;
+
+    std::atomic<std::uint64_t> _callbacks;
+    std::atomic<std::uint64_t> _late;
+    std::atomic<std::uint64_t> _xruns;
+    std::atomic<std::uint64_t> _recoveries;
+    std::atomic<std::uint64_t> _total_load;
+    std::atomic<std::uint64_t> _max_load;
+    std::atomic<std::uint64_t> _headroom [deadline_stats::headroom_buckets];
+
+    // Published by the device thread for log_report
+    std::atomic<std::uint64_t> _report_over;
+    std::atomic<std::uint64_t> _report_max_load;
+
+    // Only used by the thread logging the reports
+    clock::time_point _last_report;
+    std::uint64_t     _report_xruns;
+};
+
+} /* namespace io */
+} /* namespace psynth */
+
+#endif /* PSYNTH_IO_DEADLINE_MONITOR_H_ */
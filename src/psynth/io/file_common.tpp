@@ -35,6 +35,7 @@
 #define PSYNTH_IO_FILE_COMMON_TPP_
 
 #include <boost/mpl/int.hpp>
+#include <boost/mpl/bool.hpp>
 
 #include <psynth/version.hpp>
 #include <psynth/sound/sample.hpp>
@@ -111,7 +112,7 @@ namespace io
 template <class Range>
 struct file_support
 {
-    typedef mpl::false_ is_supported;
+    typedef boost::mpl::false_ is_supported;
 };
 
 } /* namespace io */
@@ -92,10 +92,14 @@ jack_raw_output::jack_raw_output (const char* client,
     PSYNTH_JACK_CHECK (jack_set_sample_rate_callback (
                            _client, &jack_raw_output::_sample_rate_cb, this),
                        jack_param_error);
+    PSYNTH_JACK_CHECK (jack_set_xrun_callback (
+                           _client, &jack_raw_output::_xrun_cb, this),
+                       jack_param_error);
 
     jack_on_shutdown (_client, &jack_raw_output::_shutdown_cb, this);
 
     _actual_rate = jack_get_sample_rate (_client);
+    deadline ().set_frame_rate (_actual_rate);
     if (_actual_rate != rate)
         PSYNTH_LOG
             << base::log::warning
@@ -218,5 +222,11 @@ void jack_raw_output::_shutdown_cb (void* jack_client)
     static_cast<jack_raw_output*>(jack_client)->_on_shutdown ();
 }
 
+int jack_raw_output::_xrun_cb (void* jack_client)
+{
+    static_cast<jack_raw_output*>(jack_client)->_on_xrun ();
+    return 0;
+}
+
 } /* namespace io */
 } /* namespace psynth */
@@ -81,10 +81,18 @@ private:
 
     void _on_shutdown () { /* TODO */ }
 
+    /** Jack keeps running after an xrun. */
+    void _on_xrun ()
+    {
+        deadline ().add_xrun ();
+        deadline ().add_recovery ();
+    }
+
     static int _process_cb (jack_nframes_t nframes, void* jack_client);
     static int _sample_rate_cb (jack_nframes_t newrate, void* jack_client);
     static int _buffer_size_cb (jack_nframes_t newsize, void* jack_client);
     static void _shutdown_cb (void* jack_client);
+    static int _xrun_cb (void* jack_client);
 
     std::vector<jack_port_t*> _out_ports;
     jack_client_t*            _client;
@@ -36,6 +36,7 @@
 #include <sys/soundcard.h>
 #include <sys/stat.h>
 #include <sys/ioctl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <cstring>
 
@@ -64,6 +65,7 @@ oss_raw_output::oss_raw_output (const char* device,
     : thread_async (cb, true)
     , _frame_size (sample_size * channels)
     , _buffer_size (buffer_size)
+    , _started (false)
 {
 
 #define PSYNTH_OSS_CHECK(fun, except)                                   \
@@ -90,7 +92,12 @@ oss_raw_output::oss_raw_output (const char* device,
         throw oss_param_error ();
     };
 
-    int fragment = (2 << 16) | ((int) std::log2 (buffer_size));
+    // Two fragments of the biggest power of two that fits.
+    const std::size_t fragment_size = buffer_size;
+    int fragment_bits = 0;
+    while ((std::size_t (2) << fragment_bits) <= fragment_size)
+        ++fragment_bits;
+    int fragment = (2 << 16) | fragment_bits;
 
     if (!interleaved)
     {
@@ -112,6 +119,7 @@ oss_raw_output::oss_raw_output (const char* device,
                       oss_param_error);
     PSYNTH_OSS_CHECK (::ioctl (_handle, SNDCTL_DSP_SPEED,       &rate),
                       oss_param_error);
+    deadline ().set_frame_rate (rate);
 
     grd_handle.dismiss ();
 }
@@ -141,9 +149,35 @@ std::size_t oss_raw_output::put_n (const void* const* data, std::size_t frames)
     return 0;
 }
 
+void oss_raw_output::prepare ()
+{
+    _started = false;
+}
+
 void oss_raw_output::iterate ()
 {
+    // Wait for a free fragment here, so that the write does not block
+    // and the callback is timed properly.
+    ::pollfd fds = { _handle, POLLOUT, 0 };
+    if (::poll (&fds, 1, 1000) == -1)
+        PSYNTH_LOG << base::log::warning
+                   << "Error while waiting for OSS device: "
+                   << strerror (errno);
+
+    // OSS does not report underruns, but the device queue can only
+    // be empty after the first write if we were late. Playback
+    // continues by itself on the next write.
+    int delay = 0;
+    if (_started &&
+        ::ioctl (_handle, SNDCTL_DSP_GETODELAY, &delay) != -1 &&
+        delay == 0)
+    {
+        deadline ().add_xrun ();
+        deadline ().add_recovery ();
+    }
+
     process (_buffer_size);
+    _started = true;
 }
 
 } /* namespace io */
@@ -71,10 +71,12 @@ public:
 
 private:
     void iterate ();
+    void prepare ();
 
     int         _handle;
     std::size_t _frame_size;
     std::size_t _buffer_size;
+    bool        _started;
 };
 
 } /* namespace io */
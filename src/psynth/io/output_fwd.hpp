@@ -44,10 +44,48 @@ PSYNTH_DECLARE_SHARED_TEMPLATE(async_output, class);
 PSYNTH_DECLARE_SHARED_TEMPLATE(dummy_output, class);
 PSYNTH_DECLARE_SHARED_TEMPLATE(dummy_async_output, class);
 
-PSYNTH_DECLARE_SHARED_TEMPLATE(buffered_output, class, class);
-PSYNTH_DECLARE_SHARED_TEMPLATE(buffered_async_output, class, class);
-PSYNTH_DECLARE_SHARED_TEMPLATE(buffered_output_adapter, class, class);
-PSYNTH_DECLARE_SHARED_TEMPLATE(buffered_async_output_adapter, class, class);
+namespace detail
+{
+struct buffered_output_converter;
+} /* namespace detail */
+
+/**
+ * The buffered outputs take the frame converter as an optional last
+ * parameter, which the shared template macros can not default.
+ */
+#define PSYNTH_IO_DECLARE_BUFFERED_OUTPUT(type_name)                    \
+    template <class Range, class Output,                                \
+              class Converter = detail::buffered_output_converter>      \
+    struct type_name;                                                   \
+                                                                        \
+    template <class Range, class Output,                                \
+              class Converter = detail::buffered_output_converter>      \
+    struct type_name ## _ptr :                                          \
+        public std::shared_ptr<type_name<Range, Output, Converter> >    \
+    {                                                                   \
+        typedef std::shared_ptr<type_name<Range, Output, Converter> > base; \
+        template <typename... Args>                                     \
+            type_name ## _ptr (Args&&... args)                          \
+            : base (std::forward<Args> (args) ...) {}                   \
+        template <typename... Args>                                     \
+            type_name ## _ptr& operator= (Args&&... args)               \
+            { this->base::operator= (std::forward<Args> (args) ...); return *this; } \
+    };                                                                  \
+                                                                        \
+    template <class Range, class Output,                                \
+              class Converter = detail::buffered_output_converter,      \
+              typename... Args>                                         \
+    type_name ## _ptr<Range, Output, Converter>                         \
+    inline new_ ## type_name (Args&& ... args)                          \
+    {                                                                   \
+        return std::make_shared<type_name<Range, Output, Converter> > ( \
+            std::forward<Args> (args)...);                              \
+    }
+
+PSYNTH_IO_DECLARE_BUFFERED_OUTPUT(buffered_output);
+PSYNTH_IO_DECLARE_BUFFERED_OUTPUT(buffered_async_output);
+PSYNTH_IO_DECLARE_BUFFERED_OUTPUT(buffered_output_adapter);
+PSYNTH_IO_DECLARE_BUFFERED_OUTPUT(buffered_async_output_adapter);
 
 #ifdef PSYNTH_HAVE_ALSA
 PSYNTH_DECLARE_SHARED_TEMPLATE(alsa_output, class);
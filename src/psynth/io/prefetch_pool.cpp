@@ -0,0 +1,191 @@
+/**
+ *  Time-stamp:  <2011-07-14 12:31:11 raskolnikov>
+ *
+ *  @file        prefetch_pool.cpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Thu Jul 14 10:12:48 2011
+ *
+ *  Threads shared by the streams that read ahead from files.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <functional>
+#include "io/prefetch_pool.hpp"
+
+namespace psynth
+{
+
+template class base::singleton_holder<io::prefetch_pool_impl>;
+
+namespace io
+{
+
+constexpr std::size_t prefetch_pool_impl::default_num_threads;
+
+prefetch_pool_impl::prefetch_pool_impl (std::size_t num_threads)
+    : _num_threads (std::max<std::size_t> (num_threads, 1))
+    , _finished (false)
+{
+}
+
+prefetch_pool_impl::~prefetch_pool_impl ()
+{
+    std::unique_lock<std::mutex> lock (_mutex);
+    stop_threads (lock);
+}
+
+void prefetch_pool_impl::set_num_threads (std::size_t num_threads)
+{
+    std::unique_lock<std::mutex> lock (_mutex);
+    num_threads = std::max<std::size_t> (num_threads, 1);
+    if (num_threads != _num_threads)
+    {
+        const bool started = !_threads.empty ();
+        stop_threads (lock);
+        _num_threads = num_threads;
+        if (started)
+            start_threads ();
+    }
+}
+
+std::size_t prefetch_pool_impl::num_threads () const
+{
+    std::unique_lock<std::mutex> lock (_mutex);
+    return _num_threads;
+}
+
+std::size_t prefetch_pool_impl::pending () const
+{
+    std::unique_lock<std::mutex> lock (_mutex);
+    return _queue.size ();
+}
+
+void prefetch_pool_impl::request (prefetch_stream& stream,
+                                  clock::time_point deadline)
+{
+    std::unique_lock<std::mutex> lock (_mutex);
+
+    if (stream._running)
+    {
+        // Queued again when the current refill finishes.
+        stream._deadline = stream._again ?
+            std::min (stream._deadline, deadline) : deadline;
+        stream._again = true;
+    }
+    else if (stream._queued)
+    {
+        if (deadline < stream._deadline)
+        {
+            stream._deadline = deadline;
+            std::make_heap (_queue.begin (), _queue.end (), later ());
+        }
+    }
+    else
+    {
+        stream._deadline = deadline;
+        stream._queued   = true;
+        _queue.push_back (&stream);
+        std::push_heap (_queue.begin (), _queue.end (), later ());
+
+        if (_threads.empty ())
+            start_threads ();
+        _cond.notify_one ();
+    }
+}
+
+void prefetch_pool_impl::cancel (prefetch_stream& stream)
+{
+    std::unique_lock<std::mutex> lock (_mutex);
+
+    if (stream._queued)
+    {
+        _queue.erase (std::find (_queue.begin (), _queue.end (), &stream));
+        std::make_heap (_queue.begin (), _queue.end (), later ());
+        stream._queued = false;
+    }
+
+    stream._again = false;
+    while (stream._running)
+        _done_cond.wait (lock);
+    stream._again = false;
+}
+
+void prefetch_pool_impl::start_threads ()
+{
+    _finished = false;
+    for (std::size_t i = 0; i < _num_threads; ++i)
+        _threads.push_back (std::thread (
+                                std::bind (&prefetch_pool_impl::run, this)));
+}
+
+void prefetch_pool_impl::stop_threads (std::unique_lock<std::mutex>& lock)
+{
+    _finished = true;
+    _cond.notify_all ();
+
+    // The threads stay in the vector so requests meanwhile do not
+    // start new ones.
+    lock.unlock ();
+    for (auto& t : _threads)
+        t.join ();
+    lock.lock ();
+
+    _threads.clear ();
+    _finished = false;
+}
+
+void prefetch_pool_impl::run ()
+{
+    std::unique_lock<std::mutex> lock (_mutex);
+
+    while (true)
+    {
+        while (!_finished && _queue.empty ())
+            _cond.wait (lock);
+        if (_finished)
+            break;
+
+        std::pop_heap (_queue.begin (), _queue.end (), later ());
+        prefetch_stream& stream = *_queue.back ();
+        _queue.pop_back ();
+        stream._queued  = false;
+        stream._running = true;
+
+        lock.unlock ();
+        stream.prefetch ();
+        lock.lock ();
+
+        stream._running = false;
+        if (stream._again)
+        {
+            stream._again  = false;
+            stream._queued = true;
+            _queue.push_back (&stream);
+            std::push_heap (_queue.begin (), _queue.end (), later ());
+        }
+        _done_cond.notify_all ();
+    }
+}
+
+} /* namespace io */
+} /* namespace psynth */
@@ -0,0 +1,153 @@
+/**
+ *  Time-stamp:  <2011-07-14 12:31:05 raskolnikov>
+ *
+ *  @file        prefetch_pool.hpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Thu Jul 14 10:12:48 2011
+ *
+ *  Threads shared by the streams that read ahead from files.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_IO_PREFETCH_POOL_H_
+#define PSYNTH_IO_PREFETCH_POOL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <psynth/base/singleton.hpp>
+
+namespace psynth
+{
+namespace io
+{
+
+class prefetch_pool_impl;
+
+/**
+ * A stream whose buffer is refilled by a prefetch pool.
+ */
+class prefetch_stream : private boost::noncopyable
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    prefetch_stream ()
+        : _queued (false)
+        , _running (false)
+        , _again (false)
+    {}
+
+    virtual ~prefetch_stream () {}
+
+    /**
+     * Fills the buffer of the stream as much as it can. It is called
+     * from a pool thread and never for the same stream at once.
+     */
+    virtual void prefetch () = 0;
+
+private:
+    friend class prefetch_pool_impl;
+
+    clock::time_point _deadline;
+    bool _queued;
+    bool _running;
+    bool _again;
+};
+
+/**
+ * A few threads refilling any number of streams. Requests are served
+ * earliest deadline first, where the deadline is the time when the
+ * stream would run out of data.
+ */
+class prefetch_pool_impl : private boost::noncopyable
+{
+public:
+    typedef prefetch_stream::clock clock;
+
+    static constexpr std::size_t default_num_threads = 1;
+
+    prefetch_pool_impl (std::size_t num_threads = default_num_threads);
+    ~prefetch_pool_impl ();
+
+    /**
+     * Changes the number of threads, waiting for the refills in
+     * progress. Pending requests are kept.
+     */
+    void set_num_threads (std::size_t num_threads);
+
+    std::size_t num_threads () const;
+
+    /**
+     * Asks to refill @a stream before @a deadline. Several requests
+     * for the same stream are merged into one.
+     */
+    void request (prefetch_stream& stream, clock::time_point deadline);
+
+    /**
+     * Forgets the stream, waiting for its refill if one is in
+     * progress. It must be called before destroying a stream that
+     * made some request.
+     */
+    void cancel (prefetch_stream& stream);
+
+    /** Number of streams waiting for a refill. */
+    std::size_t pending () const;
+
+private:
+    struct later
+    {
+        bool operator () (const prefetch_stream* a,
+                          const prefetch_stream* b) const
+        { return a->_deadline > b->_deadline; }
+    };
+
+    void start_threads ();
+    void stop_threads (std::unique_lock<std::mutex>& lock);
+    void run ();
+
+    std::size_t                   _num_threads;
+    bool                          _finished;
+    std::vector<std::thread>      _threads;
+    std::vector<prefetch_stream*> _queue;
+
+    mutable std::mutex            _mutex;
+    std::condition_variable       _cond;
+    std::condition_variable       _done_cond;
+};
+
+typedef base::singleton_holder<prefetch_pool_impl> prefetch_pool;
+
+} /* namespace io */
+
+namespace base
+{
+
+extern template class singleton_holder<io::prefetch_pool_impl>;
+
+} /* namespace base */
+} /* namespace psynth */
+
+#endif /* PSYNTH_IO_PREFETCH_POOL_H_ */
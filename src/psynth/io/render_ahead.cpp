@@ -0,0 +1,111 @@
+/**
+ *  Time-stamp:  <2011-07-03 13:02:21 raskolnikov>
+ *
+ *  @file        render_ahead.cpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sun Jul  3 11:40:12 2011
+ *
+ *  Thread rendering audio ahead of an asynchronous device.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#define PSYNTH_MODULE_NAME "psynth.io.render_ahead"
+
+#include <chrono>
+#include <limits>
+
+#include "render_ahead.hpp"
+
+namespace psynth
+{
+namespace io
+{
+
+/*
+ * The device does not take the lock when waking us up, so a
+ * notification may be missed. This bounds how long that can delay
+ * the rendering.
+ */
+constexpr int render_ahead_sleep_ms = 1;
+
+constexpr std::size_t no_min_fill = std::numeric_limits<std::size_t>::max ();
+
+render_ahead::render_ahead (need_fn need, render_fn render, bool realtime)
+    : thread_async (callback_type (), realtime)
+    , _need (need)
+    , _render (render)
+    , _fill (0)
+    , _min_fill (no_min_fill)
+    , _late_blocks (0)
+{
+}
+
+render_ahead::~render_ahead ()
+{
+    // The base class would stop us after our members are gone.
+    soft_stop ();
+}
+
+void render_ahead::iterate ()
+{
+    if (_need ())
+        _render ();
+    else
+    {
+        std::unique_lock<std::mutex> lock (_mutex);
+        _cond.wait_for (lock, std::chrono::milliseconds (render_ahead_sleep_ms));
+    }
+}
+
+void render_ahead::consumed (std::size_t available, std::size_t nframes)
+{
+    _fill.store (available, std::memory_order_relaxed);
+
+    std::size_t min_fill = _min_fill.load (std::memory_order_relaxed);
+    while (available < min_fill &&
+           !_min_fill.compare_exchange_weak (min_fill, available,
+                                             std::memory_order_relaxed));
+
+    if (available < nframes)
+        _late_blocks.fetch_add (1, std::memory_order_relaxed);
+
+    _cond.notify_one ();
+}
+
+render_ahead_stats render_ahead::stats () const
+{
+    const std::size_t min_fill = _min_fill.load (std::memory_order_relaxed);
+    return render_ahead_stats {
+        _fill.load (std::memory_order_relaxed),
+        min_fill == no_min_fill ? 0 : min_fill,
+        _late_blocks.load (std::memory_order_relaxed)
+    };
+}
+
+void render_ahead::reset_stats ()
+{
+    _min_fill.store (no_min_fill, std::memory_order_relaxed);
+    _late_blocks.store (0, std::memory_order_relaxed);
+}
+
+} /* namespace io */
+} /* namespace psynth */
@@ -0,0 +1,104 @@
+/**
+ *  Time-stamp:  <2011-07-03 13:02:17 raskolnikov>
+ *
+ *  @file        render_ahead.hpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sun Jul  3 11:27:40 2011
+ *
+ *  Thread rendering audio ahead of an asynchronous device.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_IO_RENDER_AHEAD_H_
+#define PSYNTH_IO_RENDER_AHEAD_H_
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+#include <psynth/io/thread_async.hpp>
+
+namespace psynth
+{
+namespace io
+{
+
+/**
+ * Statistics of a render ahead thread, as seen by the device.
+ */
+struct render_ahead_stats
+{
+    /** Frames that were ready on the last device request. */
+    std::size_t fill;
+    /** Lowest number of ready frames since the last reset. */
+    std::size_t min_fill;
+    /** Device requests that could not be fully served in time. */
+    std::size_t late_blocks;
+};
+
+/**
+ * A thread that keeps rendering blocks into some buffer while it is
+ * below a watermark, so that the device callback only has to copy
+ * the frames out. Both the watermark test and the rendering are
+ * provided by the owner.
+ *
+ * The device should call @c consumed () after each request; that
+ * wakes the thread and updates the statistics without locking.
+ */
+class render_ahead : public thread_async
+{
+public:
+    typedef std::function<bool ()> need_fn;
+    typedef std::function<void ()> render_fn;
+
+    render_ahead (need_fn need, render_fn render, bool realtime = true);
+    ~render_ahead ();
+
+    /**
+     * Notifies that the device requested @a nframes when only @a
+     * available frames were ready.
+     */
+    void consumed (std::size_t available, std::size_t nframes);
+
+    render_ahead_stats stats () const;
+    void reset_stats ();
+
+protected:
+    void iterate ();
+
+private:
+    need_fn   _need;
+    render_fn _render;
+
+    std::atomic<std::size_t> _fill;
+    std::atomic<std::size_t> _min_fill;
+    std::atomic<std::size_t> _late_blocks;
+
+    std::mutex              _mutex;
+    std::condition_variable _cond;
+};
+
+} /* namespace io */
+} /* namespace psynth */
+
+#endif /* PSYNTH_IO_RENDER_AHEAD_H_ */
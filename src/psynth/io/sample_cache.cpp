@@ -0,0 +1,376 @@
+/**
+ *  Time-stamp:  <2011-07-12 20:14:42 raskolnikov>
+ *
+ *  @file        sample_cache.cpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Tue Jul 12 17:40:02 2011
+ *
+ *  Decoded audio files shared by all the samplers.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#define PSYNTH_MODULE_NAME "psynth.io.sample_cache"
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <sstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <boost/filesystem/operations.hpp>
+
+#include "version.hpp"
+#include "base/logger.hpp"
+#include "base/scope_guard.hpp"
+#include "sound/buffer.hpp"
+#include "io/sample_cache.hpp"
+#ifdef PSYNTH_HAVE_WAV
+#include "io/file_input.hpp"
+#endif
+
+namespace bf = boost::filesystem;
+
+namespace psynth
+{
+
+template class base::singleton_holder<io::sample_cache_impl>;
+
+namespace io
+{
+
+namespace
+{
+
+/**
+ * Layout of the cache files: this header, the path of the original
+ * file, padding up to @c spill_align and then the left and right
+ * planes.
+ */
+struct spill_header
+{
+    char          magic [8];
+    std::uint64_t mtime;
+    std::uint64_t file_size;
+    std::uint64_t frame_rate;
+    std::uint64_t length;
+    std::uint64_t path_size;
+};
+
+const char        spill_magic [8] = { 'P', 'S', 'Y', 'S', 'M', 'P', 'L', '1' };
+const std::size_t spill_align     = 16;
+
+std::size_t spill_offset (std::size_t path_size)
+{
+    const std::size_t size = sizeof (spill_header) + path_size;
+    return (size + spill_align - 1) / spill_align * spill_align;
+}
+
+bf::path spill_file (const bf::path& dir, const std::string& path)
+{
+    std::ostringstream name;
+    name << std::hex << std::hash<std::string> () (path) << ".pcm";
+    return dir / name.str ();
+}
+
+bool write_all (int fd, const void* data, std::size_t size)
+{
+    const char* ptr = static_cast<const char*> (data);
+    while (size)
+    {
+        ssize_t res = ::write (fd, ptr, size);
+        if (res < 0)
+            return false;
+        ptr  += res;
+        size -= res;
+    }
+    return true;
+}
+
+} /* anonymous namespace */
+
+sample_data::sample_data (std::size_t frame_rate, const const_range& frames)
+    : _frame_rate (frame_rate)
+    , _length (frames.size ())
+    , _frames (std::max<std::size_t> (frames.size () * 2, 2))
+    , _map (0)
+    , _map_size (0)
+{
+    _left  = reinterpret_cast<const sound::bits32sf*> (&_frames [0]);
+    _right = _left + _length;
+    sound::copy_frames (frames, sound::planar_stereo_range (
+                            _length,
+                            const_cast<sound::bits32sf*> (_left),
+                            const_cast<sound::bits32sf*> (_right)));
+}
+
+sample_data::sample_data (std::size_t frame_rate, std::size_t length,
+                          std::vector<float>&& frames)
+    : _frame_rate (frame_rate)
+    , _length (length)
+    , _frames (std::move (frames))
+    , _map (0)
+    , _map_size (0)
+{
+    assert (_frames.size () >= length * 2);
+    _left  = reinterpret_cast<const sound::bits32sf*> (&_frames [0]);
+    _right = _left + _length;
+}
+
+sample_data::sample_data (std::size_t frame_rate, std::size_t length,
+                          void* map, std::size_t map_size,
+                          std::size_t offset)
+    : _frame_rate (frame_rate)
+    , _length (length)
+    , _map (map)
+    , _map_size (map_size)
+{
+    _left  = reinterpret_cast<const sound::bits32sf*> (
+        static_cast<const char*> (map) + offset);
+    _right = _left + _length;
+}
+
+sample_data::~sample_data ()
+{
+    if (_map)
+        ::munmap (_map, _map_size);
+}
+
+void sample_cache_impl::set_disk_path (const bf::path& path)
+{
+    std::unique_lock<std::mutex> lock (_mutex);
+    _disk_path = path;
+}
+
+bf::path sample_cache_impl::disk_path () const
+{
+    std::unique_lock<std::mutex> lock (_mutex);
+    return _disk_path;
+}
+
+std::size_t sample_cache_impl::size () const
+{
+    std::unique_lock<std::mutex> lock (_mutex);
+    std::size_t count = 0;
+    for (auto& e : _entries)
+        if (!e.second.data.expired ())
+            ++ count;
+    return count;
+}
+
+sample_data_ptr sample_cache_impl::get (const std::string& path)
+{
+    boost::system::error_code err;
+    entry key;
+    key.mtime = bf::last_write_time (path, err);
+    if (!err)
+        key.file_size = bf::file_size (path, err);
+    if (err)
+        throw file_open_error ("Can not access audio file: " + path);
+
+    bf::path disk_dir;
+    {
+        std::unique_lock<std::mutex> lock (_mutex);
+        auto it = _entries.find (path);
+        if (it != _entries.end () &&
+            it->second.mtime == key.mtime &&
+            it->second.file_size == key.file_size)
+            if (auto data = it->second.data.lock ())
+                return data;
+        disk_dir = _disk_path;
+    }
+
+    /*
+     * Loading happens without the lock, so two threads asking for
+     * the same new file at the same time may both decode it. We keep
+     * whatever got first into the table.
+     */
+    sample_data_ptr data;
+    if (!disk_dir.empty ())
+    {
+        const bf::path spill = spill_file (disk_dir, path);
+        data = load_spill (spill, path, key);
+        if (!data)
+        {
+            data = decode (path);
+            if (auto mapped = save_spill (spill, path, key, *data))
+                data = mapped;
+        }
+    }
+    else
+        data = decode (path);
+
+    std::unique_lock<std::mutex> lock (_mutex);
+    entry& e = _entries [path];
+    if (e.mtime == key.mtime && e.file_size == key.file_size)
+        if (auto other = e.data.lock ())
+            return other;
+    e.mtime     = key.mtime;
+    e.file_size = key.file_size;
+    e.data      = data;
+    return data;
+}
+
+sample_data_ptr sample_cache_impl::decode (const std::string& path)
+{
+#ifdef PSYNTH_HAVE_WAV
+    const std::size_t chunk_size = 4096;
+
+    file_input<sound::stereo32sf_range> in (path);
+    sound::stereo32sf_buffer chunk (chunk_size);
+
+    std::size_t capacity = in.length ();
+    std::size_t length   = 0;
+    std::vector<float> left (capacity);
+    std::vector<float> right (capacity);
+
+    std::size_t nread;
+    while ((nread = in.take (sound::range (chunk))) > 0)
+    {
+        if (length + nread > capacity)
+        {
+            capacity = std::max (capacity * 2, length + nread);
+            left.resize (capacity);
+            right.resize (capacity);
+        }
+
+        sound::copy_frames (
+            sound::sub_range (sound::const_range (chunk), 0, nread),
+            sound::planar_stereo_range (
+                nread,
+                reinterpret_cast<sound::bits32sf*> (&left [length]),
+                reinterpret_cast<sound::bits32sf*> (&right [length])));
+        length += nread;
+    }
+
+    // Both planes go in the same block, left first.
+    left.resize (length);
+    left.insert (left.end (), right.begin (), right.begin () + length);
+    if (left.empty ())
+        left.resize (2);
+
+    return sample_data_ptr (
+        new sample_data (in.frame_rate (), length, std::move (left)));
+#else
+    throw file_open_error ("Built without audio file support.");
+#endif
+}
+
+sample_data_ptr sample_cache_impl::load_spill (const bf::path& spill,
+                                               const std::string& path,
+                                               const entry& key)
+{
+    const int fd = ::open (spill.string ().c_str (), O_RDONLY);
+    if (fd < 0)
+        return sample_data_ptr ();
+    PSYNTH_ON_BLOCK_EXIT ([&] { ::close (fd); });
+
+    struct stat st;
+    if (::fstat (fd, &st) < 0 || std::size_t (st.st_size) < sizeof (spill_header))
+        return sample_data_ptr ();
+
+    const std::size_t map_size = st.st_size;
+    void* map = ::mmap (0, map_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED)
+        return sample_data_ptr ();
+    auto map_grd = base::make_guard ([&] { ::munmap (map, map_size); });
+
+    spill_header header;
+    std::memcpy (&header, map, sizeof (header));
+
+    const std::size_t offset = spill_offset (header.path_size);
+    const bool valid =
+        std::memcmp (header.magic, spill_magic, sizeof (spill_magic)) == 0 &&
+        header.mtime == std::uint64_t (key.mtime) &&
+        header.file_size == key.file_size &&
+        header.path_size == path.size () &&
+        map_size == offset + header.length * 2 * sizeof (float) &&
+        std::memcmp (static_cast<const char*> (map) + sizeof (header),
+                     path.data (), path.size ()) == 0;
+    if (!valid)
+        return sample_data_ptr ();
+
+    map_grd.dismiss ();
+    return sample_data_ptr (
+        new sample_data (header.frame_rate, header.length,
+                         map, map_size, offset));
+}
+
+sample_data_ptr sample_cache_impl::save_spill (const bf::path& spill,
+                                               const std::string& path,
+                                               const entry& key,
+                                               const sample_data& data)
+{
+    boost::system::error_code err;
+    bf::create_directories (spill.parent_path (), err);
+
+    // Written aside and renamed so readers never see half a file.
+    std::ostringstream tmp_name;
+    tmp_name << spill.string () << ".tmp" << ::getpid ();
+    const std::string tmp = tmp_name.str ();
+
+    spill_header header;
+    std::memcpy (header.magic, spill_magic, sizeof (spill_magic));
+    header.mtime      = key.mtime;
+    header.file_size  = key.file_size;
+    header.frame_rate = data.frame_rate ();
+    header.length     = data.length ();
+    header.path_size  = path.size ();
+
+    const std::size_t padding =
+        spill_offset (path.size ()) - sizeof (header) - path.size ();
+    const char zeros [spill_align] = { 0 };
+    const std::size_t plane_size = data.length () * sizeof (float);
+
+    bool ok = false;
+    const int fd = ::open (tmp.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd >= 0)
+    {
+        ok = write_all (fd, &header, sizeof (header)) &&
+            write_all (fd, path.data (), path.size ()) &&
+            write_all (fd, zeros, padding) &&
+            (!plane_size ||
+             (write_all (fd, data._left, plane_size) &&
+              write_all (fd, data._right, plane_size)));
+        ok = ::close (fd) == 0 && ok;
+    }
+
+    if (ok)
+        ok = ::rename (tmp.c_str (), spill.string ().c_str ()) == 0;
+
+    if (!ok)
+    {
+        PSYNTH_LOG << base::log::warning
+                   << "Could not write the sample cache file: "
+                   << spill.string ();
+        ::unlink (tmp.c_str ());
+        return sample_data_ptr ();
+    }
+
+    return load_spill (spill, path, key);
+}
+
+} /* namespace io */
+} /* namespace psynth */
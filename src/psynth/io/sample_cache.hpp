@@ -0,0 +1,262 @@
+/**
+ *  Time-stamp:  <2011-07-12 20:14:37 raskolnikov>
+ *
+ *  @file        sample_cache.hpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Tue Jul 12 17:40:02 2011
+ *
+ *  Decoded audio files shared by all the samplers.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_IO_SAMPLE_CACHE_H_
+#define PSYNTH_IO_SAMPLE_CACHE_H_
+
+#include <ctime>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+#include <psynth/base/singleton.hpp>
+#include <psynth/sound/typedefs.hpp>
+#include <psynth/sound/buffer_range_factory.hpp>
+#include <psynth/sound/algorithm.hpp>
+#include <psynth/io/file_common.hpp>
+
+namespace psynth
+{
+namespace io
+{
+
+/**
+ * A fully decoded audio file. It is never modified after being
+ * loaded, so any number of threads can read it at the same time. The
+ * frames are either owned or mapped from the disk cache.
+ */
+class sample_data : private boost::noncopyable
+{
+public:
+    typedef sound::stereo32sfc_planar_range const_range;
+
+    /** Copies the frames. */
+    sample_data (std::size_t frame_rate, const const_range& frames);
+
+    ~sample_data ();
+
+    const_range range () const
+    { return sound::planar_stereo_range (_length, _left, _right); }
+
+    std::size_t frame_rate () const
+    { return _frame_rate; }
+
+    std::size_t length () const
+    { return _length; }
+
+    /** Whether the frames live in a memory-mapped cache file. */
+    bool is_mapped () const
+    { return _map != 0; }
+
+private:
+    friend class sample_cache_impl;
+
+    sample_data (std::size_t frame_rate, std::size_t length,
+                 std::vector<float>&& frames);
+    sample_data (std::size_t frame_rate, std::size_t length,
+                 void* map, std::size_t map_size, std::size_t offset);
+
+    std::size_t         _frame_rate;
+    std::size_t         _length;
+    std::vector<float>  _frames;
+    void*               _map;
+    std::size_t         _map_size;
+    const sound::bits32sf* _left;
+    const sound::bits32sf* _right;
+};
+
+typedef std::shared_ptr<const sample_data> sample_data_ptr;
+
+/**
+ * Decodes each audio file only once for the whole process. Files are
+ * identified by their path and modification time and their data
+ * lives as long as someone is using it.
+ *
+ * When a disk path is set, decoded files are also stored there and
+ * later mapped into memory instead of decoding them again, even
+ * across runs.
+ */
+class sample_cache_impl : private boost::noncopyable
+{
+public:
+    /**
+     * Returns the decoded contents of the file.
+     * @throw file_error When it can not be read.
+     */
+    sample_data_ptr get (const std::string& path);
+
+    /** An empty path, the default, disables the disk cache. */
+    void set_disk_path (const boost::filesystem::path& path);
+
+    boost::filesystem::path disk_path () const;
+
+    /** Number of files currently loaded. */
+    std::size_t size () const;
+
+private:
+    struct entry
+    {
+        std::time_t                      mtime;
+        std::uintmax_t                   file_size;
+        std::weak_ptr<const sample_data> data;
+    };
+
+    sample_data_ptr decode (const std::string& path);
+    sample_data_ptr load_spill (const boost::filesystem::path& spill,
+                                const std::string& path,
+                                const entry& key);
+    sample_data_ptr save_spill (const boost::filesystem::path& spill,
+                                const std::string& path,
+                                const entry& key,
+                                const sample_data& data);
+
+    mutable std::mutex              _mutex;
+    std::map<std::string, entry>    _entries;
+    boost::filesystem::path         _disk_path;
+};
+
+typedef base::singleton_holder<sample_cache_impl> sample_cache;
+
+/**
+ * Playback position in a shared sample. It loops over the sample,
+ * forwards or backwards, reading straight from the shared frames.
+ */
+class sample_cursor
+{
+public:
+    sample_cursor ()
+        : _pos (0)
+        , _backwards (false)
+    {}
+
+    const sample_data_ptr& data () const
+    { return _data; }
+
+    /**
+     * Exchanges the sample with @a data, such that the old one can be
+     * released later outside of any lock. Starts from the beginning.
+     */
+    void swap_data (sample_data_ptr& data)
+    {
+        _data.swap (data);
+        _pos = 0;
+    }
+
+    bool empty () const
+    { return !_data || !_data->length (); }
+
+    std::size_t frame_rate () const
+    { return _data ? _data->frame_rate () : 0; }
+
+    bool is_backwards () const
+    { return _backwards; }
+
+    void set_backwards (bool backwards)
+    { _backwards = backwards; }
+
+    std::size_t position () const
+    { return _pos; }
+
+    /**
+     * When reading backwards the next frame is the one before @a
+     * pos, so seeking to zero starts from the end.
+     */
+    void seek (std::size_t pos)
+    { _pos = pos; }
+
+    /**
+     * Fills @a dst with the next frames, looping at the ends of the
+     * sample. Returns the number of frames written, which is zero
+     * only if the sample is empty.
+     */
+    template <class Range>
+    std::size_t take (const Range& dst);
+
+private:
+    sample_data_ptr _data;
+    std::size_t     _pos;
+    bool            _backwards;
+};
+
+template <class Range>
+std::size_t sample_cursor::take (const Range& dst)
+{
+    if (empty ())
+        return 0;
+
+    const auto src = _data->range ();
+    const std::size_t length = src.size ();
+    const std::size_t size = dst.size ();
+    std::size_t done = 0;
+
+    while (done < size)
+    {
+        std::size_t count;
+        if (!_backwards)
+        {
+            if (_pos >= length)
+                _pos = 0;
+            count = std::min (size - done, length - _pos);
+            sound::copy_and_convert_frames (
+                sound::sub_range (src, _pos, count),
+                sound::sub_range (dst, done, count));
+            _pos += count;
+        }
+        else
+        {
+            if (_pos == 0 || _pos > length)
+                _pos = length;
+            count = std::min (size - done, _pos);
+            sound::copy_and_convert_frames (
+                sound::flipped_range (
+                    sound::sub_range (src, _pos - count, count)),
+                sound::sub_range (dst, done, count));
+            _pos -= count;
+        }
+        done += count;
+    }
+
+    return done;
+}
+
+} /* namespace io */
+
+namespace base
+{
+
+extern template class singleton_holder<io::sample_cache_impl>;
+
+} /* namespace base */
+} /* namespace psynth */
+
+#endif /* PSYNTH_IO_SAMPLE_CACHE_H_ */
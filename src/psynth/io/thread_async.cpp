@@ -46,8 +46,9 @@ namespace io
 void thread_async::start ()
 {
     check_idle ();
-    _thread = std::thread (std::bind (&thread_async::run, this));
+    // Set the state first, otherwise run () may see us idle and quit.
     set_state (async_state::running);
+    _thread = std::thread (std::bind (&thread_async::run, this));
 }
 
 void thread_async::stop ()
@@ -70,7 +71,8 @@ void thread_async::run ()
 void thread_async::_request_rt ()
 {
 #if __GTHREADS
-    auto hdl = _thread.native_handle ();
+    // Called from the thread itself, _thread might not be assigned yet.
+    auto hdl = pthread_self ();
     sched_param p;
     p.sched_priority = 1;
     auto ret = pthread_setschedparam (hdl, SCHED_FIFO, &p);
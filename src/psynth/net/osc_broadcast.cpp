@@ -90,4 +90,12 @@ void osc_broadcast::broadcast_message_from (const char* path, lo_message msg, lo
     }
 }
 
+void osc_broadcast::send_message (lo_address dest, const char* path, lo_message msg)
+{
+    if (m_sender)
+	lo_send_message_from(dest, m_sender, path, msg);
+    else
+	lo_send_message(dest, path, msg);
+}
+
 } /* namespace psynth */
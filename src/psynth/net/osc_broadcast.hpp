@@ -91,6 +91,8 @@ public:
     void broadcast_message (const char* path, lo_message msg);
 
     void broadcast_message_from (const char* path, lo_message msg, lo_address from);
+
+    void send_message (lo_address dest, const char* path, lo_message msg);
 };
 
 } /* namespace psynth */
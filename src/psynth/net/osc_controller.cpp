@@ -173,6 +173,7 @@ void osc_controller::add_methods (lo_server s)
     lo_server_add_method (s, PSYNTH_OSC_MSG_PARAM, NULL, &param_cb, this);
     lo_server_add_method (s, PSYNTH_OSC_MSG_ACTIVATE, "ii", &activate_cb, this);
     lo_server_add_method (s, PSYNTH_OSC_MSG_DEACTIVATE, "ii", &deactivate_cb, this);
+    lo_server_add_method (s, PSYNTH_OSC_MSG_STATS, "", &stats_cb, this);
 }
 
 int osc_controller::_add_cb(const char* path, const char* types,
@@ -407,4 +408,34 @@ int osc_controller::_deactivate_cb(const char* path, const char* types,
     return 0;
 }
 
+/*
+ * Replies with one message per node: its network id, or -1 -1 for
+ * the nodes that are not shared, its name and the number of blocks
+ * and mean, 99th percentile and maximum nanoseconds per block.
+ */
+int osc_controller::_stats_cb(const char* path, const char* types,
+                              lo_arg** argv, int argc, lo_message msg)
+{
+    if (!m_restricted || is_target(lo_message_get_source(msg))) {
+	for (auto& node : m_world->get_dsp_stats ()) {
+	    map<int, pair<int,int> >::iterator it = m_net_id.find(node.id);
+	    pair<int,int> net_id = it != m_net_id.end() ?
+		it->second : make_pair(-1, -1);
+
+	    lo_message newmsg = lo_message_new();
+	    lo_message_add_int32(newmsg, net_id.first);
+	    lo_message_add_int32(newmsg, net_id.second);
+	    lo_message_add_string(newmsg, node.name.c_str());
+	    lo_message_add_int64(newmsg, node.stats.blocks);
+	    lo_message_add_int64(newmsg, node.stats.mean_ns);
+	    lo_message_add_int64(newmsg, node.stats.p99_ns);
+	    lo_message_add_int64(newmsg, node.stats.max_ns);
+	    send_message(lo_message_get_source(msg), PSYNTH_OSC_MSG_STATS, newmsg);
+	    lo_message_free(newmsg);
+	}
+    }
+
+    return 0;
+}
+
 } /* namespace psynth */
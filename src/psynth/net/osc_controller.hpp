@@ -50,6 +50,7 @@ class osc_controller : public world_listener,
     LO_HANDLER (osc_controller, param);
     LO_HANDLER (osc_controller, activate);
     LO_HANDLER (osc_controller, deactivate);
+    LO_HANDLER (osc_controller, stats);
 
     void add_to_world (world* world) {
 	world->add_world_listener (this);
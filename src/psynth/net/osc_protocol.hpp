@@ -38,4 +38,7 @@
 #define PSYNTH_OSC_MSG_ADD         "/ps/add"
 #define PSYNTH_OSC_MSG_DELETE      "/ps/delete"
 
+/* Monitoring. */
+#define PSYNTH_OSC_MSG_STATS       "/ps/stats"
+
 #endif /* PSYNTH_OSCPROTOCOL_H */
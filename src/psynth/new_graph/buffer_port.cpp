@@ -28,6 +28,7 @@
  *
  */
 
+#include "node.hpp"
 #include "buffer_port.hpp"
 
 namespace psynth
@@ -35,6 +36,13 @@ namespace psynth
 namespace graph
 {
 
+sound::buffer_arena_ptr port_buffer_arena (const port_base& port)
+{
+    if (port._has_owner () && port.owner ().is_attached_to_process ())
+        return port.owner ().process ().buffer_arena ();
+    return sound::buffer_arena_ptr ();
+}
+
 template class buffer_out_port<audio_buffer>;
 template class buffer_in_port<audio_buffer>;
 template class defaulting_buffer_in_port<audio_buffer>;
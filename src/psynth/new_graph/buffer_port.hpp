@@ -41,6 +41,28 @@ namespace psynth
 namespace graph
 {
 
+/**
+ * Arena for the buffers of @a port, the one of the processor of its
+ * owner, or none when it is not attached to any. Only to be used out
+ * of the audio thread.
+ */
+sound::buffer_arena_ptr port_buffer_arena (const port_base& port);
+
+/**
+ * Resizes @a buf to @a size frames. When @a next was prepared with
+ * that size it is swapped in instead, even if @a buf already has it,
+ * so the buffers move to the new arena. Then nothing is allocated nor
+ * freed, and @a next keeps the old memory until it is prepared again.
+ */
+template <typename T>
+void rt_resize_buffer (T& buf, T& next, std::size_t size)
+{
+    if (std::size_t (next.size ()) == size)
+        buf.swap (next);
+    else if (std::size_t (buf.size ()) != size)
+        buf.recreate (size);
+}
+
 template <typename T>
 class buffer_out_port : public out_port<T>
 {
@@ -54,8 +76,14 @@ public:
     virtual typename T::range rt_out_range ()
     { return range (this->rt_get_out ()); }
 
+    void prepare_context_update (std::size_t block_size, std::size_t)
+    { _next.recreate (block_size, 0, port_buffer_arena (*this)); }
+
     void rt_context_update (rt_process_context& ctx)
-    { this->rt_get_out ().recreate (ctx.block_size ()); }
+    { rt_resize_buffer (this->rt_get_out (), _next, ctx.block_size ()); }
+
+private:
+    T _next;
 };
 
 template <typename T>
@@ -90,14 +118,26 @@ public:
         , _default_value (defval)
     {}
 
+    void prepare_context_update (std::size_t block_size,
+                                 std::size_t frame_rate)
+    {
+        base_type::prepare_context_update (block_size, frame_rate);
+        _next_default.recreate (block_size, _default_value, 0,
+                                port_buffer_arena (*this));
+    }
+
     void rt_context_update (rt_process_context& ctx)
     {
         base_type::rt_context_update (ctx);
-        _default.recreate (ctx.block_size (), _default_value, 0);
+        if (std::size_t (_next_default.size ()) == ctx.block_size ())
+            rt_resize_buffer (_default, _next_default, ctx.block_size ());
+        else if (std::size_t (_default.size ()) != ctx.block_size ())
+            _default.recreate (ctx.block_size (), _default_value, 0);
     }
 
 private:
     T _default;
+    T _next_default;
     typename T::value_type _default_value;
 };
 
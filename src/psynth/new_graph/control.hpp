@@ -31,7 +31,9 @@
 #ifndef PSYNTH_GRAPH_CONTROL_HPP_
 #define PSYNTH_GRAPH_CONTROL_HPP_
 
+#include <array>
 #include <atomic>
+#include <initializer_list>
 #include <map>
 #include <mutex>
 
@@ -98,6 +100,9 @@ protected:
 class in_control_base : public control_base
 {
 public:
+    /** Returned by rt_next_change when there are no changes left. */
+    static constexpr std::size_t no_change = std::size_t (-1);
+
     virtual void str (const std::string& s) = 0;
 
     template <typename T>
@@ -106,8 +111,25 @@ public:
     template <typename T>
     const T& rt_get () const;
 
+    /**
+     * Sets the value. When the node is being processed the change
+     * takes effect at frame @a offset of the next block, or later
+     * blocks when it is bigger than the block size.
+     */
     template <typename T>
-    void set (const T&);
+    void set (const T&, std::size_t offset = 0);
+
+    /**
+     * Offset in the current block of the next timestamped change
+     * that has not been applied yet, or no_change.
+     */
+    virtual std::size_t rt_next_change () const = 0;
+
+    /**
+     * Applies the timestamped changes up to frame @a offset of the
+     * current block.
+     */
+    virtual void rt_apply_changes (std::size_t offset) = 0;
 
 protected:
     in_control_base (const std::string& name, node* owner);
@@ -163,7 +185,10 @@ class typed_in_control_base : public in_control_base
 public:
     virtual const T& get () const = 0;
     virtual const T& rt_get () const = 0;
-    virtual void set (const T&) = 0;
+    virtual void set (const T&, std::size_t offset) = 0;
+
+    void set (const T& val)
+    { set (val, 0); }
 
     void str (const std::string& s)
     { set (boost::lexical_cast<T> (s)); }
@@ -268,16 +293,27 @@ public:
 /**
  *  A control for sending parameter values from the user thread to the
  *  node internal state.
+ *
+ *  Values set with an offset are kept until the node reaches that
+ *  frame. Nodes that care about timing split their processing with
+ *  rt_split_block, the rest see the change in the block after.
  */
 template <typename T>
 class in_control : public typed_in_control_base<T>
 {
 public:
+    /**
+     * Maximum number of pending timestamped changes. When there are
+     * more the earliest one is applied right away.
+     */
+    static const std::size_t max_changes = 16;
+
     in_control (const std::string& name, node* owner=0, const T& value=T())
         : typed_in_control_base<T> (name, owner)
         , _value (value)
         , _rt_value (value)
         , _is_updated (false)
+        , _rt_num_changes (0)
     {}
 
     const control_meta& meta () const
@@ -289,20 +325,41 @@ public:
     const T& rt_get () const
     { return _rt_value; }
 
-    void set (const T&);
+    void set (const T& val)
+    { set (val, 0); }
+
+    void set (const T&, std::size_t offset);
 
     bool rt_is_updated ()
     { return _is_updated; }
 
+    std::size_t rt_next_change () const
+    {
+        return _rt_num_changes ?
+            _rt_changes [0].offset : in_control_base::no_change;
+    }
+
+    void rt_apply_changes (std::size_t offset);
+
 private:
+    struct rt_change
+    {
+        std::size_t offset;
+        T           value;
+    };
+
+    void rt_schedule (std::size_t offset, T& val);
+    bool rt_end_block (std::size_t block_size);
+
     struct rt_update_event : public rt_event
     {
-        rt_update_event (in_control& ctl, const T& val)
-            : _ctl (ctl), _new_rt_value (val) {}
+        rt_update_event (in_control& ctl, const T& val, std::size_t offset)
+            : _ctl (ctl), _new_rt_value (val), _offset (offset) {}
         void operator () (rt_process_context& ctx);
     private:
         in_control& _ctl;
         T _new_rt_value;
+        std::size_t _offset;
     };
 
     struct rt_post_update_event : public rt_event
@@ -320,8 +377,30 @@ private:
     T _value;
     T _rt_value;
     bool _is_updated;
+
+    std::array<rt_change, max_changes> _rt_changes;
+    std::size_t _rt_num_changes;
 };
 
+
+/**
+ *  Calls <tt>fn (start, size)</tt> for every piece of a block of @a
+ *  frames between the timestamped changes of @a controls, applying
+ *  the changes that happen at @a start first. The controls are
+ *  pointers, or smart pointers, to in_control_base.
+ */
+template <class Range, class Fn>
+void rt_split_block (std::size_t frames, const Range& controls, Fn fn);
+
+template <class Fn>
+void rt_split_block (std::size_t frames,
+                     std::initializer_list<in_control_base*> controls,
+                     Fn fn)
+{
+    rt_split_block<std::initializer_list<in_control_base*>, Fn> (
+        frames, controls, fn);
+}
+
 extern template class in_control<std::string>;
 extern template class in_control<float>;
 extern template class in_control<int>;
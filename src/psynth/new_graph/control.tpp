@@ -31,6 +31,8 @@
 #ifndef PSYNTH_GRAPH_CONTROL_TPP_
 #define PSYNTH_GRAPH_CONTROL_TPP_
 
+#include <algorithm>
+
 #include <boost/cast.hpp>
 #include <psynth/new_graph/node_fwd.hpp>
 #include <psynth/new_graph/control.hpp>
@@ -76,12 +78,12 @@ const T& out_control_base::rt_get () const
 }
 
 template <typename T>
-void in_control_base::set (const T& val)
+void in_control_base::set (const T& val, std::size_t offset)
 {
     if (type () != base::type_value (typeid (T)))
         throw control_type_error ();
     boost::polymorphic_downcast<
-        typed_in_control_base<T>*>(this)->set (val);
+        typed_in_control_base<T>*>(this)->set (val, offset);
 }
 
 template <typename T>
@@ -122,7 +124,7 @@ void out_control_impl<T, false>::async_update_event::operator () (
 
 
 template <typename T>
-void in_control<T>::set (const T& val)
+void in_control<T>::set (const T& val, std::size_t offset)
 {
     _value  = val;
     if (this->_has_owner () &&
@@ -130,7 +132,7 @@ void in_control<T>::set (const T& val)
         this->owner ().process ().is_running ())
     {
         user_process_context& ctx = this->owner ().process ().context ();
-        ctx.push_rt_event<rt_update_event> (*this, val);
+        ctx.push_rt_event<rt_update_event> (*this, val, offset);
     }
     else
     {
@@ -138,10 +140,57 @@ void in_control<T>::set (const T& val)
     }
 }
 
+template <typename T>
+void in_control<T>::rt_schedule (std::size_t offset, T& val)
+{
+    if (_rt_num_changes == max_changes)
+        rt_apply_changes (_rt_changes [0].offset);
+
+    std::size_t i = _rt_num_changes ++;
+    for (; i > 0 && _rt_changes [i - 1].offset > offset; --i)
+        _rt_changes [i] = std::move (_rt_changes [i - 1]);
+
+    _rt_changes [i].offset = offset;
+    std::swap (_rt_changes [i].value, val);
+}
+
+template <typename T>
+void in_control<T>::rt_apply_changes (std::size_t offset)
+{
+    std::size_t n = 0;
+    while (n < _rt_num_changes && _rt_changes [n].offset <= offset)
+        std::swap (_rt_value, _rt_changes [n++].value);
+
+    if (n > 0)
+    {
+        std::move (_rt_changes.begin () + n,
+                   _rt_changes.begin () + _rt_num_changes,
+                   _rt_changes.begin ());
+        _rt_num_changes -= n;
+    }
+}
+
+/**
+ * Applies what is left of this block and moves the rest of the
+ * changes to the next one. Returns whether there are any.
+ */
+template <typename T>
+bool in_control<T>::rt_end_block (std::size_t block_size)
+{
+    rt_apply_changes (block_size - 1);
+    for (std::size_t i = 0; i < _rt_num_changes; ++i)
+        _rt_changes [i].offset -= block_size;
+    return _rt_num_changes > 0;
+}
+
 template <typename T>
 void in_control<T>::rt_update_event::operator () (rt_process_context& ctx)
 {
-    std::swap (_ctl._rt_value, _new_rt_value);
+    if (_offset == 0)
+        std::swap (_ctl._rt_value, _new_rt_value);
+    else
+        _ctl.rt_schedule (_offset, _new_rt_value);
+
     if (!_ctl._is_updated)
     {
         _ctl._is_updated = true;
@@ -152,7 +201,26 @@ void in_control<T>::rt_update_event::operator () (rt_process_context& ctx)
 template <typename T>
 void in_control<T>::rt_post_update_event::operator () (rt_process_context& ctx)
 {
-    _ctl._is_updated = false;
+    _ctl._is_updated = _ctl.rt_end_block (ctx.block_size ());
+    if (_ctl._is_updated)
+        ctx.push_rt_event<rt_post_update_event> (_ctl);
+}
+
+template <class Range, class Fn>
+void rt_split_block (std::size_t frames, const Range& controls, Fn fn)
+{
+    std::size_t start = 0;
+    while (start < frames)
+    {
+        std::size_t end = frames;
+        for (const auto& ctl : controls)
+        {
+            ctl->rt_apply_changes (start);
+            end = std::min (end, ctl->rt_next_change ());
+        }
+        fn (start, end - start);
+        start = end;
+    }
 }
 
 } /* namespace graph */
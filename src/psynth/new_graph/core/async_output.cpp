@@ -29,6 +29,7 @@
  */
 
 #include <iostream>
+#include <algorithm>
 #include "sound/output.hpp"
 
 #include "io/output.hpp"
@@ -54,7 +55,12 @@ constexpr float default_buffer_factor = 4.0f;
 async_output::async_output (device_ptr out)
     : _in_input ("input", this, audio_frame (0))
     , _output (out)
-    , _buffer (out ? out->buffer_size () * default_buffer_factor : 0)
+    , _block_size (default_block_size)
+    , _next_block_size (default_block_size)
+    , _render_ahead (0)
+    , _render_thread (new io::render_ahead (
+                          std::bind (&async_output::_needs_render, this),
+                          std::bind (&async_output::rt_request_process, this)))
 {
     using namespace std::placeholders;
 
@@ -63,6 +69,7 @@ async_output::async_output (device_ptr out)
         out->check_idle ();
         out->set_callback (
             std::bind (&async_output::_output_callback, this, _1));
+        _recreate_buffers ();
     }
 }
 
@@ -70,6 +77,8 @@ void async_output::start ()
 {
     if (!_output)
         throw async_output_not_bound_error ();
+    if (_render_ahead)
+        _render_thread->start ();
     _output->start ();
 }
 
@@ -78,6 +87,40 @@ void async_output::stop ()
     if (!_output)
         throw async_output_not_bound_error ();
     _output->stop ();
+    _render_thread->soft_stop ();
+}
+
+void async_output::set_render_ahead (std::size_t frames)
+{
+    const bool started =
+        _output && _output->state () != io::async_state::idle;
+
+    if (started)
+        stop ();
+    _render_ahead = frames;
+    if (_output)
+        _recreate_buffers ();
+    if (started)
+        start ();
+}
+
+/**
+ * The ring must fit what the device reads, a whole block and what we
+ * render ahead. Otherwise the blocks that do not fit are dropped, and
+ * with blocks bigger than the ring we would never render.
+ */
+std::size_t async_output::_buffer_size () const
+{
+    const std::size_t device = _output->buffer_size ();
+    return std::max<std::size_t> (
+        device * default_buffer_factor + _render_ahead,
+        device + _next_block_size + _render_ahead);
+}
+
+void async_output::_recreate_buffers ()
+{
+    _buffer.recreate (_buffer_size ());
+    _silence.recreate (_output->buffer_size (), audio_frame (0), 0);
 }
 
 void async_output::set_output (device_ptr out)
@@ -88,42 +131,95 @@ void async_output::set_output (device_ptr out)
     {
         started = _output->state () != io::async_state::idle;
         if (started)
-            _output->stop ();
+            stop ();
     }
     _output = out;
 
     if (out)
     {
-        _buffer.recreate (out->buffer_size () * default_buffer_factor);
+        _recreate_buffers ();
         if (started)
-            _output->start ();
+            start ();
     }
 }
 
+void async_output::on_prepare_context_update (std::size_t block_size,
+                                              std::size_t frame_rate)
+{
+    _next_block_size = block_size;
+    if (!_output ||
+        std::size_t (range (_buffer).size ()) >= _buffer_size ())
+        return;
+
+    const bool started = _output->state () != io::async_state::idle;
+    if (started)
+        stop ();
+    _recreate_buffers ();
+    if (started)
+        start ();
+}
+
+void async_output::rt_on_context_update (rt_process_context& ctx)
+{
+    _block_size = ctx.block_size ();
+}
+
+bool async_output::_needs_render ()
+{
+    // Leave room for a whole block, it would be dropped otherwise.
+    auto& rng = range (_buffer);
+    const std::ptrdiff_t fill = rng.size () - rng.write_available ();
+    return fill < std::min<std::ptrdiff_t> (
+        _render_ahead, rng.size () - _block_size);
+}
+
 void async_output::rt_do_process (rt_process_context& ctx)
 {
     // This request might come from another thread. Thus, we store it
     // in the ring buffer. If it was us who made the request and the
     // buffer size matches the block size, then we'll directly send it
     // to the device, otherwise we accumulate the results until the
-    // device requests the information.
+    // device requests the information. The ring buffer is lock free
+    // for one writer and one reader, and frames that do not fit
+    // because the device is lagging behind are dropped.
 
     range (_buffer).write (_in_input.rt_in_range ());
 }
 
 void async_output::_output_callback (std::size_t nframes)
 {
-    // FIXME: This needs locking or fixing the ring buffer
-    // implementation to be lock free.
-
     auto& rng = range (_buffer);
-    while (rng.available (_pos) < (std::ptrdiff_t) nframes)
+
+    if (_render_thread->state () == io::async_state::running)
+    {
+        // Never process from here, late frames become silence.
+        const std::size_t avail = rng.read_available ();
+        const std::size_t slice = std::min (avail, nframes);
+
+        _output->put (rng.sub_buffer_one (slice));
+        _output->put (rng.sub_buffer_two (slice));
+        rng.consume (slice);
+
+        std::size_t left = nframes - slice;
+        while (left > 0 && _silence.size () > 0)
+        {
+            const std::size_t n = std::min<std::size_t> (
+                left, _silence.size ());
+            _output->put (sub_range (range (_silence), 0, n));
+            left -= n;
+        }
+
+        _render_thread->consumed (avail, nframes);
+        return;
+    }
+
+    while (rng.read_available () < (std::ptrdiff_t) nframes)
         rt_request_process ();
 
-    _output->put (rng.sub_buffer_one (_pos, nframes));
-    _output->put (rng.sub_buffer_two (_pos, nframes));
+    _output->put (rng.sub_buffer_one (nframes));
+    _output->put (rng.sub_buffer_two (nframes));
 
-    rng.advance (_pos, nframes);
+    rng.consume (nframes);
 }
 
 } /* namespace core */
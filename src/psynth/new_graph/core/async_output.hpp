@@ -31,7 +31,11 @@
 #ifndef PSYNTH_GRAPH_CORE_ASYNC_OUTPUT_NODE_HPP_
 #define PSYNTH_GRAPH_CORE_ASYNC_OUTPUT_NODE_HPP_
 
+#include <atomic>
+#include <memory>
+
 #include <psynth/io/output_fwd.hpp>
+#include <psynth/io/render_ahead.hpp>
 
 #include <psynth/new_graph/control.hpp>
 #include <psynth/new_graph/buffer_port.hpp>
@@ -69,21 +73,49 @@ public:
     void start ();
     void stop ();
 
+    /**
+     * Processes the graph @a frames ahead of the device from a
+     * separate thread, so the device callback only copies the
+     * output. Zero disables it and the graph is processed from the
+     * callback itself.
+     */
+    void set_render_ahead (std::size_t frames);
+
+    std::size_t render_ahead () const
+    { return _render_ahead; }
+
+    io::render_ahead_stats render_stats () const
+    { return _render_thread->stats (); }
+
+    void reset_render_stats ()
+    { _render_thread->reset_stats (); }
+
 protected:
-    void rt_do_update_context (rt_process_context& ctx);
     void rt_do_process (rt_process_context& ctx);
 
 private:
+    void rt_on_context_update (rt_process_context& ctx);
+    void on_prepare_context_update (std::size_t block_size,
+                                    std::size_t frame_rate);
+
     void _output_callback (std::size_t nframes);
+    std::size_t _buffer_size () const;
+    void _recreate_buffers ();
+    bool _needs_render ();
 
     defaulting_audio_in_port _in_input;
 
     // FIXME: Actually there is unnecesary buffering here, because we
     // buffer first to accumulate the output, then to convert it.
 
-    device_ptr         _output;
-    audio_ring_buffer  _buffer;
-    audio_ring_buffer::range::position _pos;
+    device_ptr              _output;
+    audio_spsc_ring_buffer  _buffer;
+    audio_buffer            _silence;
+
+    std::atomic<std::size_t> _block_size;
+    std::size_t              _next_block_size; // Not for the audio thread.
+    std::size_t              _render_ahead;
+    std::unique_ptr<io::render_ahead> _render_thread;
 };
 
 } /* namespace core */
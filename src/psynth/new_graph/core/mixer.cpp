@@ -30,7 +30,7 @@
 
 #include <boost/lexical_cast.hpp>
 
-#include "synth/util.hpp"
+#include "synth/mix.hpp"
 #include "mixer.hpp"
 
 namespace psynth
@@ -74,21 +74,41 @@ void mixer<B>::rt_do_process (rt_process_context& ctx)
     typedef typename in_port_type::port_type::value_type frame_type;
     typedef typename sound::sample_type<frame_type>::type sample_type;
 
+    // The buffers are planar (or mono), so each channel is a
+    // contiguous block of floats that can be mixed on its own.
+    constexpr std::size_t num_channels =
+        sound::num_samples<frame_type>::value;
+
     int num_mixed = 0;
 
-    auto out  = _out_output.rt_out_range ();
-    float gain = _ctl_gain.rt_get ();
+    auto out = _out_output.rt_out_range ();
 
     sound::fill_frames (out, frame_type (0.0f));
     for (auto& in : _in_inputs)
     {
         if (in->rt_in_available ())
-        {
-            synth::mix (out, in->rt_in_range (), gain, out);
             ++ num_mixed;
-        }
     }
 
+    // The gain may change in the middle of the block.
+    rt_split_block (
+        out.size (), { &_ctl_gain },
+        [&] (std::size_t start, std::size_t size)
+        {
+            const float gain = _ctl_gain.rt_get ();
+            for (auto& in : _in_inputs)
+            {
+                if (!in->rt_in_available ())
+                    continue;
+                auto src = in->rt_in_range ();
+                for (std::size_t c = 0; c < num_channels; ++c)
+                    synth::mix_block (synth::mix_op::sum,
+                                      (float*) &out [start][c],
+                                      (const float*) &src [start][c],
+                                      gain, size);
+            }
+        });
+
     if (num_mixed == 0)
     {
         auto zero = sound::sample_traits<sample_type>::zero_value ();
@@ -58,7 +58,15 @@ void noise<D, Output>::rt_do_process (rt_process_context& ctx)
     auto mod_buf = sound::channel_converted_range<out_frame_type>(
         _in_modulator.rt_in_range ());
     _noise.update (out_buf);
-    synth::modulate (out_buf, mod_buf, _ctl_amplitude.rt_get (), out_buf);
+
+    rt_split_block (
+        out_buf.size (), { &_ctl_amplitude },
+        [&] (std::size_t start, std::size_t size)
+        {
+            auto out = sound::sub_range (out_buf, start, size);
+            synth::modulate (out, sound::sub_range (mod_buf, start, size),
+                             _ctl_amplitude.rt_get (), out);
+        });
 }
 
 
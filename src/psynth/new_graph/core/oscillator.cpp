@@ -29,6 +29,7 @@
  */
 
 #include <iostream>
+#include <type_traits>
 #include "oscillator.hpp"
 
 namespace psynth
@@ -65,7 +66,10 @@ oscillator<G, O>::oscillator ()
     , _ctl_modulator ("modulator", this, default_modulator)
     , _osc (44100.0f,            // Doesn't matter
             default_frequency,
-            default_amplitude)
+            default_amplitude,
+            0.0f,
+            // Control rate ones keep the sharp edges.
+            std::is_same<O, audio_out_port>::value)
 {
 }
 
@@ -75,34 +79,48 @@ void oscillator<G, O>::rt_on_context_update (rt_process_context& ctx)
     _osc.set_frame_rate (ctx.frame_rate ());
 }
 
+/**
+ * The block is split at the timestamped changes of the controls, so
+ * they happen at the right frame.
+ */
 template <class G, class O>
 void oscillator<G, O>::rt_do_process (rt_process_context& ctx)
 {
-    _osc.set_frequency (_ctl_frequency.rt_get ());
-    _osc.set_amplitude (_ctl_amplitude.rt_get ());
+    auto out_buf = _out_output.rt_out_range ();
+    const bool modulated = _in_modulator.rt_in_available ();
 
-    if (!_in_modulator.rt_in_available ())
-        _osc.update (_out_output.rt_out_range ());
-    else
-    {
-        switch (_ctl_modulator.rt_get ())
+    rt_split_block (
+        out_buf.size (),
+        { &_ctl_frequency, &_ctl_amplitude, &_ctl_modulator },
+        [&] (std::size_t start, std::size_t size)
         {
-        case 0:
-            _osc.update_am (_out_output.rt_out_range (),
-                            _in_modulator.rt_in_range ());
-            break;
-        case 1:
-            _osc.update_fm (_out_output.rt_out_range (),
-                            _in_modulator.rt_in_range ());
-            break;
-        case 2:
-            _osc.update_pm (_out_output.rt_out_range (),
-                            _in_modulator.rt_in_range ());
-            break;
-        default:
-            _osc.update (_out_output.rt_out_range ());
-        }
-    }
+            _osc.set_frequency (_ctl_frequency.rt_get ());
+            _osc.set_amplitude (_ctl_amplitude.rt_get ());
+
+            auto out = sound::sub_range (out_buf, start, size);
+            if (!modulated)
+            {
+                _osc.update (out);
+                return;
+            }
+
+            auto mod = sound::sub_range (
+                _in_modulator.rt_in_range (), start, size);
+            switch (_ctl_modulator.rt_get ())
+            {
+            case 0:
+                _osc.update_am (out, mod);
+                break;
+            case 1:
+                _osc.update_fm (out, mod);
+                break;
+            case 2:
+                _osc.update_pm (out, mod);
+                break;
+            default:
+                _osc.update (out);
+            }
+        });
 }
 
 } /* namespace core */
@@ -0,0 +1,120 @@
+/**
+ *  Time-stamp:  <2011-07-07 20:31:24 raskolnikov>
+ *
+ *  @file        oscillator_bank.cpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Thu Jul  7 19:58:02 2011
+ *
+ *  @brief Polyphonic oscillator node implementation.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <boost/lexical_cast.hpp>
+
+#include "oscillator_bank.hpp"
+
+namespace psynth
+{
+namespace graph
+{
+namespace core
+{
+
+PSYNTH_REGISTER_NODE_STATIC (audio_oscillator_bank);
+PSYNTH_REGISTER_NODE_STATIC (sample_oscillator_bank);
+
+constexpr std::size_t default_voices = 8;
+constexpr float default_frequency = 440.0f;
+constexpr float default_amplitude = 0.0f;
+constexpr int   default_wave = 0;
+
+template <class O>
+oscillator_bank<O>::oscillator_bank ()
+    : _out_output ("output", this)
+    , _bank (44100,              // Doesn't matter
+             default_voices)
+{
+    for (std::size_t i = 0; i < default_voices; ++i)
+    {
+        const auto suffix = std::string ("-") +
+            boost::lexical_cast<std::string> (i);
+
+        _ctl_frequency.push_back (
+            std::make_shared<in_control<float> > (
+                "frequency" + suffix, this, default_frequency));
+        _ctl_amplitude.push_back (
+            std::make_shared<in_control<float> > (
+                "amplitude" + suffix, this, default_amplitude));
+        _ctl_wave.push_back (
+            std::make_shared<in_control<int> > (
+                "wave" + suffix, this, default_wave));
+
+        _ctl_all.push_back (_ctl_frequency.back ().get ());
+        _ctl_all.push_back (_ctl_amplitude.back ().get ());
+        _ctl_all.push_back (_ctl_wave.back ().get ());
+
+        _bank.set_frequency (i, default_frequency);
+    }
+}
+
+template <class O>
+void oscillator_bank<O>::rt_on_context_update (rt_process_context& ctx)
+{
+    _bank.set_frame_rate (ctx.frame_rate ());
+}
+
+template <class O>
+void oscillator_bank<O>::rt_set_voices ()
+{
+    typedef synth::oscillator_bank::wave wave;
+
+    for (std::size_t i = 0; i < _bank.voices (); ++i)
+    {
+        const int w = _ctl_wave [i]->rt_get ();
+        _bank.set_wave (
+            i, w >= 0 && std::size_t (w) < synth::oscillator_bank::num_waves ?
+            wave (w) : wave::sine);
+        _bank.set_frequency (i, _ctl_frequency [i]->rt_get ());
+        _bank.set_amplitude (i, _ctl_amplitude [i]->rt_get ());
+    }
+}
+
+/**
+ * The block is only split when some voice has timestamped changes.
+ */
+template <class O>
+void oscillator_bank<O>::rt_do_process (rt_process_context& ctx)
+{
+    auto out_buf = _out_output.rt_out_range ();
+
+    rt_split_block (
+        out_buf.size (), _ctl_all,
+        [&] (std::size_t start, std::size_t size)
+        {
+            rt_set_voices ();
+            _bank.update (sound::sub_range (out_buf, start, size));
+        });
+}
+
+} /* namespace core */
+} /* namespace graph */
+} /* namespace psynth */
@@ -0,0 +1,95 @@
+/**
+ *  Time-stamp:  <2011-07-07 20:31:16 raskolnikov>
+ *
+ *  @file        oscillator_bank.hpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Thu Jul  7 19:58:02 2011
+ *
+ *  @brief Polyphonic oscillator node.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_GRAPH_CORE_OSCILLATOR_BANK_HPP_
+#define PSYNTH_GRAPH_CORE_OSCILLATOR_BANK_HPP_
+
+#include <memory>
+#include <vector>
+
+#include <psynth/synth/oscillator_bank.hpp>
+#include <psynth/new_graph/node.hpp>
+#include <psynth/new_graph/buffer_port.hpp>
+#include <psynth/new_graph/control.hpp>
+
+namespace psynth
+{
+namespace graph
+{
+namespace core
+{
+
+/**
+ *  Sums several oscillators in a single node. This is cheaper than
+ *  one oscillator node per voice connected to mixers, both because
+ *  the voices are computed together and because the graph is
+ *  smaller.
+ *
+ *  Output:
+ *    "output" : Output
+ *
+ *  Params, for every voice N:
+ *    "frequency-N" : float
+ *    "amplitude-N" : float
+ *    "wave-N"      : int (0 : sine, 1 : square, 2 : triangle,
+ *                         3 : sawtooth, 4 : moogsaw, 5 : exp)
+ */
+template <class Output>
+class oscillator_bank : public node
+{
+public:
+    oscillator_bank ();
+
+protected:
+    void rt_on_context_update (rt_process_context& ctx);
+    void rt_do_process (rt_process_context& ctx);
+    void rt_set_voices ();
+
+    typedef std::shared_ptr<in_control<float> > float_control_ptr;
+    typedef std::shared_ptr<in_control<int> >   int_control_ptr;
+
+    Output _out_output;
+
+    std::vector<float_control_ptr> _ctl_frequency;
+    std::vector<float_control_ptr> _ctl_amplitude;
+    std::vector<int_control_ptr>   _ctl_wave;
+    std::vector<in_control_base*>  _ctl_all;
+
+    synth::oscillator_bank _bank;
+};
+
+typedef oscillator_bank<audio_out_port>  audio_oscillator_bank;
+typedef oscillator_bank<sample_out_port> sample_oscillator_bank;
+
+} /* namespace core */
+} /* namespace graph */
+} /* namespace psynth */
+
+#endif /* PSYNTH_GRAPH_CORE_OSCILLATOR_BANK_HPP_ */
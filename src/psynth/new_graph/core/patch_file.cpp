@@ -0,0 +1,149 @@
+/**
+ *  Time-stamp:  <2011-07-09 18:23:41 raskolnikov>
+ *
+ *  @file        patch_file.cpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sat Jul  9 17:03:55 2011
+ *
+ *  @brief Textual description of patches.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#define PSYNTH_MODULE_NAME "psynth.graph.core.patch_file"
+
+#include <fstream>
+#include <map>
+#include <sstream>
+
+#include "base/throw.hpp"
+#include "new_graph/core/patch.hpp"
+#include "new_graph/core/patch_file.hpp"
+
+namespace psynth
+{
+namespace graph
+{
+namespace core
+{
+
+PSYNTH_DEFINE_ERROR (patch_file_error);
+
+namespace
+{
+
+std::string rest_of_line (std::istream& in)
+{
+    std::string rest;
+    std::getline (in >> std::ws, rest);
+    return rest;
+}
+
+} /* anonymous namespace */
+
+patch_ptr load_patch (std::istream& in)
+{
+    auto& factory = node_factory::self ();
+    auto  result  = new_patch ();
+    std::map<std::string, node_ptr> nodes;
+
+    auto find_node = [&] (const std::string& id, std::size_t line_no)
+        -> node_ptr
+    {
+        auto it = nodes.find (id);
+        if (it == nodes.end ())
+            PSYNTH_THROW (patch_file_error)
+                << "Line " << line_no << ": unknown node " << id;
+        return it->second;
+    };
+
+    std::string line;
+    std::size_t line_no = 0;
+    while (std::getline (in, line))
+    {
+        ++ line_no;
+        std::istringstream tokens (line);
+        std::string command;
+        if (!(tokens >> command) || command [0] == '#')
+            continue;
+
+        try
+        {
+            if (command == "node")
+            {
+                std::string id, type;
+                if (!(tokens >> id >> type))
+                    PSYNTH_THROW (patch_file_error)
+                        << "Line " << line_no << ": expected node <id> <type>";
+                if (nodes.count (id))
+                    PSYNTH_THROW (patch_file_error)
+                        << "Line " << line_no << ": repeated node " << id;
+                nodes [id] = result->add (factory.create (type));
+            }
+            else if (command == "param")
+            {
+                std::string id, param;
+                if (!(tokens >> id >> param))
+                    PSYNTH_THROW (patch_file_error)
+                        << "Line " << line_no
+                        << ": expected param <id> <param> <value>";
+                find_node (id, line_no)->param (param).str (
+                    rest_of_line (tokens));
+            }
+            else if (command == "connect")
+            {
+                std::string src, out, dst, in;
+                if (!(tokens >> src >> out >> dst >> in))
+                    PSYNTH_THROW (patch_file_error)
+                        << "Line " << line_no
+                        << ": expected connect <id> <output> <id> <input>";
+                connect (find_node (src, line_no), out,
+                         find_node (dst, line_no), in);
+            }
+            else
+                PSYNTH_THROW (patch_file_error)
+                    << "Line " << line_no << ": unknown command " << command;
+        }
+        catch (patch_file_error&)
+        {
+            throw;
+        }
+        catch (base::exception& err)
+        {
+            PSYNTH_THROW (patch_file_error)
+                << "Line " << line_no << ": " << err.what ();
+        }
+    }
+
+    return result;
+}
+
+patch_ptr load_patch (const std::string& fname)
+{
+    std::ifstream file (fname);
+    if (!file)
+        PSYNTH_THROW (patch_file_error) << "Can not open " << fname;
+    return load_patch (file);
+}
+
+} /* namespace core */
+} /* namespace graph */
+} /* namespace psynth */
@@ -0,0 +1,73 @@
+/**
+ *  Time-stamp:  <2011-07-09 18:22:10 raskolnikov>
+ *
+ *  @file        patch_file.hpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sat Jul  9 17:03:55 2011
+ *
+ *  @brief Textual description of patches.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_GRAPH_CORE_PATCH_FILE_HPP_
+#define PSYNTH_GRAPH_CORE_PATCH_FILE_HPP_
+
+#include <iosfwd>
+#include <string>
+
+#include <psynth/new_graph/exception.hpp>
+#include <psynth/new_graph/core/patch_fwd.hpp>
+
+namespace psynth
+{
+namespace graph
+{
+namespace core
+{
+
+PSYNTH_DECLARE_ERROR (error, patch_file_error);
+
+/**
+ * Builds a patch from a description with one command per line:
+ *
+ * @code
+ * # Comments start with a hash.
+ * node <id> <type>
+ * param <id> <param> <value>
+ * connect <id> <output> <id> <input>
+ * @endcode
+ *
+ * Types are the names in the node factory and values are parsed like
+ * in_control_base::str does. The ports of the patch are nodes like
+ * any other, for example @c audio_patch_out_port with its @c
+ * port-name parameter set.
+ *
+ * Throws patch_file_error on malformed or unknown commands.
+ */
+patch_ptr load_patch (std::istream& in);
+patch_ptr load_patch (const std::string& fname);
+
+} /* namespace core */
+} /* namespace graph */
+} /* namespace psynth */
+
+#endif /* PSYNTH_GRAPH_CORE_PATCH_FILE_HPP_ */
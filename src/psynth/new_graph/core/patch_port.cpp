@@ -63,7 +63,8 @@ namespace detail
 {
 
 template <class Base>
-void port_name_control<Base>::set (const std::string& name)
+void port_name_control<Base>::set (const std::string& name,
+                                   std::size_t offset)
 {
     auto& node = static_cast<Base&> (owner ()); // Safe!
 
@@ -88,7 +89,7 @@ void port_name_control<Base>::set (const std::string& name)
         port._set_name (name);
     }
 
-    base_type::set (name);
+    base_type::set (name, offset);
 }
 
 template class port_name_control<patch_in_port_base>;
@@ -86,7 +86,11 @@ public:
     port_name_control (std::string name, node* owner, const std::string val)
         : base_type (name, owner, val) {}
 
-    void set (const std::string& name);
+    void set (const std::string& name)
+    { set (name, 0); }
+
+    /** The port is renamed right away, whatever the @a offset. */
+    void set (const std::string& name, std::size_t offset);
 };
 
 extern template class port_name_control<patch_in_port_base>;
@@ -67,6 +67,16 @@ void node::rt_context_update (rt_process_context& ctx)
     rt_on_context_update (ctx);
 }
 
+void node::prepare_context_update (std::size_t block_size,
+                                   std::size_t frame_rate)
+{
+    for (auto& in : inputs ())
+        in.prepare_context_update (block_size, frame_rate);
+    for (auto& out : outputs ())
+        out.prepare_context_update (block_size, frame_rate);
+    on_prepare_context_update (block_size, frame_rate);
+}
+
 void node::rt_process (rt_process_context& ctx)
 {
     if (!_rt_processed)
@@ -74,6 +84,7 @@ void node::rt_process (rt_process_context& ctx)
         _rt_processed = true;
         for (auto& in : inputs ())
             in.rt_process (ctx);
+        PSYNTH_PROFILE_SCOPE (_profile);
         this->rt_do_process (ctx);
     }
 }
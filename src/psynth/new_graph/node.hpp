@@ -38,6 +38,7 @@
 #include <boost/intrusive/list_hook.hpp>
 
 #include <psynth/base/util.hpp>
+#include <psynth/base/dsp_profile.hpp>
 #include <psynth/base/factory_manager.hpp>
 #include <psynth/new_graph/exception.hpp>
 
@@ -100,6 +101,13 @@ public:
     virtual void rt_context_update (rt_process_context& ctx);
     virtual void rt_advance ();
 
+    /**
+     * Prepares the node, out of the audio thread, for a context
+     * update with these parameters.
+     */
+    void prepare_context_update (std::size_t block_size,
+                                 std::size_t frame_rate);
+
     in_port_base& in (const std::string& name);
     const in_port_base& in (const std::string& name) const;
     input_range inputs ();
@@ -174,9 +182,31 @@ public:
     template <class Fn>
     void execute_rt (const Fn& fn);
 
+    /**
+     * Time spent in rt_do_process() per block. Always empty unless the
+     * library was built with the profiler.
+     */
+    base::dsp_stats dsp_stats () const
+    {
+#ifdef PSYNTH_HAVE_PROFILER
+        return _profile.stats ();
+#else
+        return base::dsp_stats ();
+#endif
+    }
+
+    void reset_dsp_stats ()
+    {
+#ifdef PSYNTH_HAVE_PROFILER
+        _profile.reset_stats ();
+#endif
+    }
+
 private:
 
     virtual void rt_on_context_update (rt_process_context& ctx) {}
+    virtual void on_prepare_context_update (std::size_t block_size,
+                                            std::size_t frame_rate) {}
     virtual void rt_do_process (rt_process_context& ctx) {}
 
     core::patch* _patch;
@@ -189,6 +219,10 @@ private:
 
     bool _rt_processed;
     bool _rt_post_processed;
+
+#ifdef PSYNTH_HAVE_PROFILER
+    base::dsp_profile _profile;
+#endif
 };
 
 void connect (node_ptr source, const std::string& out_port,
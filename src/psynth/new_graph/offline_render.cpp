@@ -0,0 +1,114 @@
+/**
+ *  Time-stamp:  <2011-07-09 18:41:20 raskolnikov>
+ *
+ *  @file        offline_render.cpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sat Jul  9 16:12:47 2011
+ *
+ *  @brief Rendering without a device driving the processor.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <chrono>
+
+#include "base/scope_guard.hpp"
+#include "new_graph/core/patch.hpp"
+#include "new_graph/core/passive_output.hpp"
+#include "new_graph/processor.hpp"
+#include "new_graph/offline_render.hpp"
+
+#ifdef PSYNTH_HAVE_WAV
+#include "io/buffered_output.hpp"
+#include "io/file_output.hpp"
+#endif
+
+namespace psynth
+{
+namespace graph
+{
+
+render_stats render_offline (processor& proc, std::size_t frames)
+{
+    const std::size_t block_size = proc.context ().block_size ();
+    const std::size_t remainder  = frames % block_size;
+    const bool was_running = proc.is_running ();
+
+    render_stats stats;
+    stats.frames     = frames;
+    stats.frame_rate = proc.context ().frame_rate ();
+
+    {
+        if (!was_running)
+            proc.start ();
+        auto stop = base::make_guard ([&] {
+                if (!was_running)
+                    proc.stop ();
+            });
+
+        const auto start = std::chrono::steady_clock::now ();
+
+        proc.rt_request_process (frames / block_size);
+        if (remainder)
+        {
+            proc.set_block_size (remainder);
+            proc.rt_request_process ();
+        }
+
+        stats.elapsed = std::chrono::duration<double> (
+            std::chrono::steady_clock::now () - start).count ();
+    }
+
+    // Once stopped, an idle processor takes the change right away.
+    if (remainder)
+        proc.set_block_size (block_size);
+
+    return stats;
+}
+
+#ifdef PSYNTH_HAVE_WAV
+
+render_stats render_offline_to_file (core::patch_ptr patch,
+                                     const std::string& fname,
+                                     io::file_fmt format,
+                                     double seconds,
+                                     std::size_t block_size,
+                                     std::size_t frame_rate)
+{
+    processor proc (core::patch_ptr (), block_size, frame_rate);
+
+    auto out = proc.root ()->add (
+        core::new_passive_output (
+            io::new_buffered_output<
+                audio_range,
+                io::file_output<sound::stereo16sc_range> > (
+                    fname, format, frame_rate)));
+    proc.root ()->add (patch);
+    connect (patch, "output", out, "input");
+
+    return render_offline (
+        proc, std::size_t (seconds * frame_rate + 0.5));
+}
+
+#endif /* PSYNTH_HAVE_WAV */
+
+} /* namespace graph */
+} /* namespace psynth */
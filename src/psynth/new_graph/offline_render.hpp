@@ -0,0 +1,89 @@
+/**
+ *  Time-stamp:  <2011-07-09 18:40:02 raskolnikov>
+ *
+ *  @file        offline_render.hpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sat Jul  9 16:12:47 2011
+ *
+ *  @brief Rendering without a device driving the processor.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_GRAPH_OFFLINE_RENDER_HPP_
+#define PSYNTH_GRAPH_OFFLINE_RENDER_HPP_
+
+#include <cstddef>
+#include <string>
+
+#include <psynth/version.hpp>
+#include <psynth/io/file_common.hpp>
+#include <psynth/new_graph/processor_fwd.hpp>
+#include <psynth/new_graph/core/patch_fwd.hpp>
+
+namespace psynth
+{
+namespace graph
+{
+
+struct render_stats
+{
+    std::size_t frames;
+    std::size_t frame_rate;
+
+    /** Wall clock seconds spent rendering. */
+    double elapsed;
+
+    double duration () const
+    { return double (frames) / frame_rate; }
+
+    /** How many times faster than realtime the render was. */
+    double realtime_factor () const
+    { return elapsed > 0 ? duration () / elapsed : 0; }
+};
+
+/**
+ * Processes @a frames frames as fast as possible, so the passive
+ * outputs in the patch, usually file outputs, get the result. The
+ * last block is shortened so exactly @a frames frames are rendered.
+ *
+ * The processor is started for the duration of the render if it was
+ * not running, so asynchronous events are still handled.
+ */
+render_stats render_offline (processor& proc, std::size_t frames);
+
+#ifdef PSYNTH_HAVE_WAV
+/**
+ * Renders @a seconds seconds of the @c output port of @a patch to a
+ * new file, using a processor of its own.
+ */
+render_stats render_offline_to_file (core::patch_ptr patch,
+                                     const std::string& fname,
+                                     io::file_fmt format,
+                                     double seconds,
+                                     std::size_t block_size,
+                                     std::size_t frame_rate);
+#endif
+
+} /* namespace graph */
+} /* namespace psynth */
+
+#endif /* PSYNTH_GRAPH_OFFLINE_RENDER_HPP_ */
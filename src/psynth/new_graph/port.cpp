@@ -89,10 +89,9 @@ void out_port_base::_add_reference (in_port_base* ref)
         owner ().is_attached_to_process () &&
         owner ().process ().is_running ())
     {
-        auto& ctx = owner ().process ().context ();
-        ctx.push_rt_event (make_rt_event ([=] (rt_process_context&) {
-                    this->_rt_refs.push_back (*ref);
-                }));
+        owner ().process ().force_rt_event ([=] (rt_process_context&) {
+                this->_rt_refs.push_back (*ref);
+            });
     }
     else
         _rt_refs.push_back (*ref);
@@ -106,11 +105,9 @@ void out_port_base::_del_reference (in_port_base* ref)
         owner ().is_attached_to_process () &&
         owner ().process ().is_running ())
     {
-        auto& ctx = owner ().process ().context ();
-        ctx.push_rt_event (make_rt_event ([=] (rt_process_context&) {
-                    this->_rt_refs.remove_if (
-                        base::make_equal_id (*ref));
-                }));
+        owner ().process ().force_rt_event ([=] (rt_process_context&) {
+                this->_rt_refs.remove_if (base::make_equal_id (*ref));
+            });
     }
     else
         _rt_refs.remove_if (base::make_equal_id (*ref));
@@ -155,10 +152,9 @@ void in_port_base::_connect (out_port_base* source)
         owner ().is_attached_to_process () &&
         owner ().process ().is_running ())
     {
-        auto& ctx = owner ().process ().context ();
-        ctx.push_rt_event (make_rt_event ([=] (rt_process_context&) {
-                    this->_rt_connect (source);
-                }));
+        owner ().process ().force_rt_event ([=] (rt_process_context&) {
+                this->_rt_connect (source);
+            });
     }
     else
         this->_rt_connect (source);
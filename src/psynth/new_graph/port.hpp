@@ -68,6 +68,13 @@ public:
     virtual const port_meta& meta () const = 0;
     virtual void rt_context_update (rt_process_context&) {}
 
+    /**
+     * Called out of the audio thread before the block size or frame
+     * rate change, to allocate what rt_context_update needs.
+     */
+    virtual void prepare_context_update (std::size_t block_size,
+                                         std::size_t frame_rate) {}
+
     std::string name ()
     { return _name; }
 
@@ -307,6 +314,13 @@ public:
         OutPort::rt_context_update (ctx);
     }
 
+    void prepare_context_update (std::size_t block_size,
+                                 std::size_t frame_rate)
+    {
+        InPort::prepare_context_update (block_size, frame_rate);
+        OutPort::prepare_context_update (block_size, frame_rate);
+    }
+
     base::type_value type () const
     { return typeid (port_type); }
 
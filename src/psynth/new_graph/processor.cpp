@@ -30,8 +30,10 @@
 
 #define PSYNTH_MODULE_NAME "psynth.graph.processor"
 
+#include <chrono>
 #include <iostream>
 
+#include "base/scope_guard.hpp"
 #include "base/throw.hpp"
 #include "core/patch.hpp"
 #include "sink_node.hpp"
@@ -49,27 +51,46 @@ PSYNTH_DEFINE_ERROR_WHAT (processor_not_running_error,
 PSYNTH_DEFINE_ERROR_WHAT (processor_not_idle_error,
                           "Can not stop idle processor.");
 
+constexpr std::chrono::milliseconds async_poll_interval (10);
+
 basic_process_context::basic_process_context (std::size_t block_size,
                                               std::size_t frame_rate,
                                               std::size_t queue_size)
-    : _rt_buffers (rt_event_deque (queue_size),
-                   rt_event_deque (queue_size),
-                   rt_event_deque (queue_size))
-    , _async_buffers (async_event_deque (queue_size),
-                      async_event_deque (queue_size),
-                      async_event_deque (queue_size))
+    : _rt_events (queue_size / event_slot_size)
+    , _rt_local { rt_event_deque (queue_size),
+                  rt_event_deque (queue_size) }
+    , _rt_local_index (0)
+    , _rt_local_overflowed (0)
+    , _async_events (queue_size / event_slot_size)
     , _block_size (block_size)
     , _frame_rate (frame_rate)
-    , _async_request_flip (false)
 {
 }
 
+std::size_t basic_process_context::overflowed_events () const
+{
+    return
+        _rt_events.overflowed () +
+        _async_events.overflowed () +
+        _rt_local_overflowed.load (std::memory_order_relaxed);
+}
+
+std::size_t basic_process_context::dropped_events () const
+{
+    return _rt_events.dropped () + _async_events.dropped ();
+}
+
 processor::processor (core::patch_ptr root,
                       std::size_t block_size,
                       std::size_t frame_rate,
                       std::size_t queue_size)
     : _root (root ? root : core::new_patch ())
     , _ctx (block_size, frame_rate, queue_size)
+    , _arena (std::make_shared<sound::buffer_arena> ())
+    , _packing (false)
+    , _next_block_size (block_size)
+    , _next_frame_rate (frame_rate)
+    , _update_pending (false)
     , _is_running (false)
 {
     _explore_node_add (_root);
@@ -110,38 +131,151 @@ void processor::stop ()
         _ctx._async_thread.join ();
 }
 
+/**
+ * The audio thread can not take the mutex to wake us up, so a
+ * notification may arrive between checking the queue and waiting.
+ * Waking up every now and then bounds the delay of such events.
+ */
 void processor::_async_loop ()
 {
-    while (_is_running || // HACK!!!!
-           !_ctx._async_buffers.local ().empty ())
+    while (_is_running || !_ctx._async_events.empty ())
     {
+        _ctx._async_events.consume ([&] (async_event& ev) { ev (_ctx); });
+
         std::unique_lock<std::mutex> g (_ctx._async_mutex);
+        if (_is_running && _ctx._async_events.empty ())
+            _ctx._async_cond.wait_for (g, async_poll_interval);
+    }
+}
+
+void processor::set_block_size (std::size_t new_size)
+{
+    std::unique_lock<std::mutex> g (_update_mutex);
+    _next_block_size = new_size;
+    _update_context ();
+}
+
+void processor::set_frame_rate (std::size_t new_frame_rate)
+{
+    std::unique_lock<std::mutex> g (_update_mutex);
+    _next_frame_rate = new_frame_rate;
+    _update_context ();
+}
+
+/**
+ * The audio thread may still be swapping in the buffers of an
+ * earlier update, so those are not prepared again until it is
+ * applied. Instead of waiting for the next block, we apply it
+ * ourselves with the queued events, like the audio thread would
+ * before processing.
+ */
+void processor::_update_context ()
+{
+    if (_update_pending.load (std::memory_order_acquire))
+    {
+        std::unique_lock<std::mutex> g (_rt_mutex);
+        _ctx._rt_events.consume ([&] (rt_event& ev) { ev (_ctx); });
+    }
+
+    const std::size_t block_size = _next_block_size;
+    const std::size_t frame_rate = _next_frame_rate;
+
+    // The buffers being replaced keep the old arena alive.
+    _arena = std::make_shared<sound::buffer_arena> ();
+    {
+        _packing = true;
+        auto done = base::make_guard ([&] { _packing = false; });
+        _prepare_context_update (*_root, block_size, frame_rate);
+    }
+
+    auto update = [=] (rt_process_context&) {
+        _ctx._block_size = block_size;
+        _ctx._frame_rate = frame_rate;
+        this->_rt_context_update (*_root);
+        _update_pending.store (false, std::memory_order_release);
+    };
+
+    if (is_running ())
+    {
+        _update_pending = true;
+        if (!context ().push_rt_event (make_rt_event (std::move (update))))
+            _update_pending = false;
+    }
+    else
+    {
+        std::unique_lock<std::mutex> g (_rt_mutex);
+        update (_ctx);
+    }
+}
+
+void processor::_prepare_context_update (node& n,
+                                         std::size_t block_size,
+                                         std::size_t frame_rate)
+{
+    n.prepare_context_update (block_size, frame_rate);
+
+    auto patch = dynamic_cast<core::patch*> (&n);
+    if (patch)
+    {
+        for (auto& child : patch->childs ())
+            _prepare_context_update (*child, block_size, frame_rate);
+    }
+}
+
+/**
+ * Nodes added while the update is pending were not prepared and may
+ * allocate here.
+ */
+void processor::_rt_context_update (node& n)
+{
+    n.rt_context_update (_ctx);
+
+    auto patch = dynamic_cast<core::patch*> (&n);
+    if (patch)
+    {
+        for (auto& child : patch->rt_childs ())
+            _rt_context_update (child);
+    }
+}
 
-        for (auto& ev : _ctx._async_buffers.front ())
-            ev (_ctx);
-        _ctx._async_buffers.front ().clear ();
-        _ctx._async_request_flip = true;
+namespace
+{
 
-        _ctx._async_buffers.flip_local ();
-        for (auto& ev : _ctx._async_buffers.front ())
-            ev (_ctx);
-        _ctx._async_buffers.front ().clear ();
+template <class Fn>
+void for_each_node (node_ptr n, Fn fn)
+{
+    if (!n)
+        return;
 
-        while (_ctx._async_request_flip &&
-               _ctx._async_buffers.local ().empty () &&
-               _is_running)
-            _ctx._async_cond.wait (g);
+    fn (n);
+    auto patch = dynamic_cast<core::patch*> (n.get ());
+    if (patch)
+    {
+        for (auto& child : patch->cchilds ())
+            for_each_node (child, fn);
     }
 }
 
-void processor::set_block_size (std::size_t new_size)
+} /* anonymous namespace */
+
+processor::dsp_stats_list processor::dsp_stats () const
 {
-    assert (false);
+    dsp_stats_list res;
+#ifdef PSYNTH_HAVE_PROFILER
+    for_each_node (_root, [&] (node_ptr n) {
+            res.push_back (std::make_pair (n, n->dsp_stats ()));
+        });
+#endif
+    return res;
 }
 
-void processor::set_frame_rate (std::size_t new_frame_rate)
+void processor::reset_dsp_stats ()
 {
-    assert (false);
+#ifdef PSYNTH_HAVE_PROFILER
+    for_each_node (_root, [] (node_ptr n) {
+            n->reset_dsp_stats ();
+        });
+#endif
 }
 
 void processor::rt_request_process (std::ptrdiff_t iterations)
@@ -164,28 +298,20 @@ void processor::rt_request_process ()
 
 void processor::_rt_process_once ()
 {
-    _ctx._rt_buffers.flip_back ();
-    for (auto& ev : _ctx._rt_buffers.front ())
-        ev (_ctx);
-    _ctx._rt_buffers.front ().clear ();
+    _ctx._rt_events.consume ([&] (rt_event& ev) { ev (_ctx); });
 
     for (auto& s : _sinks)
         s->rt_process (_ctx);
     _root->rt_advance ();
 
-    _ctx._rt_buffers.flip_local ();
-    for (auto& ev : _ctx._rt_buffers.front ())
+    auto& local = _ctx._rt_local [_ctx._rt_local_index];
+    _ctx._rt_local_index = !_ctx._rt_local_index;
+    for (auto& ev : local)
         ev (_ctx);
-    _ctx._rt_buffers.front ().clear ();
+    local.clear ();
 
-    std::unique_lock<std::mutex> g (_ctx._async_mutex, std::try_to_lock);
-    if (g.owns_lock () && _ctx._async_request_flip &&
-        !_ctx._async_buffers.back ().empty ())
-    {
-        _ctx._async_request_flip = false;
-        _ctx._async_buffers.flip_back ();
+    if (!_ctx._async_events.empty ())
         _ctx._async_cond.notify_all ();
-    }
 }
 
 void processor::_explore_node_add (node_ptr n)
@@ -195,6 +321,7 @@ void processor::_explore_node_add (node_ptr n)
     // parts.
 
     n->attach_to_process (*this);
+    n->prepare_context_update (_ctx.block_size (), _ctx.frame_rate ());
     n->rt_context_update (_ctx);
 
     auto sink = std::dynamic_pointer_cast<sink_node> (n);
@@ -203,10 +330,9 @@ void processor::_explore_node_add (node_ptr n)
         if (!is_running ())
             _sinks.push_back (sink);
         else
-            context ().push_rt_event (
-                make_rt_event ([=] (rt_process_context&) {
-                        this->_sinks.push_back (sink);
-                    }));
+            force_rt_event ([=] (rt_process_context&) {
+                    this->_sinks.push_back (sink);
+                });
     }
 
     auto proc = std::dynamic_pointer_cast<process_node> (n);
@@ -239,10 +365,9 @@ void processor::_explore_node_remove (node_ptr n)
         if (!is_running ())
             _sinks.remove (sink);
         else
-            context ().push_rt_event (
-                make_rt_event ([=] (rt_process_context&) {
-                        this->_sinks.remove (sink);
-                    }));
+            force_rt_event ([=] (rt_process_context&) {
+                    this->_sinks.remove (sink);
+                });
     }
 
     auto proc = std::dynamic_pointer_cast<process_node> (n);
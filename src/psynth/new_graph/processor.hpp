@@ -34,7 +34,10 @@
 #include <thread>
 #include <atomic>
 #include <list>
+#include <vector>
+#include <utility>
 #include <condition_variable>
+#include <memory>
 
 #include <psynth/new_graph/core/patch_fwd.hpp>
 #include <psynth/new_graph/node_fwd.hpp>
@@ -44,8 +47,10 @@
 
 #include <psynth/new_graph/exception.hpp>
 #include <psynth/new_graph/event.hpp>
-#include <psynth/new_graph/triple_buffer.hpp>
 
+#include <psynth/base/dsp_profile.hpp>
+#include <psynth/sound/buffer_allocator.hpp>
+#include <psynth/base/event_ring.hpp>
 #include <psynth/base/hetero_deque.hpp>
 #include <psynth/base/threads.hpp>
 
@@ -61,33 +66,30 @@ PSYNTH_DECLARE_ERROR (processor_error, processor_not_idle_error);
 constexpr std::size_t default_queue_size = 1 << 20;
 constexpr std::size_t default_block_size = 1 << 6;
 constexpr std::size_t default_frame_rate = 44100;
+constexpr std::size_t event_slot_size    = 128;
 
 class processor;
 
 typedef base::hetero_deque<rt_event>    rt_event_deque;
 typedef base::hetero_deque<async_event> async_event_deque;
 
-typedef triple_buffer<
-    rt_event_deque,
-    base::try_lock_guard<>,
-    base::no_lock_guard<> >
-rt_triple_buffer;
-
-typedef triple_buffer<
-    async_event_deque,
-    base::no_lock_guard<>, // We handle locking ourselves in the
-                           // processor class because it is not so simple.
-    base::lock_guard<> >
-async_triple_buffer;
+typedef base::event_ring<rt_event, event_slot_size>    rt_event_ring;
+typedef base::event_ring<async_event, event_slot_size> async_event_ring;
 
 class basic_process_context : private boost::noncopyable
 {
 public:
     std::size_t block_size () const
-    { return _block_size; }
+    { return _block_size.load (std::memory_order_relaxed); }
 
     std::size_t frame_rate () const
-    { return _frame_rate; }
+    { return _frame_rate.load (std::memory_order_relaxed); }
+
+    /** Number of events that were lost because a queue was full. */
+    std::size_t overflowed_events () const;
+
+    /** Number of events that were destroyed without running. */
+    std::size_t dropped_events () const;
 
 protected:
     /** Only processor can create instances. */
@@ -95,17 +97,33 @@ protected:
                            std::size_t frame_rate,
                            std::size_t queue_size);
 
-    rt_triple_buffer    _rt_buffers;
-    async_triple_buffer _async_buffers;
-
-    std::size_t _block_size;
-    std::size_t _frame_rate;
+    /**
+     * Events for the audio thread, pushed from other threads, that are
+     * run before processing a block.
+     */
+    rt_event_ring _rt_events;
+
+    /**
+     * Events pushed from the audio thread to itself, that are run
+     * after processing the block. Events pushed while running them go
+     * to the other deque and run after the next block.
+     */
+    rt_event_deque           _rt_local [2];
+    std::size_t              _rt_local_index;
+    std::atomic<std::size_t> _rt_local_overflowed;
+
+    /**
+     * Events for the asynchronous thread, from any thread.
+     */
+    async_event_ring _async_events;
+
+    // Only written by the audio thread while running.
+    std::atomic<std::size_t> _block_size;
+    std::atomic<std::size_t> _frame_rate;
 
-    // FIXME: Factor the related functions a bit
     std::thread             _async_thread;
     std::condition_variable _async_cond;
     std::mutex              _async_mutex;
-    bool                    _async_request_flip;
 
     friend class processor;
 };
@@ -265,15 +283,54 @@ public:
     const user_process_context& context () const
     { return _ctx; }
 
+    /**
+     * Changes the block size or the frame rate of the processing. The
+     * nodes allocate their new buffers in the calling thread and, if
+     * the processor is running, the change is applied by the audio
+     * thread before processing the next block. When an earlier change
+     * is still pending, the calling thread applies it first, holding
+     * the audio thread for that long.
+     */
     void set_block_size (std::size_t new_size);
     void set_frame_rate (std::size_t new_frame_rate);
 
+    /**
+     * Pushes @a fn as an rt event for changes that can not be lost,
+     * like connecting ports. When the queue is full, the queued events
+     * and then @a fn are run from the calling thread, holding the
+     * audio thread meanwhile. Not to be used from the audio thread.
+     */
+    template <class Fn>
+    void force_rt_event (Fn fn);
+
     void rt_request_process (std::ptrdiff_t iterations);
     void rt_request_process ();
 
     bool is_running () const
     { return _is_running; }
 
+    /**
+     * Arena for the buffers of the ports of the nodes, so the ones
+     * processed together are close in memory. A new one is used on
+     * every context update. Nodes added in between get none and take
+     * their buffers from the heap, as the arena does not reuse freed
+     * memory, until the next update packs them with the rest. Not to
+     * be used from the audio thread.
+     */
+    sound::buffer_arena_ptr buffer_arena () const
+    { return _packing ? _arena : sound::buffer_arena_ptr (); }
+
+    typedef std::vector<std::pair<node_ptr, base::dsp_stats> >
+    dsp_stats_list;
+
+    /**
+     * Time spent processing every node in the patch tree, children
+     * after their patch. The list is empty unless the library was
+     * built with the profiler. Must be called from the user thread.
+     */
+    dsp_stats_list dsp_stats () const;
+    void reset_dsp_stats ();
+
     /** To be called by patches */
     void notify_add_node (node_ptr node)
     { _explore_node_add (node); }
@@ -286,6 +343,12 @@ private:
     void _explore_node_add (node_ptr node);
     void _explore_node_remove (node_ptr node);
 
+    void _update_context ();
+    void _prepare_context_update (node& n,
+                                  std::size_t block_size,
+                                  std::size_t frame_rate);
+    void _rt_context_update (node& n);
+
     void _async_loop ();
     void _rt_process_once ();
 
@@ -300,6 +363,17 @@ private:
     full_process_context    _ctx;
 
     std::mutex              _rt_mutex;
+    sound::buffer_arena_ptr _arena;
+    bool                    _packing;
+
+    /**
+     * Requested context, which the audio thread may not have applied
+     * yet. Not to be used from the audio thread.
+     */
+    std::mutex              _update_mutex;
+    std::size_t             _next_block_size;
+    std::size_t             _next_frame_rate;
+    std::atomic<bool>       _update_pending;
 
     std::atomic<bool>       _is_running;
 };
@@ -41,48 +41,58 @@ namespace graph
 template <class Event, typename... Args>
 bool rt_process_context::push_rt_event (Args&&... args)
 {
-    return _rt_buffers.local ().push_back<Event> (
+    const bool pushed = _rt_local [_rt_local_index].push_back<Event> (
         std::forward<Args> (args) ...);
+    if (!pushed)
+        _rt_local_overflowed.fetch_add (1, std::memory_order_relaxed);
+    return pushed;
 }
 
 template <class Event, typename... Args>
 bool user_process_context::push_rt_event (Args&&... args)
 {
-    auto g = _rt_buffers.back_policy ().guard ();
-    return _rt_buffers.back ().push_back<Event> (
-        std::forward<Args> (args) ...);
+    return _rt_events.push_back<Event> (std::forward<Args> (args) ...);
 }
 
 template <class Event, typename... Args>
 bool async_process_context::push_rt_event (Args&&... args)
 {
-    auto g = _rt_buffers.back_policy ().guard ();
-    return _rt_buffers.back ().push_back<Event> (
-        std::forward<Args> (args) ...);
+    return _rt_events.push_back<Event> (std::forward<Args> (args) ...);
 }
 
+/**
+ * The asynchronous thread is woken up once the block is processed.
+ */
 template <class Event, typename... Args>
 bool rt_process_context::push_async_event (Args&&... args)
 {
-    return _async_buffers.back ().push_back<Event> (
-        std::forward<Args> (args) ...);
+    return _async_events.push_back<Event> (std::forward<Args> (args) ...);
 }
 
 template <class Event, typename... Args>
 bool user_process_context::push_async_event (Args&&... args)
 {
-    auto g = _async_buffers.local_policy ().guard ();
-    return _async_buffers.local ().push_back<Event> (
+    const bool pushed = _async_events.push_back<Event> (
         std::forward<Args> (args) ...);
     _async_cond.notify_all ();
+    return pushed;
 }
 
 template <class Event, typename... Args>
 bool async_process_context::push_async_event (Args&&... args)
 {
-    auto g = _async_buffers.local_policy ().guard ();
-    return _async_buffers.local ().push_back<Event> (
-        std::forward<Args> (args) ...);
+    return _async_events.push_back<Event> (std::forward<Args> (args) ...);
+}
+
+template <class Fn>
+void processor::force_rt_event (Fn fn)
+{
+    if (context ().push_rt_event (make_rt_event (Fn (fn))))
+        return;
+
+    std::unique_lock<std::mutex> g (_rt_mutex);
+    _ctx._rt_events.consume ([&] (rt_event& ev) { ev (_ctx); });
+    fn (_ctx);
 }
 
 } /* namespace graph */
@@ -46,7 +46,15 @@ void soft_buffer_in_port<B>::rt_context_update (rt_process_context& ctx)
     base_type::rt_context_update (ctx);
     auto delta = 1.0f / (_duration * ctx.frame_rate ());
     _envelope.set_deltas (delta, -delta);
-    _local_buffer.recreate (ctx.block_size ());
+    rt_resize_buffer (_local_buffer, _next_local_buffer, ctx.block_size ());
+}
+
+template <class B>
+void soft_buffer_in_port<B>::prepare_context_update (std::size_t block_size,
+                                                     std::size_t frame_rate)
+{
+    base_type::prepare_context_update (block_size, frame_rate);
+    _next_local_buffer.recreate (block_size, 0, port_buffer_arena (*this));
 }
 
 template <class B>
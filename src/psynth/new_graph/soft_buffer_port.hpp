@@ -61,6 +61,8 @@ public:
     void connect (out_port_base& dest);
     void rt_process (rt_process_context& ctx);
     void rt_context_update (rt_process_context& ctx);
+    void prepare_context_update (std::size_t block_size,
+                                 std::size_t frame_rate);
 
 private:
     typedef synth::simple_envelope<sample_range> envelope_type;
@@ -71,6 +73,7 @@ private:
     envelope_type  _envelope;
     float          _duration;
     Buffer         _local_buffer;
+    Buffer         _next_local_buffer;
 };
 
 template <class B>
@@ -51,6 +51,8 @@
 #include <memory>
 #include <typeinfo>
 
+#include <boost/mpl/and.hpp>
+
 #include <psynth/base/compat.hpp>
 #include <psynth/base/concept.hpp>
 #include <psynth/sound/concept.hpp>
@@ -58,6 +60,7 @@
 #include <psynth/sound/buffer_range.hpp>
 #include <psynth/sound/buffer_range_factory.hpp>
 #include <psynth/sound/bit_aligned_frame_iterator.hpp>
+#include <psynth/sound/simd_algorithm.hpp>
 
 //#ifdef _MSC_VER
 //#pragma warning(push)
@@ -285,15 +288,45 @@ namespace psynth
 namespace sound
 {
 
+namespace detail
+{
+
+template <typename Range1, typename Range2>
+struct has_simd_copy_frames :
+	public boost::mpl::and_<
+    typename ranges_are_compatible<Range1, Range2>::type,
+    has_simd_copy_samples<Range1, Range2> >
+{};
+
+template <typename Range1, typename Range2> PSYNTH_FORCEINLINE
+void copy_frames (const Range1& src, const Range2& dst, boost::mpl::false_)
+{
+    std::copy (src.begin(), src.end(), dst.begin());
+}
+
+template <typename Range1, typename Range2> PSYNTH_FORCEINLINE
+void copy_frames (const Range1& src, const Range2& dst, boost::mpl::true_)
+{
+    simd_copy_samples_frames (src, dst);
+}
+
+} /* namespace detail */
+
 /**
    \ingroup ImageRangeSTLAlgorithmsCopyFrames
    \brief std::copy for image ranges
+
+   Copies of stereo frames of plain samples between interleaved and
+   planar ranges, or interleaved ranges with the channels swapped,
+   use a vectorized kernel.
 */
 template <typename Range1, typename Range2> PSYNTH_FORCEINLINE
 void copy_frames (const Range1& src, const Range2& dst)
 {
     assert (src.size () == dst.size ());
-    std::copy (src.begin(), src.end(), dst.begin());
+    detail::copy_frames (
+	src, dst,
+	typename detail::has_simd_copy_frames<Range1, Range2>::type ());
 }
 
 /**
@@ -334,8 +367,8 @@ public:
     template <typename V1, typename V2> PSYNTH_FORCEINLINE
     result_type apply_incompatible (const V1& src, const V2& dst) const
     {
-        copy_frames (channel_converted_range<typename V2::value_type>(src, _cc),
-		     dst);
+        convert (src, dst,
+                 typename has_simd_copy_and_convert<V1, V2, CC>::type ());
     }
 
     // If the two channel spaces are compatible, copy_and_convert is
@@ -345,6 +378,23 @@ public:
     {
          copy_frames (src,dst);
     }
+
+private:
+    template <typename V1, typename V2> PSYNTH_FORCEINLINE
+    void convert (const V1& src, const V2& dst, boost::mpl::false_) const
+    {
+        copy_frames (channel_converted_range<typename V2::value_type>(src, _cc),
+		     dst);
+    }
+
+    // the common conversions with the default converter have a
+    // vectorized kernel
+    template <typename V1, typename V2> PSYNTH_FORCEINLINE
+    void convert (const V1& src, const V2& dst, boost::mpl::true_) const
+    {
+        assert (src.size () == dst.size ());
+        simd_copy_and_convert_frames (src, dst);
+    }
 };
 
 } /* namespace detail */
@@ -420,6 +470,15 @@ void fill_aux(It first, It last, const P& p, boost::mpl::false_)
     std::fill (first, last, p);
 }
 
+/** std::fill for interleaved frames, converting the value once */
+template <typename T, typename L, typename P>
+PSYNTH_FORCEINLINE
+void fill_aux (frame<T, L>* first, frame<T, L>* last, const P& p,
+               boost::mpl::false_)
+{
+    std::fill (first, last, frame<T, L> (p));
+}
+
 } /* namespace detail */
 
 /**
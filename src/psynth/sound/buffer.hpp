@@ -43,6 +43,7 @@
 #include <memory>
 #include <psynth/base/compat.hpp>
 #include <psynth/sound/frame.hpp>
+#include <psynth/sound/buffer_allocator.hpp>
 #include <psynth/sound/buffer_range.hpp>
 #include <psynth/sound/metafunctions.hpp>
 #include <psynth/sound/algorithm.hpp>
@@ -69,6 +70,10 @@ namespace sound
  * frame type, a boolean indicating whether it should be planar, and
  * an optional allocator.
  *
+ * When the allocator guarantees some alignment, see
+ * allocator_alignment, the planes start and the buffer ends at a
+ * multiple of it, as with an explicit alignment.
+ *
  * Note that its element type does not have to be a frame. \p buffer
  * can be instantiated with any Regular element, in which case it
  * models the weaker RandomAccessBufferConcept and does not model
@@ -106,7 +111,7 @@ public:
 		     std::size_t alignment = 0,
 	    const Alloc alloc_in = Alloc())
 	: _memory (0)
-	, _align_in_bytes (alignment)
+	, _align_in_bytes (effective_alignment (alignment))
 	, _alloc (alloc_in)
     {
         allocate_and_default_construct (size);
@@ -117,7 +122,7 @@ public:
 	    std::size_t alignment,
 	    const Alloc alloc_in = Alloc())
 	: _memory (0)
-	, _align_in_bytes (alignment)
+	, _align_in_bytes (effective_alignment (alignment))
 	, _alloc (alloc_in)
     {
         allocate_and_fill (size, frame_in);
@@ -192,7 +197,7 @@ public:
 		   const Alloc alloc_in = Alloc ())
     {
         if (size != _range.size () ||
-	    _align_in_bytes != alignment ||
+	    _align_in_bytes != effective_alignment (alignment) ||
 	    alloc_in != _alloc)
 	{
             buffer tmp (size, alignment, alloc_in);
@@ -206,7 +211,7 @@ public:
 		   const Alloc alloc_in = Alloc())
     {
         if (size_ != size() ||
-	    _align_in_bytes != alignment ||
+	    _align_in_bytes != effective_alignment (alignment) ||
 	    alloc_in != _alloc)
 	{
             buffer tmp (size_, frame_in, alignment, alloc_in);
@@ -314,10 +319,16 @@ private:
 	    _alloc.deallocate (_memory, total_allocated_size_in_bytes (size));
     }
 
+    static std::size_t effective_alignment (std::size_t alignment)
+    {
+        const std::size_t alloc_alignment = allocator_alignment<Alloc>::value;
+        return alignment > alloc_alignment ? alignment : alloc_alignment;
+    }
+
     std::size_t total_allocated_size_in_bytes (size_type size) const
     {
-        std::size_t size_in_units = size * memunit_step (
-	    typename range::iterator ());
+        // every plane is padded to the alignment
+        std::size_t size_in_units = get_size_in_memunits (size);
         if (IsPlanar)
             size_in_units = size_in_units * num_samples<range>::value;
 
@@ -325,7 +336,8 @@ private:
         return (size_in_units +
 		byte_to_memunit<typename range::iterator>::value - 1) /
 	    byte_to_memunit<typename range::iterator>::value
-            + (_align_in_bytes > 0 ? _align_in_bytes - 1 : 0);
+            + (_align_in_bytes > allocator_alignment<Alloc>::value ?
+	       _align_in_bytes - 1 : 0);
 	// add extra padding in case we need to align the first buffer frame
     }
 
@@ -0,0 +1,280 @@
+/**
+ *  Time-stamp:  <2011-07-19 13:02:41 raskolnikov>
+ *
+ *  @file        buffer_allocator.hpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Tue Jul 19 10:45:12 2011
+ *
+ *  Allocators for buffers aligned to cache lines.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_SOUND_BUFFER_ALLOCATOR_HPP_
+#define PSYNTH_SOUND_BUFFER_ALLOCATOR_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+
+namespace psynth
+{
+namespace sound
+{
+
+constexpr std::size_t cache_line_size = 64;
+
+/**
+ * Alignment that an allocator guarantees for its memory. The buffers
+ * align the start of their planes and pad their size to it, so no two
+ * buffers share a cache line.
+ */
+template <class Alloc>
+struct allocator_alignment : public std::integral_constant<std::size_t, 0> {};
+
+/**
+ * An allocator whose memory starts at a multiple of @a Alignment,
+ * which must be a power of two.
+ */
+template <typename T, std::size_t Alignment = cache_line_size>
+class aligned_allocator
+{
+public:
+    typedef T              value_type;
+    typedef T*             pointer;
+    typedef const T*       const_pointer;
+    typedef T&             reference;
+    typedef const T&       const_reference;
+    typedef std::size_t    size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    static constexpr std::size_t alignment = Alignment;
+
+    template <typename U>
+    struct rebind { typedef aligned_allocator<U, Alignment> other; };
+
+    aligned_allocator () {}
+
+    template <typename U>
+    aligned_allocator (const aligned_allocator<U, Alignment>&) {}
+
+    pointer allocate (size_type n, const void* = 0)
+    {
+        // The pointer returned by malloc is kept just before the
+        // aligned block.
+        void* raw = std::malloc (n * sizeof (T) + Alignment + sizeof (void*));
+        if (!raw)
+            throw std::bad_alloc ();
+
+        const std::size_t addr = (std::size_t) raw + sizeof (void*);
+        void** res = (void**) ((addr + Alignment - 1) & ~(Alignment - 1));
+        res [-1] = raw;
+        return (pointer) res;
+    }
+
+    void deallocate (pointer p, size_type)
+    {
+        if (p)
+            std::free (((void**) p) [-1]);
+    }
+
+    size_type max_size () const
+    { return (size_type (-1) - Alignment - sizeof (void*)) / sizeof (T); }
+
+    template <typename U, typename... Args>
+    void construct (U* p, Args&&... args)
+    { ::new ((void*) p) U (std::forward<Args> (args)...); }
+
+    template <typename U>
+    void destroy (U* p)
+    { p->~U (); }
+};
+
+template <typename T, typename U, std::size_t A>
+bool operator== (const aligned_allocator<T, A>&, const aligned_allocator<U, A>&)
+{ return true; }
+
+template <typename T, typename U, std::size_t A>
+bool operator!= (const aligned_allocator<T, A>&, const aligned_allocator<U, A>&)
+{ return false; }
+
+template <typename T, std::size_t A>
+struct allocator_alignment<aligned_allocator<T, A> >
+    : public std::integral_constant<std::size_t, A> {};
+
+/**
+ * Memory for many buffers taken from a few big slabs, so buffers
+ * used together stay close in the cache. Every allocation starts at a
+ * cache line. Memory is only given back when the arena is destroyed,
+ * so a new arena should be used when all the buffers are recreated.
+ *
+ * Allocation is not thread safe.
+ */
+class buffer_arena : private boost::noncopyable
+{
+public:
+    static constexpr std::size_t alignment         = cache_line_size;
+    static constexpr std::size_t default_slab_size = 1 << 18;
+
+    explicit buffer_arena (std::size_t slab_size = default_slab_size)
+        : _slab_size (slab_size)
+        , _used (0)
+        , _in_use (0)
+    {}
+
+    ~buffer_arena ()
+    {
+        for (auto& s : _slabs)
+            _alloc.deallocate (s.data, s.size);
+    }
+
+    void* allocate (std::size_t bytes)
+    {
+        bytes = (bytes + alignment - 1) & ~(alignment - 1);
+
+        if (_slabs.empty () || _used + bytes > _slabs.back ().size)
+        {
+            // Big buffers get a slab of their own.
+            const std::size_t size = std::max (bytes, _slab_size);
+            _slabs.push_back (slab { _alloc.allocate (size), size });
+            _used = 0;
+        }
+
+        unsigned char* res = _slabs.back ().data + _used;
+        _used   += bytes;
+        _in_use += bytes;
+        return res;
+    }
+
+    void deallocate (void*, std::size_t bytes)
+    {
+        _in_use -= (bytes + alignment - 1) & ~(alignment - 1);
+    }
+
+    /** Bytes given to buffers that are still alive. */
+    std::size_t in_use () const
+    { return _in_use; }
+
+    std::size_t num_slabs () const
+    { return _slabs.size (); }
+
+private:
+    struct slab
+    {
+        unsigned char* data;
+        std::size_t    size;
+    };
+
+    aligned_allocator<unsigned char, alignment> _alloc;
+    std::vector<slab>        _slabs;
+    std::size_t              _slab_size;
+    std::size_t              _used;
+    std::atomic<std::size_t> _in_use;
+};
+
+typedef std::shared_ptr<buffer_arena> buffer_arena_ptr;
+
+/**
+ * An allocator taking memory from a buffer arena, which is kept alive
+ * while some memory from it is. Without arena it uses the heap,
+ * aligned as the arena.
+ */
+template <typename T>
+class arena_allocator
+{
+public:
+    typedef T              value_type;
+    typedef T*             pointer;
+    typedef const T*       const_pointer;
+    typedef T&             reference;
+    typedef const T&       const_reference;
+    typedef std::size_t    size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template <typename U>
+    struct rebind { typedef arena_allocator<U> other; };
+
+    arena_allocator (buffer_arena_ptr arena = buffer_arena_ptr ())
+        : _arena (arena)
+    {}
+
+    template <typename U>
+    arena_allocator (const arena_allocator<U>& other)
+        : _arena (other.arena ())
+    {}
+
+    const buffer_arena_ptr& arena () const
+    { return _arena; }
+
+    pointer allocate (size_type n, const void* = 0)
+    {
+        return _arena ?
+            (pointer) _arena->allocate (n * sizeof (T)) :
+            _heap.allocate (n);
+    }
+
+    void deallocate (pointer p, size_type n)
+    {
+        if (_arena)
+            _arena->deallocate (p, n * sizeof (T));
+        else
+            _heap.deallocate (p, n);
+    }
+
+    size_type max_size () const
+    { return _heap.max_size (); }
+
+    template <typename U, typename... Args>
+    void construct (U* p, Args&&... args)
+    { ::new ((void*) p) U (std::forward<Args> (args)...); }
+
+    template <typename U>
+    void destroy (U* p)
+    { p->~U (); }
+
+private:
+    buffer_arena_ptr _arena;
+    aligned_allocator<T, buffer_arena::alignment> _heap;
+};
+
+template <typename T, typename U>
+bool operator== (const arena_allocator<T>& a, const arena_allocator<U>& b)
+{ return a.arena () == b.arena (); }
+
+template <typename T, typename U>
+bool operator!= (const arena_allocator<T>& a, const arena_allocator<U>& b)
+{ return a.arena () != b.arena (); }
+
+template <typename T>
+struct allocator_alignment<arena_allocator<T> >
+    : public std::integral_constant<std::size_t, buffer_arena::alignment> {};
+
+} /* namespace sound */
+} /* namespace psynth */
+
+#endif /* PSYNTH_SOUND_BUFFER_ALLOCATOR_HPP_ */
@@ -266,7 +266,8 @@ template <typename Range>
 inline typename dynamic_step_type<Range>::type flipped_range (const Range& src)
 {
     typedef typename dynamic_step_type<Range>::type RRange;
-    return RRange (src.size (), make_step_iterator (src.end () - 1, -1));
+    return RRange (src.size (), make_step_iterator (
+                       src.end () - 1, -memunit_step (src.begin ())));
 }
 
 /**
@@ -0,0 +1,276 @@
+/**
+ *  Time-stamp:  <2011-07-17 20:14:02 raskolnikov>
+ *
+ *  @file        dither.hpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sun Jul 17 16:32:45 2011
+ *
+ *  Dithered conversion to integer samples.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_SOUND_DITHER_HPP
+#define PSYNTH_SOUND_DITHER_HPP
+
+#include <cassert>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+#include <boost/cstdint.hpp>
+#include <boost/mpl/bool.hpp>
+
+#include <psynth/base/compat.hpp>
+#include <psynth/sound/sample_algorithm.hpp>
+#include <psynth/sound/channel_convert.hpp>
+#include <psynth/sound/algorithm.hpp>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace psynth
+{
+namespace sound
+{
+
+enum class dither_mode
+{
+    none,   /**< Plain rounding, as copy_and_convert_frames. */
+    tpdf,   /**< Triangular noise of two steps peak to peak. */
+    shaped  /**< Triangular noise with the error pushed to the
+               high frequencies by a second order filter. */
+};
+
+/**
+ * Noise for dithering, with a triangular distribution in (-1, 1). It
+ * runs four xorshift generators at once, which is cheap enough for
+ * every output sample.
+ */
+class dither_noise
+{
+public:
+    explicit dither_noise (boost::uint32_t seed = 1)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            // Xorshift gets stuck in zero.
+            _state [i] = seed * 2654435761u + i * 0x9e3779b9u;
+            if (!_state [i])
+                _state [i] = 0x9e3779b9u;
+        }
+    }
+
+    /**
+     * Fills @a out with @a n noise values, where @a n is a multiple
+     * of four.
+     */
+    void generate (float* out, std::size_t n)
+    {
+#ifdef __SSE2__
+        __m128i s = _mm_loadu_si128 ((const __m128i*) _state);
+        const __m128i exponent = _mm_set1_epi32 (0x3f800000);
+
+        for (std::size_t i = 0; i < n; i += 4)
+        {
+            s = next (s);
+            const __m128 a = _mm_castsi128_ps (
+                _mm_or_si128 (_mm_srli_epi32 (s, 9), exponent));
+            s = next (s);
+            const __m128 b = _mm_castsi128_ps (
+                _mm_or_si128 (_mm_srli_epi32 (s, 9), exponent));
+            _mm_storeu_ps (out + i, _mm_sub_ps (a, b));
+        }
+
+        _mm_storeu_si128 ((__m128i*) _state, s);
+#else
+        for (std::size_t i = 0; i < n; i += 4)
+        {
+            float a [4], b [4];
+            for (int j = 0; j < 4; ++j)
+                a [j] = unit (_state [j] = next (_state [j]));
+            for (int j = 0; j < 4; ++j)
+                b [j] = unit (_state [j] = next (_state [j]));
+            for (int j = 0; j < 4; ++j)
+                out [i + j] = a [j] - b [j];
+        }
+#endif
+    }
+
+private:
+#ifdef __SSE2__
+    static PSYNTH_FORCEINLINE __m128i next (__m128i x)
+    {
+        x = _mm_xor_si128 (x, _mm_slli_epi32 (x, 13));
+        x = _mm_xor_si128 (x, _mm_srli_epi32 (x, 17));
+        return _mm_xor_si128 (x, _mm_slli_epi32 (x, 5));
+    }
+#else
+    static PSYNTH_FORCEINLINE boost::uint32_t next (boost::uint32_t x)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        return x ^ (x << 5);
+    }
+
+    /** Takes the high bits as the mantissa of a float in [1, 2). */
+    static PSYNTH_FORCEINLINE float unit (boost::uint32_t x)
+    {
+        const boost::uint32_t bits = (x >> 9) | 0x3f800000u;
+        float f;
+        std::memcpy (&f, &bits, sizeof (f));
+        return f;
+    }
+#endif
+
+    boost::uint32_t _state [4];
+};
+
+/**
+ * A converter for copying frames into integer samples with
+ * dither. It keeps the state of the noise between calls, so every
+ * stream must use its own converter.
+ *
+ * Other conversions, as well as the ones to 32 bit samples, where
+ * dither would be under the precision of a float, are just
+ * copy_and_convert_frames.
+ */
+class dither_converter
+{
+public:
+    static constexpr std::size_t max_channels = 8;
+
+    dither_converter (dither_mode mode = dither_mode::tpdf,
+                      boost::uint32_t seed = 1)
+        : _noise (seed)
+        , _mode (mode)
+    {
+        reset ();
+    }
+
+    dither_mode mode () const
+    { return _mode; }
+
+    void set_mode (dither_mode mode)
+    {
+        _mode = mode;
+        reset ();
+    }
+
+    /** Forgets the error of the noise shaping filter. */
+    void reset ()
+    {
+        std::fill (&_error [0][0], &_error [0][0] + max_channels * 2, 0.0f);
+    }
+
+    template <typename SrcRange, typename DstRange>
+    void operator () (const SrcRange& src, const DstRange& dst)
+    {
+        typedef typename sample_type<DstRange>::type dst_sample;
+        typedef boost::mpl::bool_<
+            std::is_integral<dst_sample>::value && sizeof (dst_sample) <= 2>
+            is_ditherable;
+
+        if (_mode == dither_mode::none)
+            copy_and_convert_frames (src, dst);
+        else
+            convert (src, dst, is_ditherable ());
+    }
+
+private:
+    static constexpr std::size_t block_size = 64;
+
+    template <typename SrcRange, typename DstRange>
+    void convert (const SrcRange& src, const DstRange& dst,
+                  boost::mpl::false_)
+    {
+        copy_and_convert_frames (src, dst);
+    }
+
+    template <typename SrcRange, typename DstRange>
+    void convert (const SrcRange& src, const DstRange& dst,
+                  boost::mpl::true_);
+
+    dither_noise _noise;
+    dither_mode  _mode;
+    float        _error [max_channels][2];
+    float        _dither [block_size * max_channels];
+};
+
+template <typename SrcRange, typename DstRange>
+void dither_converter::convert (const SrcRange& src, const DstRange& dst,
+                                boost::mpl::true_)
+{
+    typedef typename sample_type<DstRange>::type dst_sample;
+    typedef detail::sample_convert_from_unsigned<dst_sample> from_unsigned;
+    typedef typename from_unsigned::argument_type unsigned_sample;
+    typedef frame<bits32sf, typename DstRange::value_type::layout> float_frame;
+
+    const std::size_t channels = num_samples<DstRange>::value;
+    static_assert (num_samples<DstRange>::value <= max_channels,
+                   "too many channels for dithering");
+
+    // The same steps than the sample_converter, with the noise added
+    // before rounding, in the unsigned domain.
+    const float max    = float (sample_traits<unsigned_sample>::max_value ());
+    const bool  shaped = _mode == dither_mode::shaped;
+    const auto  fsrc   = channel_converted_range<float_frame> (src);
+    const std::size_t size = src.size ();
+
+    assert (src.size () == dst.size ());
+
+    for (std::size_t i = 0; i < size; i += block_size)
+    {
+        const std::size_t n = std::min (std::size_t (block_size), size - i);
+        _noise.generate (_dither, (n * channels + 3) & ~std::size_t (3));
+
+        const float* d = _dither;
+        for (std::size_t j = i; j < i + n; ++j)
+        {
+            const float_frame f = fsrc [j];
+            typename DstRange::reference out = dst [j];
+
+            for (std::size_t k = 0; k < channels; ++k, ++d)
+            {
+                const float x = std::min (std::max (float (f [k]), -1.0f), 1.0f);
+                float v = (x + 1.0f) * .5f * max;
+                if (shaped)
+                    v += _error [k][1] - 2.0f * _error [k][0];
+
+                const float q = std::floor (v + *d + 0.5f);
+                if (shaped)
+                {
+                    _error [k][1] = _error [k][0];
+                    _error [k][0] = q - v;
+                }
+
+                out [k] = from_unsigned () (
+                    unsigned_sample (std::min (std::max (q, 0.0f), max)));
+            }
+        }
+    }
+}
+
+} /* namespace sound */
+} /* namespace psynth */
+
+#endif /* PSYNTH_SOUND_DITHER_HPP */
@@ -386,7 +386,9 @@ public:
     };
 
     /**
-     * Fills a sample_buffer with data from the ring buffer.
+     * Fills a sample_buffer with data from the ring buffer. When the
+     * buffer is backwards the frames are read from the end of the
+     * block, so they come out in reading order.
      * @param r The reader pointer.
      * @param buf The buffer to fill with the data.
      * @param samples The number of samples to read.
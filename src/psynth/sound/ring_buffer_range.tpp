@@ -81,8 +81,27 @@ ring_buffer_range_base<R>::read (Position& r,
     const size_type slice = std::min (available (r), samples);
 
     if (is_backwards ())
+    {
+        // The block before the pointer is copied from its end so the
+        // frames come out in reading order.
         advance (r, -slice);
 
+        if (r._pos + slice > size ())
+        {
+            const size_type slice_one = size () - r._pos;
+            const size_type slice_two = slice - slice_one;
+            copy_frames (flipped_range (sub_range (_range, 0, slice_two)),
+                         sub_range (buf, 0, slice_two));
+            copy_frames (flipped_range (sub_range (_range, r._pos, slice_one)),
+                         sub_range (buf, slice_two, slice_one));
+        }
+        else
+            copy_frames (flipped_range (sub_range (_range, r._pos, slice)),
+                         sub_range (buf, 0, slice));
+
+        return slice;
+    }
+
     if (r._pos + slice > size ())
     {
 	const size_type slice_one = size () - r._pos;
@@ -96,8 +115,7 @@ ring_buffer_range_base<R>::read (Position& r,
 	copy_frames (sub_range (_range, r._pos, slice),
 		     sub_range (buf, 0, slice));
 
-    if (!is_backwards ())
-        advance (r, slice);
+    advance (r, slice);
 
     return slice;
 }
@@ -113,8 +131,31 @@ ring_buffer_range_base<R>::read_and_convert (Position& r,
     const size_type slice = std::min (available (r), samples);
 
     if (is_backwards ())
+    {
         advance (r, -slice);
 
+        if (r._pos + slice > size ())
+        {
+            const size_type slice_one = size () - r._pos;
+            const size_type slice_two = slice - slice_one;
+            copy_and_convert_frames (
+                flipped_range (sub_range (_range, 0, slice_two)),
+                sub_range (buf, 0, slice_two),
+                cc);
+            copy_and_convert_frames (
+                flipped_range (sub_range (_range, r._pos, slice_one)),
+                sub_range (buf, slice_two, slice_one),
+                cc);
+        }
+        else
+            copy_and_convert_frames (
+                flipped_range (sub_range (_range, r._pos, slice)),
+                sub_range (buf, 0, slice),
+                cc);
+
+        return slice;
+    }
+
     if (r._pos + slice > size ())
     {
 	const size_type slice_one = size () - r._pos;
@@ -131,8 +172,7 @@ ring_buffer_range_base<R>::read_and_convert (Position& r,
 				 sub_range (buf, 0, slice),
 				 cc);
 
-    if (!is_backwards ())
-        advance (r, slice);
+    advance (r, slice);
 
     return slice;
 }
@@ -186,7 +226,7 @@ void ring_buffer_range_base<R>::write_and_convert (const Range& buf,
     }
 
     if (is_backwards ())
-        advance (-nwrite);
+        advance (-slice);
 
     if (_writepos._pos + slice > size ())
     {
@@ -0,0 +1,640 @@
+/**
+ *  Time-stamp:  <2011-07-16 18:02:37 raskolnikov>
+ *
+ *  @file        simd_algorithm.hpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sat Jul 16 12:40:21 2011
+ *
+ *  Vectorized kernels for the frame algorithms on the most common
+ *  buffer types.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_SOUND_SIMD_ALGORITHM_HPP
+#define PSYNTH_SOUND_SIMD_ALGORITHM_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <boost/mpl/bool.hpp>
+
+#include <psynth/base/compat.hpp>
+#include <psynth/sound/sample.hpp>
+#include <psynth/sound/frame.hpp>
+#include <psynth/sound/planar_frame_iterator.hpp>
+#include <psynth/sound/stereo.hpp>
+#include <psynth/sound/metafunctions.hpp>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace psynth
+{
+namespace sound
+{
+
+struct default_channel_converter;
+
+namespace detail
+{
+
+/**
+ * Memory formats with a vectorized kernel. They are named after the
+ * iterator of a range, no matter its constness.
+ */
+struct no_simd_format {};
+struct stereo32sf_planar_simd_format {};
+struct stereo16s_simd_format {};
+struct stereo32s_simd_format {};
+
+template <typename Iterator>
+struct simd_format { typedef no_simd_format type; };
+
+#define PSYNTH_SOUND_DEFINE_SIMD_FORMAT(FORMAT, ...)                   \
+    template <> struct simd_format<__VA_ARGS__> { typedef FORMAT type; };
+
+PSYNTH_SOUND_DEFINE_SIMD_FORMAT (stereo32sf_planar_simd_format,
+                                 planar_frame_iterator<bits32sf*, stereo_space>)
+PSYNTH_SOUND_DEFINE_SIMD_FORMAT (stereo32sf_planar_simd_format,
+                                 planar_frame_iterator<const bits32sf*,
+                                                       stereo_space>)
+PSYNTH_SOUND_DEFINE_SIMD_FORMAT (stereo16s_simd_format,
+                                 frame<bits16s, stereo_layout>*)
+PSYNTH_SOUND_DEFINE_SIMD_FORMAT (stereo16s_simd_format,
+                                 const frame<bits16s, stereo_layout>*)
+PSYNTH_SOUND_DEFINE_SIMD_FORMAT (stereo32s_simd_format,
+                                 frame<bits32s, stereo_layout>*)
+PSYNTH_SOUND_DEFINE_SIMD_FORMAT (stereo32s_simd_format,
+                                 const frame<bits32s, stereo_layout>*)
+
+#undef PSYNTH_SOUND_DEFINE_SIMD_FORMAT
+
+/**
+ * Kernel copying frames from the @a Src format to the @a Dst format,
+ * converting them with the default_channel_converter. It is a
+ * boost::mpl::true_ when there is one, providing a static apply
+ * (src, dst) function taking the ranges.
+ */
+template <typename Src, typename Dst>
+struct simd_copy_and_convert : public boost::mpl::false_ {};
+
+/**
+ * Tells wether copy_and_convert_frames from @a Range1 to @a Range2
+ * with @a CC has a vectorized kernel.
+ */
+template <typename Range1, typename Range2, typename CC>
+struct has_simd_copy_and_convert : public boost::mpl::false_ {};
+
+template <typename Range1, typename Range2>
+struct has_simd_copy_and_convert<Range1, Range2, default_channel_converter>
+    : public simd_copy_and_convert<
+    typename simd_format<typename Range1::iterator>::type,
+    typename simd_format<typename Range2::iterator>::type>
+{};
+
+/**
+ * Dispatches to the vectorized kernel.
+ */
+template <typename Range1, typename Range2>
+PSYNTH_FORCEINLINE
+void simd_copy_and_convert_frames (const Range1& src, const Range2& dst)
+{
+    simd_copy_and_convert<
+        typename simd_format<typename Range1::iterator>::type,
+        typename simd_format<typename Range2::iterator>::type>::apply (
+            src, dst);
+}
+
+#ifdef __SSE2__
+
+template <int N, typename Iterator>
+PSYNTH_FORCEINLINE float* simd_plane (const Iterator& it)
+{
+    return reinterpret_cast<float*> (const_cast<bits32sf*> (at_c<N> (it)));
+}
+
+template <typename T, typename Iterator>
+PSYNTH_FORCEINLINE T* simd_frames (const Iterator& it)
+{
+    return reinterpret_cast<T*> (
+        const_cast<typename std::remove_const<
+            typename std::iterator_traits<Iterator>::value_type>::type*> (
+                &*it));
+}
+
+/*
+ *  The scalar versions follow the same steps than the
+ *  sample_converter's in sample_algorithm.hpp, so the results match
+ *  bit by bit, and the kernels use them for the last frames. The
+ *  input is clamped to [-1, 1], where the generic conversion does not
+ *  define the result.
+ */
+
+PSYNTH_FORCEINLINE float simd_clamp (float x)
+{
+    return x < -1.0f ? -1.0f : (x > 1.0f ? 1.0f : x);
+}
+
+PSYNTH_FORCEINLINE bits16s simd_float_to_s16 (float x)
+{
+    const float u = (simd_clamp (x) + 1.0f) * .5f;
+    return bits16s (int (u * 65535.0f + 0.5f) - 32768);
+}
+
+PSYNTH_FORCEINLINE bits32s simd_float_to_s32 (float x)
+{
+    const float u = (simd_clamp (x) + 1.0f) * .5f;
+    if (u >= 1.0f)
+        return 2147483647;
+    return bits32s (bits32 (u * 4294967295.0f + 0.5f) - 2147483648u);
+}
+
+PSYNTH_FORCEINLINE float simd_s16_to_float (bits16s x)
+{
+    return float (bits16 (x + 32768)) / 65535.0f * 2.0f - 1.0f;
+}
+
+PSYNTH_FORCEINLINE __m128 simd_clamp (__m128 x)
+{
+    return _mm_min_ps (_mm_max_ps (x, _mm_set1_ps (-1.0f)),
+                       _mm_set1_ps (1.0f));
+}
+
+PSYNTH_FORCEINLINE __m128 simd_to_unsigned (__m128 x)
+{
+    return _mm_mul_ps (_mm_add_ps (simd_clamp (x), _mm_set1_ps (1.0f)),
+                       _mm_set1_ps (.5f));
+}
+
+PSYNTH_FORCEINLINE __m128i simd_float_to_s16 (__m128 x)
+{
+    const __m128 t = _mm_add_ps (
+        _mm_mul_ps (simd_to_unsigned (x), _mm_set1_ps (65535.0f)),
+        _mm_set1_ps (0.5f));
+    return _mm_sub_epi32 (_mm_cvttps_epi32 (t), _mm_set1_epi32 (32768));
+}
+
+PSYNTH_FORCEINLINE __m128i simd_float_to_s32 (__m128 x)
+{
+    // There is only a signed conversion, so the upper half is
+    // converted after removing the offset, which is exact there.
+    const __m128 u    = simd_to_unsigned (x);
+    const __m128 t    = _mm_add_ps (_mm_mul_ps (u, _mm_set1_ps (4294967295.0f)),
+                                    _mm_set1_ps (0.5f));
+    const __m128 half = _mm_set1_ps (2147483648.0f);
+    const __m128i high_mask = _mm_castps_si128 (_mm_cmpge_ps (t, half));
+    const __m128i one_mask  = _mm_castps_si128 (
+        _mm_cmpge_ps (u, _mm_set1_ps (1.0f)));
+
+    const __m128i low  = _mm_sub_epi32 (_mm_cvttps_epi32 (t),
+                                        _mm_set1_epi32 (-2147483647 - 1));
+    const __m128i high = _mm_cvttps_epi32 (_mm_sub_ps (t, half));
+    const __m128i res  = _mm_or_si128 (_mm_and_si128 (high_mask, high),
+                                       _mm_andnot_si128 (high_mask, low));
+    return _mm_or_si128 (_mm_and_si128 (one_mask, _mm_set1_epi32 (0x7fffffff)),
+                         _mm_andnot_si128 (one_mask, res));
+}
+
+PSYNTH_FORCEINLINE __m128 simd_s32_to_float (__m128i x)
+{
+    const __m128 u = _mm_div_ps (
+        _mm_cvtepi32_ps (_mm_add_epi32 (x, _mm_set1_epi32 (32768))),
+        _mm_set1_ps (65535.0f));
+    return _mm_sub_ps (_mm_mul_ps (u, _mm_set1_ps (2.0f)),
+                       _mm_set1_ps (1.0f));
+}
+
+template <>
+struct simd_copy_and_convert<stereo32sf_planar_simd_format,
+                             stereo16s_simd_format>
+    : public boost::mpl::true_
+{
+    template <typename Range1, typename Range2>
+    static void apply (const Range1& src, const Range2& dst)
+    {
+        const float*   left  = simd_plane<0> (src.begin ());
+        const float*   right = simd_plane<1> (src.begin ());
+        bits16s*       out   = simd_frames<bits16s> (dst.begin ());
+        const std::size_t size = src.size ();
+
+        std::size_t i = 0;
+        for (; i + 8 <= size; i += 8, out += 16)
+        {
+            const __m128i l = _mm_packs_epi32 (
+                simd_float_to_s16 (_mm_loadu_ps (left + i)),
+                simd_float_to_s16 (_mm_loadu_ps (left + i + 4)));
+            const __m128i r = _mm_packs_epi32 (
+                simd_float_to_s16 (_mm_loadu_ps (right + i)),
+                simd_float_to_s16 (_mm_loadu_ps (right + i + 4)));
+            _mm_storeu_si128 ((__m128i*) out, _mm_unpacklo_epi16 (l, r));
+            _mm_storeu_si128 ((__m128i*) (out + 8), _mm_unpackhi_epi16 (l, r));
+        }
+        for (; i < size; ++i, out += 2)
+        {
+            out [0] = simd_float_to_s16 (left [i]);
+            out [1] = simd_float_to_s16 (right [i]);
+        }
+    }
+};
+
+template <>
+struct simd_copy_and_convert<stereo32sf_planar_simd_format,
+                             stereo32s_simd_format>
+    : public boost::mpl::true_
+{
+    template <typename Range1, typename Range2>
+    static void apply (const Range1& src, const Range2& dst)
+    {
+        const float*   left  = simd_plane<0> (src.begin ());
+        const float*   right = simd_plane<1> (src.begin ());
+        bits32s*       out   = simd_frames<bits32s> (dst.begin ());
+        const std::size_t size = src.size ();
+
+        std::size_t i = 0;
+        for (; i + 4 <= size; i += 4, out += 8)
+        {
+            const __m128i l = simd_float_to_s32 (_mm_loadu_ps (left + i));
+            const __m128i r = simd_float_to_s32 (_mm_loadu_ps (right + i));
+            _mm_storeu_si128 ((__m128i*) out, _mm_unpacklo_epi32 (l, r));
+            _mm_storeu_si128 ((__m128i*) (out + 4), _mm_unpackhi_epi32 (l, r));
+        }
+        for (; i < size; ++i, out += 2)
+        {
+            out [0] = simd_float_to_s32 (left [i]);
+            out [1] = simd_float_to_s32 (right [i]);
+        }
+    }
+};
+
+template <>
+struct simd_copy_and_convert<stereo16s_simd_format,
+                             stereo32sf_planar_simd_format>
+    : public boost::mpl::true_
+{
+    template <typename Range1, typename Range2>
+    static void apply (const Range1& src, const Range2& dst)
+    {
+        const bits16s* in    = simd_frames<bits16s> (src.begin ());
+        float*         left  = simd_plane<0> (dst.begin ());
+        float*         right = simd_plane<1> (dst.begin ());
+        const std::size_t size = src.size ();
+
+        std::size_t i = 0;
+        for (; i + 4 <= size; i += 4, in += 8)
+        {
+            const __m128i v  = _mm_loadu_si128 ((const __m128i*) in);
+            const __m128  lo = simd_s32_to_float (
+                _mm_srai_epi32 (_mm_unpacklo_epi16 (v, v), 16));
+            const __m128  hi = simd_s32_to_float (
+                _mm_srai_epi32 (_mm_unpackhi_epi16 (v, v), 16));
+            _mm_storeu_ps (left + i,  _mm_shuffle_ps (lo, hi, _MM_SHUFFLE (2, 0, 2, 0)));
+            _mm_storeu_ps (right + i, _mm_shuffle_ps (lo, hi, _MM_SHUFFLE (3, 1, 3, 1)));
+        }
+        for (; i < size; ++i, in += 2)
+        {
+            left [i]  = simd_s16_to_float (in [0]);
+            right [i] = simd_s16_to_float (in [1]);
+        }
+    }
+};
+
+#endif /* __SSE2__ */
+
+/**
+ * Memory layouts of the stereo ranges of plain samples, which
+ * copy_frames can shuffle without looking at the sample type.
+ */
+struct no_simd_layout {};
+struct interleaved_simd_layout {};
+struct planar_simd_layout {};
+
+/**
+ * Whether the samples of type @a T are stored as a single plain
+ * value, so the kernels can move them around as bytes. Scoped sample
+ * values, like bits32sf, only wrap their base value.
+ */
+template <typename T>
+struct simd_plain_sample : public std::is_arithmetic<T> {};
+
+template <typename B, typename Min, typename Max, typename Zero>
+struct simd_plain_sample<scoped_sample_value<B, Min, Max, Zero> >
+    : public std::integral_constant<
+    bool,
+    std::is_arithmetic<B>::value &&
+    sizeof (scoped_sample_value<B, Min, Max, Zero>) == sizeof (B)> {};
+
+template <typename Layout, typename Iterator,
+          typename T = typename sample_type<Iterator>::type>
+struct simd_layout_if
+{
+    typedef typename std::conditional<
+        num_samples<Iterator>::value == 2 &&
+        simd_plain_sample<T>::value &&
+        (sizeof (T) == 1 || sizeof (T) == 2 || sizeof (T) == 4),
+        Layout, no_simd_layout>::type type;
+};
+
+template <typename Iterator>
+struct simd_layout { typedef no_simd_layout type; };
+
+template <typename T, typename L>
+struct simd_layout<frame<T, L>*>
+    : public simd_layout_if<interleaved_simd_layout, frame<T, L>*> {};
+
+template <typename T, typename L>
+struct simd_layout<const frame<T, L>*>
+    : public simd_layout_if<interleaved_simd_layout, frame<T, L>*> {};
+
+template <typename T, typename C>
+struct simd_layout<planar_frame_iterator<T*, C> >
+    : public simd_layout_if<planar_simd_layout,
+                            planar_frame_iterator<T*, C> > {};
+
+template <typename T, typename C>
+struct simd_layout<planar_frame_iterator<const T*, C> >
+    : public simd_layout_if<planar_simd_layout,
+                            planar_frame_iterator<T*, C> > {};
+
+/**
+ * Kernel copying the samples of compatible ranges from the @a Src to
+ * the @a Dst layout, with a static apply (src, dst) function when it
+ * is a boost::mpl::true_. Copies between planar ranges are already a
+ * std::copy per plane.
+ */
+template <typename Src, typename Dst>
+struct simd_copy_samples : public boost::mpl::false_ {};
+
+template <typename Range1, typename Range2>
+struct has_simd_copy_samples : public simd_copy_samples<
+    typename simd_layout<typename Range1::iterator>::type,
+    typename simd_layout<typename Range2::iterator>::type>
+{};
+
+/** Address of the @a N semantic sample of the first frame. */
+template <int N, typename Iterator>
+PSYNTH_FORCEINLINE
+typename std::remove_const<typename sample_type<Iterator>::type>::type*
+simd_sample (const Iterator& it)
+{
+    typedef typename std::remove_const<
+        typename sample_type<Iterator>::type>::type sample;
+    return const_cast<sample*> (&semantic_at_c<N> (*it));
+}
+
+#ifdef __SSE2__
+
+/**
+ * Shuffles of vectors of samples of @a Size bytes. Deinterleaving
+ * takes two vectors of frames and returns the vector of even or odd
+ * samples.
+ */
+template <std::size_t Size>
+struct simd_shuffle;
+
+template <>
+struct simd_shuffle<1>
+{
+    static __m128i unpacklo (__m128i a, __m128i b)
+    { return _mm_unpacklo_epi8 (a, b); }
+    static __m128i unpackhi (__m128i a, __m128i b)
+    { return _mm_unpackhi_epi8 (a, b); }
+    static __m128i even (__m128i a, __m128i b)
+    {
+        const __m128i mask = _mm_set1_epi16 (0x00ff);
+        return _mm_packus_epi16 (_mm_and_si128 (a, mask),
+                                 _mm_and_si128 (b, mask));
+    }
+    static __m128i odd (__m128i a, __m128i b)
+    {
+        return _mm_packus_epi16 (_mm_srli_epi16 (a, 8),
+                                 _mm_srli_epi16 (b, 8));
+    }
+    static __m128i swap (__m128i a)
+    { return _mm_or_si128 (_mm_slli_epi16 (a, 8), _mm_srli_epi16 (a, 8)); }
+};
+
+template <>
+struct simd_shuffle<2>
+{
+    static __m128i unpacklo (__m128i a, __m128i b)
+    { return _mm_unpacklo_epi16 (a, b); }
+    static __m128i unpackhi (__m128i a, __m128i b)
+    { return _mm_unpackhi_epi16 (a, b); }
+    static __m128i even (__m128i a, __m128i b)
+    {
+        // Sign extended so the saturation never happens.
+        return _mm_packs_epi32 (_mm_srai_epi32 (_mm_slli_epi32 (a, 16), 16),
+                                _mm_srai_epi32 (_mm_slli_epi32 (b, 16), 16));
+    }
+    static __m128i odd (__m128i a, __m128i b)
+    {
+        return _mm_packs_epi32 (_mm_srai_epi32 (a, 16),
+                                _mm_srai_epi32 (b, 16));
+    }
+    static __m128i swap (__m128i a)
+    {
+        return _mm_shufflehi_epi16 (
+            _mm_shufflelo_epi16 (a, _MM_SHUFFLE (2, 3, 0, 1)),
+            _MM_SHUFFLE (2, 3, 0, 1));
+    }
+};
+
+template <>
+struct simd_shuffle<4>
+{
+    static __m128i unpacklo (__m128i a, __m128i b)
+    { return _mm_unpacklo_epi32 (a, b); }
+    static __m128i unpackhi (__m128i a, __m128i b)
+    { return _mm_unpackhi_epi32 (a, b); }
+    static __m128i even (__m128i a, __m128i b)
+    {
+        return _mm_castps_si128 (
+            _mm_shuffle_ps (_mm_castsi128_ps (a), _mm_castsi128_ps (b),
+                            _MM_SHUFFLE (2, 0, 2, 0)));
+    }
+    static __m128i odd (__m128i a, __m128i b)
+    {
+        return _mm_castps_si128 (
+            _mm_shuffle_ps (_mm_castsi128_ps (a), _mm_castsi128_ps (b),
+                            _MM_SHUFFLE (3, 1, 3, 1)));
+    }
+    static __m128i swap (__m128i a)
+    { return _mm_shuffle_epi32 (a, _MM_SHUFFLE (2, 3, 0, 1)); }
+};
+
+#endif /* __SSE2__ */
+
+/*
+ *  The kernels work on the physical order of the samples, the apply
+ *  functions find out which semantic channel goes where. They handle
+ *  one vector of frames per step and finish the last frames one by
+ *  one.
+ */
+
+template <typename T>
+void simd_interleave (const T* first, const T* second, T* out,
+                      std::size_t size)
+{
+    std::size_t i = 0;
+#ifdef __SSE2__
+    typedef simd_shuffle<sizeof (T)> shuffle;
+    const std::size_t step = 16 / sizeof (T);
+    for (; i + step <= size; i += step, out += 2 * step)
+    {
+        const __m128i a = _mm_loadu_si128 ((const __m128i*) (first + i));
+        const __m128i b = _mm_loadu_si128 ((const __m128i*) (second + i));
+        _mm_storeu_si128 ((__m128i*) out, shuffle::unpacklo (a, b));
+        _mm_storeu_si128 ((__m128i*) (out + step), shuffle::unpackhi (a, b));
+    }
+#endif
+    for (; i < size; ++i, out += 2)
+    {
+        out [0] = first [i];
+        out [1] = second [i];
+    }
+}
+
+template <typename T>
+void simd_deinterleave (const T* in, T* first, T* second,
+                        std::size_t size)
+{
+    std::size_t i = 0;
+#ifdef __SSE2__
+    typedef simd_shuffle<sizeof (T)> shuffle;
+    const std::size_t step = 16 / sizeof (T);
+    for (; i + step <= size; i += step, in += 2 * step)
+    {
+        const __m128i a = _mm_loadu_si128 ((const __m128i*) in);
+        const __m128i b = _mm_loadu_si128 ((const __m128i*) (in + step));
+        _mm_storeu_si128 ((__m128i*) (first + i), shuffle::even (a, b));
+        _mm_storeu_si128 ((__m128i*) (second + i), shuffle::odd (a, b));
+    }
+#endif
+    for (; i < size; ++i, in += 2)
+    {
+        first [i]  = in [0];
+        second [i] = in [1];
+    }
+}
+
+template <typename T>
+void simd_swap_samples (const T* in, T* out, std::size_t size)
+{
+    std::size_t i = 0;
+#ifdef __SSE2__
+    typedef simd_shuffle<sizeof (T)> shuffle;
+    const std::size_t step = 16 / sizeof (T) / 2;
+    for (; i + step <= size; i += step, in += 2 * step, out += 2 * step)
+        _mm_storeu_si128 ((__m128i*) out, shuffle::swap (
+                              _mm_loadu_si128 ((const __m128i*) in)));
+#endif
+    for (; i < size; ++i, in += 2, out += 2)
+    {
+        out [0] = in [1];
+        out [1] = in [0];
+    }
+}
+
+template <>
+struct simd_copy_samples<interleaved_simd_layout, interleaved_simd_layout>
+    : public boost::mpl::true_
+{
+    template <typename Range1, typename Range2>
+    static void apply (const Range1& src, const Range2& dst)
+    {
+        const std::size_t size = src.size ();
+        if (!size)
+            return;
+
+        const auto s0 = simd_sample<0> (src.begin ());
+        const auto s1 = simd_sample<1> (src.begin ());
+        const auto d0 = simd_sample<0> (dst.begin ());
+        const auto d1 = simd_sample<1> (dst.begin ());
+
+        if ((s0 < s1) == (d0 < d1))
+            std::copy (std::min (s0, s1), std::min (s0, s1) + 2 * size,
+                       std::min (d0, d1));
+        else
+            simd_swap_samples (std::min (s0, s1), std::min (d0, d1), size);
+    }
+};
+
+template <>
+struct simd_copy_samples<planar_simd_layout, interleaved_simd_layout>
+    : public boost::mpl::true_
+{
+    template <typename Range1, typename Range2>
+    static void apply (const Range1& src, const Range2& dst)
+    {
+        const std::size_t size = src.size ();
+        if (!size)
+            return;
+
+        const auto s0 = simd_sample<0> (src.begin ());
+        const auto s1 = simd_sample<1> (src.begin ());
+        const auto d0 = simd_sample<0> (dst.begin ());
+        const auto d1 = simd_sample<1> (dst.begin ());
+
+        if (d0 < d1)
+            simd_interleave (s0, s1, d0, size);
+        else
+            simd_interleave (s1, s0, d1, size);
+    }
+};
+
+template <>
+struct simd_copy_samples<interleaved_simd_layout, planar_simd_layout>
+    : public boost::mpl::true_
+{
+    template <typename Range1, typename Range2>
+    static void apply (const Range1& src, const Range2& dst)
+    {
+        const std::size_t size = src.size ();
+        if (!size)
+            return;
+
+        const auto s0 = simd_sample<0> (src.begin ());
+        const auto s1 = simd_sample<1> (src.begin ());
+        const auto d0 = simd_sample<0> (dst.begin ());
+        const auto d1 = simd_sample<1> (dst.begin ());
+
+        if (s0 < s1)
+            simd_deinterleave (s0, d0, d1, size);
+        else
+            simd_deinterleave (s1, d1, d0, size);
+    }
+};
+
+template <typename Range1, typename Range2>
+PSYNTH_FORCEINLINE
+void simd_copy_samples_frames (const Range1& src, const Range2& dst)
+{
+    has_simd_copy_samples<Range1, Range2>::apply (src, dst);
+}
+
+} /* namespace detail */
+} /* namespace sound */
+} /* namespace psynth */
+
+#endif /* PSYNTH_SOUND_SIMD_ALGORITHM_HPP */
@@ -0,0 +1,254 @@
+/**
+ *  Time-stamp:  <2011-07-02 18:21:40 raskolnikov>
+ *
+ *  @file        spsc_ring_buffer_range.hpp
+ *  @author      Juan Pedro Bolivar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sat Jul  2 16:03:12 2011
+ *
+ *  Single producer, single consumer lock-free ring buffer range.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolivar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_SOUND_SPSC_RING_BUFFER_RANGE_H_
+#define PSYNTH_SOUND_SPSC_RING_BUFFER_RANGE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <boost/noncopyable.hpp>
+
+#include <psynth/sound/metafunctions.hpp>
+#include <psynth/sound/buffer_range.hpp>
+#include <psynth/sound/buffer_allocator.hpp>
+
+namespace psynth
+{
+namespace sound
+{
+
+class default_channel_converter;
+
+/**
+ * A ring buffer range that can be safely shared by exactly one
+ * writer thread and exactly one reader thread without any locking.
+ *
+ * Unlike @c ring_buffer_range, the writer never overwrites data that
+ * has not been read yet and there is only one implicit reader. The
+ * reader and writer positions are kept as monotonic frame counters:
+ * the writer publishes new data with a release store of the write
+ * counter, that the reader acquires before touching the frames, and
+ * the other way around for the freed space. Every operation is wait
+ * free.
+ *
+ * Producer side functions are @c write_available (), @c write () and
+ * @c write_and_convert (). Consumer side functions are @c
+ * read_available (), @c read (), @c read_and_convert (), @c
+ * sub_buffer_one (), @c sub_buffer_two () and @c consume (). The
+ * rest of the interface is not thread safe.
+ */
+template <typename Range>
+class spsc_ring_buffer_range : public boost::noncopyable
+{
+public:
+    typedef Range range;
+
+    typedef typename Range::size_type       size_type;
+    typedef typename Range::difference_type difference_type;
+
+    spsc_ring_buffer_range ()
+	: _write_count (0)
+	, _read_count (0)
+    {}
+
+    explicit spsc_ring_buffer_range (const Range& range)
+	: _write_count (0)
+	, _read_count (0)
+	, _range (range)
+    {}
+
+    /**
+     * Changes the underlying storage and discards all the data in the
+     * buffer. Not thread safe.
+     */
+    void reset (const Range& range)
+    {
+	_range = range;
+	reset ();
+    }
+
+    /**
+     * Discards all the data in the buffer. Not thread safe.
+     */
+    void reset ()
+    {
+	_write_count.store (0, std::memory_order_relaxed);
+	_read_count.store (0, std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns the size of the buffer.
+     */
+    size_type size () const
+    { return _range.size (); }
+
+    /**
+     * Returns the number of frames that the consumer can read.
+     */
+    size_type read_available () const
+    {
+	return _write_count.load (std::memory_order_acquire) -
+	    _read_count.load (std::memory_order_relaxed);
+    }
+
+    /**
+     * Returns the number of frames that the producer can write
+     * without overwriting unread data.
+     */
+    size_type write_available () const
+    {
+	return size () - (_write_count.load (std::memory_order_relaxed) -
+			  _read_count.load (std::memory_order_acquire));
+    }
+
+    /**
+     * Returns the first of the two contiguous pieces holding the next
+     * @a slice readable frames.
+     */
+    typename buffer_range_type<Range>::type
+    sub_buffer_one (size_type slice) const;
+
+    /**
+     * Returns the second of the two contiguous pieces holding the
+     * next @a slice readable frames. It is empty when the data does
+     * not wrap around the end of the buffer.
+     */
+    typename buffer_range_type<Range>::type
+    sub_buffer_two (size_type slice) const;
+
+    /**
+     * Releases @a n frames to the producer after they have been read
+     * through @c sub_buffer_one and @c sub_buffer_two.
+     */
+    void consume (size_type n)
+    {
+	_read_count.store (_read_count.load (std::memory_order_relaxed) + n,
+			   std::memory_order_release);
+    }
+
+    /**
+     * Fills @a range with as many frames as available.
+     * @return The number of frames read.
+     */
+    template <class Range2>
+    size_type read (const Range2& range)
+    { return read (range, range.size ()); }
+
+    /**
+     * Reads at most @a samples frames into @a range.
+     * @return The number of frames read.
+     */
+    template <class Range2>
+    size_type read (const Range2& range, size_type samples);
+
+    template <class Range2, class CC = default_channel_converter>
+    size_type read_and_convert (const Range2& range, CC cc = CC ())
+    { return read_and_convert (range, range.size (), cc); }
+
+    template <class Range2, class CC = default_channel_converter>
+    size_type read_and_convert (const Range2& range, size_type samples,
+				CC cc = CC ());
+
+    /**
+     * Writes as much of @a range as fits in the buffer.
+     * @return The number of frames written.
+     */
+    template <class Range2>
+    size_type write (const Range2& range)
+    { return write (range, range.size ()); }
+
+    /**
+     * Writes at most @a samples frames of @a range. Frames that do not
+     * fit are dropped.
+     * @return The number of frames written.
+     */
+    template <class Range2>
+    size_type write (const Range2& range, size_type samples);
+
+    template <class Range2, class CC = default_channel_converter>
+    size_type write_and_convert (const Range2& range, CC cc = CC ())
+    { return write_and_convert (range, range.size (), cc); }
+
+    template <class Range2, class CC = default_channel_converter>
+    size_type write_and_convert (const Range2& range, size_type samples,
+				 CC cc = CC ());
+
+    /**
+     * Sets to zero all the contents of the buffer. Not thread safe.
+     */
+    void zero ()
+    {
+	fill_frames (_range, 0);
+    }
+
+private:
+    template <class Range2, class Op>
+    size_type read_impl (const Range2& range, size_type samples, Op op);
+
+    template <class Range2, class Op>
+    size_type write_impl (const Range2& range, size_type samples, Op op);
+
+    size_type offset (std::size_t count) const
+    { return count % size (); }
+
+    /*
+     * Keep the counters in different cache lines so the producer and
+     * consumer do not invalidate each other on every operation. A
+     * whole line of padding works wherever the object was allocated.
+     */
+    std::atomic<std::size_t> _write_count;
+    char                     _write_padding [cache_line_size];
+    std::atomic<std::size_t> _read_count;
+    char                     _read_padding [cache_line_size];
+    Range                    _range;
+};
+
+template <typename Range>
+struct sample_type<spsc_ring_buffer_range<Range> > :
+    public sample_type<Range> {};
+
+template <typename Range>
+struct channel_space_type<spsc_ring_buffer_range<Range> > :
+    public channel_space_type<Range> {};
+
+template <typename Range>
+struct sample_mapping_type<spsc_ring_buffer_range<Range> > :
+    public sample_mapping_type<Range> {};
+
+template <typename Range>
+struct is_planar<spsc_ring_buffer_range<Range> > :
+    public is_planar<Range> {};
+
+} /* namespace sound */
+} /* namespace psynth */
+
+#include <psynth/sound/spsc_ring_buffer_range.tpp>
+
+#endif /* PSYNTH_SOUND_SPSC_RING_BUFFER_RANGE_H_ */
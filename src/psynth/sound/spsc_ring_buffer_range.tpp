@@ -0,0 +1,198 @@
+/**
+ *  Time-stamp:  <2011-07-02 18:21:44 raskolnikov>
+ *
+ *  @file        spsc_ring_buffer_range.tpp
+ *  @author      Juan Pedro Bolivar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sat Jul  2 16:05:30 2011
+ *
+ *  Single producer, single consumer ring buffer implementation.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolivar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_SOUND_SPSC_RING_BUFFER_RANGE_TPP_
+#define PSYNTH_SOUND_SPSC_RING_BUFFER_RANGE_TPP_
+
+#include <cassert>
+#include <algorithm>
+
+#include <psynth/sound/buffer_range_factory.hpp>
+
+namespace psynth
+{
+namespace sound
+{
+
+namespace detail
+{
+
+struct spsc_copy_op
+{
+    template <class Src, class Dst>
+    void operator () (const Src& src, const Dst& dst) const
+    { copy_frames (src, dst); }
+};
+
+template <class CC>
+struct spsc_convert_op
+{
+    spsc_convert_op (CC cc) : _cc (cc) {}
+
+    template <class Src, class Dst>
+    void operator () (const Src& src, const Dst& dst) const
+    { copy_and_convert_frames (src, dst, _cc); }
+
+    CC _cc;
+};
+
+} /* namespace detail */
+
+template <class R>
+typename buffer_range_type<R>::type
+spsc_ring_buffer_range<R>::sub_buffer_one (size_type slice) const
+{
+    assert (slice <= read_available ());
+    const size_type pos = offset (_read_count.load (std::memory_order_relaxed));
+
+    if (pos + slice > size ())
+	return sub_range (_range, pos, size () - pos);
+    else
+	return sub_range (_range, pos, slice);
+}
+
+template <class R>
+typename buffer_range_type<R>::type
+spsc_ring_buffer_range<R>::sub_buffer_two (size_type slice) const
+{
+    assert (slice <= read_available ());
+    const size_type pos = offset (_read_count.load (std::memory_order_relaxed));
+
+    if (pos + slice > size ())
+	return sub_range (_range, 0, pos + slice - size ());
+    else
+	return sub_range (_range, pos + slice, 0);
+}
+
+template <class R>
+template <class Range, class Op>
+typename spsc_ring_buffer_range<R>::size_type
+spsc_ring_buffer_range<R>::read_impl (const Range& buf,
+				      size_type samples,
+				      Op op)
+{
+    const std::size_t rcount = _read_count.load (std::memory_order_relaxed);
+    const size_type slice = std::min<size_type> (
+	_write_count.load (std::memory_order_acquire) - rcount, samples);
+
+    if (slice <= 0)
+	return 0;
+
+    const size_type pos = offset (rcount);
+    if (pos + slice > size ())
+    {
+	const size_type slice_one = size () - pos;
+	const size_type slice_two = slice - slice_one;
+	op (sub_range (_range, pos, slice_one),
+	    sub_range (buf, 0, slice_one));
+	op (sub_range (_range, 0, slice_two),
+	    sub_range (buf, slice_one, slice_two));
+    }
+    else
+	op (sub_range (_range, pos, slice),
+	    sub_range (buf, 0, slice));
+
+    _read_count.store (rcount + slice, std::memory_order_release);
+    return slice;
+}
+
+template <class R>
+template <class Range, class Op>
+typename spsc_ring_buffer_range<R>::size_type
+spsc_ring_buffer_range<R>::write_impl (const Range& buf,
+				       size_type samples,
+				       Op op)
+{
+    const std::size_t wcount = _write_count.load (std::memory_order_relaxed);
+    const size_type slice = std::min<size_type> (
+	size () - (wcount - _read_count.load (std::memory_order_acquire)),
+	samples);
+
+    if (slice <= 0)
+	return 0;
+
+    const size_type pos = offset (wcount);
+    if (pos + slice > size ())
+    {
+	const size_type slice_one = size () - pos;
+	const size_type slice_two = slice - slice_one;
+	op (sub_range (buf, 0, slice_one),
+	    sub_range (_range, pos, slice_one));
+	op (sub_range (buf, slice_one, slice_two),
+	    sub_range (_range, 0, slice_two));
+    }
+    else
+	op (sub_range (buf, 0, slice),
+	    sub_range (_range, pos, slice));
+
+    _write_count.store (wcount + slice, std::memory_order_release);
+    return slice;
+}
+
+template <class R>
+template <class Range>
+typename spsc_ring_buffer_range<R>::size_type
+spsc_ring_buffer_range<R>::read (const Range& buf, size_type samples)
+{
+    return read_impl (buf, samples, detail::spsc_copy_op ());
+}
+
+template <class R>
+template <class Range, class CC>
+typename spsc_ring_buffer_range<R>::size_type
+spsc_ring_buffer_range<R>::read_and_convert (const Range& buf,
+					     size_type samples,
+					     CC cc)
+{
+    return read_impl (buf, samples, detail::spsc_convert_op<CC> (cc));
+}
+
+template <class R>
+template <class Range>
+typename spsc_ring_buffer_range<R>::size_type
+spsc_ring_buffer_range<R>::write (const Range& buf, size_type samples)
+{
+    return write_impl (buf, samples, detail::spsc_copy_op ());
+}
+
+template <class R>
+template <class Range, class CC>
+typename spsc_ring_buffer_range<R>::size_type
+spsc_ring_buffer_range<R>::write_and_convert (const Range& buf,
+					      size_type samples,
+					      CC cc)
+{
+    return write_impl (buf, samples, detail::spsc_convert_op<CC> (cc));
+}
+
+} /* namespace sound */
+} /* namespace psynth */
+
+#endif /* PSYNTH_SOUND_SPSC_RING_BUFFER_RANGE_TPP_ */
@@ -60,6 +60,8 @@
     template <typename, bool, typename>     class buffer;		\
     template <typename>              class ring_buffer_range;		\
     template <typename>              class ring_buffer;			\
+    template <typename>              class spsc_ring_buffer_range;	\
+    template <typename>              class spsc_ring_buffer;		\
     typedef frame<bits##T, LAYOUT >         CS##T##_frame;		\
     typedef const frame<bits##T, LAYOUT >   CS##T##c_frame;		\
     typedef frame<bits##T, LAYOUT >&        CS##T##_ref;		\
@@ -78,7 +80,9 @@
     CS##T##_buffer;							\
     typedef ring_buffer_range<CS##T##_range> CS##T##_ring_range;	\
     typedef ring_buffer_range<CS##T##c_range> CS##T##c_ring_range;	\
-    typedef ring_buffer<CS##T##_buffer> CS##T##_ring_buffer;
+    typedef ring_buffer<CS##T##_buffer> CS##T##_ring_buffer;		\
+    typedef spsc_ring_buffer_range<CS##T##_range> CS##T##_spsc_ring_range; \
+    typedef spsc_ring_buffer<CS##T##_buffer> CS##T##_spsc_ring_buffer;
 
 // CS = 'bgr' CS_FULL = 'rgb' LAYOUT='bgr_layout'
 #define PSYNTH_SOUND_DEFINE_ALL_TYPEDEFS_INTERNAL(T,CS,CS_FULL,LAYOUT)	\
@@ -107,7 +111,11 @@
     CS##T##_planar_buffer;						\
     typedef ring_buffer_range<CS##T##_planar_range> CS##T##_planar_ring_range; \
     typedef ring_buffer_range<CS##T##c_planar_range> CS##T##c_planar_ring_range; \
-    typedef ring_buffer<CS##T##_planar_buffer> CS##T##_planar_ring_buffer;
+    typedef ring_buffer<CS##T##_planar_buffer> CS##T##_planar_ring_buffer; \
+    typedef spsc_ring_buffer_range<CS##T##_planar_range>		\
+    CS##T##_planar_spsc_ring_range;					\
+    typedef spsc_ring_buffer<CS##T##_planar_buffer>			\
+    CS##T##_planar_spsc_ring_buffer;
 
 
 #define PSYNTH_SOUND_DEFINE_BASE_TYPEDEFS(T,CS)        \
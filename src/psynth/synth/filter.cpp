@@ -20,6 +20,11 @@
  *                                                                         *
  ***************************************************************************/
 
+#include <cstring>
+#if defined (__SSE__)
+#include <xmmintrin.h>
+#endif
+
 #include "synth/filter.hpp"
 
 namespace psynth
@@ -30,7 +35,6 @@ namespace psynth
  */
 
 #define tMax(a,b) ((a) > (b) ? (a) : (b))
-#define tLimit(x,a,b) ((x) < (a) ? (a) : ((x) > (b)? (b) : (x)))
 
 void filter_values::calculate (float freq)
 {
@@ -56,6 +60,10 @@ void filter_values::calculate (type type, float freq, float res, float srate)
 
 void filter_values::calculate ()
 {
+    /* Stop any sweep in progress */
+    m_d_b0a0 = m_d_b1a0 = m_d_b2a0 = m_d_a1a0 = m_d_a2a0 = 0.0f;
+    m_d_r = m_d_p = m_d_k = 0.0f;
+
     if(m_type == MOOG) {
 	// [0, 0.5]
 	const float f = m_freq / m_srate;
@@ -118,64 +126,184 @@ void filter_values::calculate ()
     }
 }
 
-#define m_b0a0 m_coef->m_b0a0
-#define m_b1a0 m_coef->m_b1a0
-#define m_b2a0 m_coef->m_b2a0
-#define m_a1a0 m_coef->m_a1a0
-#define m_a2a0 m_coef->m_a2a0
-#define m_r m_coef->m_r
-#define m_p m_coef->m_p
-#define m_k m_coef->m_k
+void filter_values::sweep (float freq, int steps)
+{
+    const filter_values from = *this;
+    const float inv_steps = 1.0f / tMax(steps, 1);
+
+    calculate (freq);
+
+    m_d_b0a0 = (m_b0a0 - from.m_b0a0) * inv_steps;
+    m_d_b1a0 = (m_b1a0 - from.m_b1a0) * inv_steps;
+    m_d_b2a0 = (m_b2a0 - from.m_b2a0) * inv_steps;
+    m_d_a1a0 = (m_a1a0 - from.m_a1a0) * inv_steps;
+    m_d_a2a0 = (m_a2a0 - from.m_a2a0) * inv_steps;
+    m_d_r = (m_r - from.m_r) * inv_steps;
+    m_d_p = (m_p - from.m_p) * inv_steps;
+    m_d_k = (m_k - from.m_k) * inv_steps;
+
+    m_b0a0 = from.m_b0a0;
+    m_b1a0 = from.m_b1a0;
+    m_b2a0 = from.m_b2a0;
+    m_a1a0 = from.m_a1a0;
+    m_a2a0 = from.m_a2a0;
+    m_r = from.m_r;
+    m_p = from.m_p;
+    m_k = from.m_k;
+}
 
-sample filter::update (sample _in0)
+sample filter::update (sample in)
 {
-    sample out;
+    sample* out_ptr = &in;
+    const sample* in_ptr = &in;
 
-    switch(m_coef->m_type)
-    {
-    case filter_values::MOOG: {
-	sample x = _in0 - m_r*m_y4;
-
-	// four cascaded onepole filters
-	// (bilinear transform)
-	m_y1 = tLimit(( x + m_oldx ) * m_p - m_k * m_y1,
-		      -10.0f, 10.0f );
-	m_y2 = tLimit(( m_y1 + m_oldy1 ) * m_p - m_k * m_y2,
-		      -10.0f, 10.0f );
-	m_y3 = tLimit(( m_y2 + m_oldy2 ) * m_p - m_k * m_y3,
-		      -10.0f, 10.0f );
-	m_y4 = tLimit(( m_y3 + m_oldy3 ) * m_p - m_k * m_y4,
-		      -10.0f, 10.0f );
-
-	m_oldx = x;
-	m_oldy1 = m_y1;
-	m_oldy2 = m_y2;
-	m_oldy3 = m_y3;
-
-	out = m_y4 - m_y4 * m_y4 *
-	    m_y4 * ( 1.0f / 6.0f );
+    process (&in_ptr, &out_ptr, 1, 1);
+    return in;
+}
 
-	break;
-    }
+/*
+ * One lane per channel. The unused lanes just filter silence.
+ */
+typedef float filter_lanes
+__attribute__ ((vector_size (filter::max_channels * sizeof (float))));
 
-    default:
-	// filter
-	out = m_b0a0 * _in0 +
-	    m_b1a0 * m_in1 +
-	    m_b2a0 * m_in2 -
-	    m_a1a0 * m_ou1 -
-	    m_a2a0 * m_ou2;
-
-	// push in/out buffers
-	m_in2 = m_in1;
-	m_in1 = _in0;
-	m_ou2 = m_ou1;
-
-	m_ou1 = out;
-	break;
+static inline filter_lanes load_lanes (const float* src)
+{
+    filter_lanes v;
+    std::memcpy (&v, src, sizeof (v));
+    return v;
+}
+
+static inline void store_lanes (float* dst, filter_lanes v)
+{
+    std::memcpy (dst, &v, sizeof (v));
+}
+
+/*
+ * Building the lanes from scalars directly, instead of writing them
+ * one by one, lets the compiler keep them in registers.
+ */
+static inline filter_lanes gather_lanes (const sample* const* in,
+					 std::size_t channels, std::size_t i)
+{
+    switch (channels) {
+    case 1:  return filter_lanes { in[0][i], 0, 0, 0 };
+    case 2:  return filter_lanes { in[0][i], in[1][i], 0, 0 };
+    case 3:  return filter_lanes { in[0][i], in[1][i], in[2][i], 0 };
+    default: return filter_lanes { in[0][i], in[1][i], in[2][i], in[3][i] };
     }
+}
+
+static inline filter_lanes limit_lanes (filter_lanes v)
+{
+#if defined (__SSE__)
+    return _mm_min_ps (_mm_max_ps (v, _mm_set1_ps (-10.0f)),
+		       _mm_set1_ps (10.0f));
+#else
+    const filter_lanes lo = filter_lanes {} - 10.0f;
+    const filter_lanes hi = filter_lanes {} + 10.0f;
+    v = v < lo ? lo : v;
+    return v > hi ? hi : v;
+#endif
+}
+
+void filter::process (const sample* const* in, sample* const* out,
+		      std::size_t channels, std::size_t n_samples)
+{
+    filter_values& c = *m_coef;
+
+    if (c.m_type == filter_values::MOOG) {
+	float r = c.m_r, p = c.m_p, k = c.m_k;
+	filter_lanes y1 = load_lanes (m_state.y1);
+	filter_lanes y2 = load_lanes (m_state.y2);
+	filter_lanes y3 = load_lanes (m_state.y3);
+	filter_lanes y4 = load_lanes (m_state.y4);
+	filter_lanes oldx = load_lanes (m_state.oldx);
+	filter_lanes oldy1 = load_lanes (m_state.oldy1);
+	filter_lanes oldy2 = load_lanes (m_state.oldy2);
+	filter_lanes oldy3 = load_lanes (m_state.oldy3);
+
+	for (std::size_t i = 0; i < n_samples; ++i) {
+	    const filter_lanes x = gather_lanes (in, channels, i) - r * y4;
+
+	    // four cascaded onepole filters
+	    // (bilinear transform)
+	    y1 = limit_lanes (( x + oldx ) * p - k * y1);
+	    y2 = limit_lanes (( y1 + oldy1 ) * p - k * y2);
+	    y3 = limit_lanes (( y2 + oldy2 ) * p - k * y3);
+	    y4 = limit_lanes (( y3 + oldy3 ) * p - k * y4);
+
+	    oldx = x;
+	    oldy1 = y1;
+	    oldy2 = y2;
+	    oldy3 = y3;
 
-    return out;
+	    const filter_lanes y = y4 - y4 * y4 * y4 * ( 1.0f / 6.0f );
+
+	    for (std::size_t l = 0; l < channels; ++l)
+		out[l][i] = y[l];
+
+	    r += c.m_d_r;
+	    p += c.m_d_p;
+	    k += c.m_d_k;
+	}
+
+	store_lanes (m_state.y1, y1);
+	store_lanes (m_state.y2, y2);
+	store_lanes (m_state.y3, y3);
+	store_lanes (m_state.y4, y4);
+	store_lanes (m_state.oldx, oldx);
+	store_lanes (m_state.oldy1, oldy1);
+	store_lanes (m_state.oldy2, oldy2);
+	store_lanes (m_state.oldy3, oldy3);
+
+	c.m_r = r;
+	c.m_p = p;
+	c.m_k = k;
+    } else {
+	float b0 = c.m_b0a0, b1 = c.m_b1a0, b2 = c.m_b2a0;
+	float a1 = c.m_a1a0, a2 = c.m_a2a0;
+	filter_lanes in1 = load_lanes (m_state.in1);
+	filter_lanes in2 = load_lanes (m_state.in2);
+	filter_lanes ou1 = load_lanes (m_state.ou1);
+	filter_lanes ou2 = load_lanes (m_state.ou2);
+
+	for (std::size_t i = 0; i < n_samples; ++i) {
+	    const filter_lanes x = gather_lanes (in, channels, i);
+	    const filter_lanes y =
+		b0 * x +
+		b1 * in1 +
+		b2 * in2 -
+		a1 * ou1 -
+		a2 * ou2;
+
+	    // push in/out buffers
+	    in2 = in1;
+	    in1 = x;
+	    ou2 = ou1;
+	    ou1 = y;
+
+	    for (std::size_t l = 0; l < channels; ++l)
+		out[l][i] = y[l];
+
+	    b0 += c.m_d_b0a0;
+	    b1 += c.m_d_b1a0;
+	    b2 += c.m_d_b2a0;
+	    a1 += c.m_d_a1a0;
+	    a2 += c.m_d_a2a0;
+	}
+
+	store_lanes (m_state.in1, in1);
+	store_lanes (m_state.in2, in2);
+	store_lanes (m_state.ou1, ou1);
+	store_lanes (m_state.ou2, ou2);
+
+	c.m_b0a0 = b0;
+	c.m_b1a0 = b1;
+	c.m_b2a0 = b2;
+	c.m_a1a0 = a1;
+	c.m_a2a0 = a2;
+    }
 }
 
 } /* namespace psynth */
@@ -23,8 +23,10 @@
 #ifndef PSYNTH_FILTER_H
 #define PSYNTH_FILTER_H
 
+#include <psynth/sound/frame.hpp>
 #include <psynth/synth/audio_info.hpp>
 #include <cmath>
+#include <cstddef>
 
 namespace psynth
 {
@@ -47,6 +49,10 @@ private:
     float m_b0a0, m_b1a0, m_b2a0, m_a1a0, m_a2a0; // filter coeffs
     float m_r, m_p, m_k; // coeffs for moog-filter
 
+    // per step change of the coeffs during a sweep
+    float m_d_b0a0, m_d_b1a0, m_d_b2a0, m_d_a1a0, m_d_a2a0;
+    float m_d_r, m_d_p, m_d_k;
+
     type m_type;
     float m_freq;
     float m_res;
@@ -56,7 +62,11 @@ public:
     filter_values (type type = LOWPASS,
 		   float freq = 220.0f,
 		   float res = 0.1f,
-		   float srate = 44100.0f) {
+		   float srate = 44100.0f) :
+	m_b0a0(0), m_b1a0(0), m_b2a0(0), m_a1a0(0), m_a2a0(0),
+	m_r(0), m_p(0), m_k(0),
+	m_d_b0a0(0), m_d_b1a0(0), m_d_b2a0(0), m_d_a1a0(0), m_d_a2a0(0),
+	m_d_r(0), m_d_p(0), m_d_k(0) {
 	calculate (type, freq, res, srate);
     }
 
@@ -64,6 +74,15 @@ public:
     void calculate (float freq);
     void calculate ();
 
+    /**
+     * Prepares a linear sweep of the coefficients from their current
+     * values to the ones for the cutoff @a freq, which are reached
+     * after filtering @a steps frames. This is much cheaper than
+     * calculating the coefficients for every sample when the cutoff
+     * is modulated.
+     */
+    void sweep (float freq, int steps);
+
     type get_type () {
 	return m_type;
     };
@@ -79,27 +98,39 @@ public:
 
 class filter
 {
+public:
+    /**
+     * Number of channels that process () can filter at once. Each
+     * channel is kept in one lane of the state so all of them go
+     * through the same vectorizable pipeline.
+     */
+    static constexpr std::size_t max_channels = 4;
+
+private:
+    typedef sample lanes [max_channels];
+
+    struct state {
+	/*
+	  in/out history
+	*/
+	lanes ou1, ou2, in1, in2;
+
+	/*
+	  in/out history for moog-filter
+	*/
+	lanes y1, y2, y3, y4, oldx, oldy1, oldy2, oldy3;
+    };
+
     filter_values* m_coef;
     bool m_local_coef;
-    /*
-      in/out history
-    */
-    sample m_ou1, m_ou2, m_in1, m_in2;
+    state m_state;
 
-    /*
-      in/out history for moog-filter
-    */
-    sample m_y1, m_y2, m_y3, m_y4, m_oldx, m_oldy1, m_oldy2, m_oldy3;
+    void process (const sample* const* in, sample* const* out,
+		  std::size_t channels, std::size_t n_samples);
 
 public:
     filter(filter_values* coef = 0) :
-	m_coef(coef), m_local_coef(false),
-	m_ou1(0), m_ou2(0),
-	m_in1(0), m_in2(0),
-	m_y1(0), m_y2(0),
-	m_y3(0), m_y4(0),
-	m_oldx(0),
-	m_oldy1(0), m_oldy2(0), m_oldy3(0) {
+	m_coef(coef), m_local_coef(false), m_state() {
 	if (!m_coef) {
 	    m_coef = new filter_values;
 	    m_local_coef = true;
@@ -108,12 +139,7 @@ public:
 
     filter(const filter& f) :
 	m_coef(f.m_coef), m_local_coef(f.m_local_coef),
-	m_ou1(f.m_ou1), m_ou2(f.m_ou2),
-	m_in1(f.m_in1), m_in2(f.m_in2),
-	m_y1(f.m_y1), m_y2(f.m_y2),
-	m_y3(f.m_y3), m_y4(f.m_y4),
-	m_oldx(f.m_oldx),
-	m_oldy1(f.m_oldy1), m_oldy2(f.m_oldy2), m_oldy3(f.m_oldy3) {
+	m_state(f.m_state) {
 	if (f.m_local_coef) {
 	    m_coef = new filter_values;
 	    *m_coef = *f.m_coef;
@@ -122,20 +148,12 @@ public:
 
     filter& operator= (const filter& f) {
 	if (this != &f) {
+	    if (m_local_coef)
+		delete m_coef;
+
 	    m_coef = f.m_coef;
 	    m_local_coef = f.m_local_coef;
-	    m_ou1 = f.m_ou1;
-	    m_ou2 = f.m_ou2;
-	    m_in1 = f.m_in1;
-	    m_in2 = f.m_in2;
-	    m_y1 = f.m_y1;
-	    m_y2 = f.m_y2;
-	    m_y3 = f.m_y3;
-	    m_y4 = f.m_y4;
-	    m_oldx = f.m_oldx;
-	    m_oldy1 = f.m_oldy1;
-	    m_oldy2 = f.m_oldy2;
-	    m_oldy3 = f.m_oldy3;
+	    m_state = f.m_state;
 
 	    if (f.m_local_coef) {
 		m_coef = new filter_values;
@@ -159,7 +177,37 @@ public:
 	m_coef = coef;
 	}*/
 
+    /**
+     * Filters one sample of the first channel.
+     */
     sample update (sample x);
+
+    /**
+     * Filters every channel of @a in into @a out, which may be the
+     * same range. Each channel must be a contiguous block of samples,
+     * as in planar or mono ranges. When the coefficients are being
+     * swept they are stepped once per frame.
+     */
+    template <class ConstRange, class Range>
+    void process (const ConstRange& in, const Range& out) {
+	typedef typename Range::value_type frame_type;
+	constexpr std::size_t channels =
+	    sound::num_samples<frame_type>::value;
+	static_assert (channels <= max_channels,
+		       "Too many channels for the filter.");
+
+	if (out.size () == 0)
+	    return;
+
+	const sample* in_ptr [channels];
+	sample* out_ptr [channels];
+	for (std::size_t i = 0; i < channels; ++i) {
+	    in_ptr [i] = (const sample*) &in [0][i];
+	    out_ptr [i] = (sample*) &out [0][i];
+	}
+
+	process (in_ptr, out_ptr, channels, out.size ());
+    }
 };
 
 } /* namespace psynth */
@@ -0,0 +1,148 @@
+/**
+ *  Time-stamp:  <2011-07-06 19:40:12 raskolnikov>
+ *
+ *  @file        mip_wave_table.cpp
+ *  @author      Juan Pedro Bolivar Puente <raskolnikov@es.gnu.org>
+ *  @date        Wed Jul  6 17:10:31 2011
+ *
+ *  Band-limited wave tables, one per octave.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolivar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cassert>
+#include <cmath>
+#include <complex>
+
+#include "synth/mip_wave_table.hpp"
+
+namespace psynth
+{
+namespace synth
+{
+
+namespace
+{
+
+typedef std::complex<double> complex;
+
+/**
+ * In place radix-2 FFT, without normalization. @a sign is -1 for the
+ * forward transform and 1 for the inverse.
+ */
+void fft (std::vector<complex>& x, int sign)
+{
+    const std::size_t n = x.size ();
+
+    for (std::size_t i = 1, j = 0; i < n; ++i)
+    {
+        std::size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap (x [i], x [j]);
+    }
+
+    for (std::size_t len = 2; len <= n; len <<= 1)
+    {
+        const double angle = sign * 2 * M_PI / len;
+        const complex step (std::cos (angle), std::sin (angle));
+        for (std::size_t i = 0; i < n; i += len)
+        {
+            complex w (1);
+            for (std::size_t k = 0; k < len / 2; ++k)
+            {
+                const complex a = x [i + k];
+                const complex b = x [i + k + len / 2] * w;
+                x [i + k] = a + b;
+                x [i + k + len / 2] = a - b;
+                w *= step;
+            }
+        }
+    }
+}
+
+bool is_power_of_two (std::size_t x)
+{
+    return x && !(x & (x - 1));
+}
+
+} /* anonymous namespace */
+
+void mip_wave_table::build (const std::vector<float>& wave)
+{
+    assert (is_power_of_two (_size) && _size >= 4);
+    assert (is_power_of_two (wave.size ()) && wave.size () >= _size);
+
+    unsigned size_bits = 0;
+    while ((std::size_t (1) << size_bits) < _size)
+        ++ size_bits;
+
+    _frac_bits  = 32 - size_bits;
+    _frac_mask  = (phase_type (1) << _frac_bits) - 1;
+    _frac_scale = 1.0f / (phase_type (1) << _frac_bits);
+    _levels     = size_bits - 1;
+    _data.resize (_levels * (_size + 1));
+
+    std::vector<complex> spectrum (wave.begin (), wave.end ());
+    fft (spectrum, -1);
+
+    const std::size_t m = spectrum.size ();
+    std::vector<complex> level (_size);
+
+    for (std::size_t l = 0; l < _levels; ++l)
+    {
+        const std::size_t harmonics = (_size / 4) >> l;
+
+        std::fill (level.begin (), level.end (), complex ());
+        level [0] = spectrum [0];
+        for (std::size_t h = 1; h <= harmonics; ++h)
+        {
+            level [h]         = spectrum [h];
+            level [_size - h] = spectrum [m - h];
+        }
+        fft (level, 1);
+
+        float* dst = &_data [l * (_size + 1)];
+        for (std::size_t i = 0; i < _size; ++i)
+            dst [i] = level [i].real () / m;
+        dst [_size] = dst [0];
+    }
+}
+
+std::size_t mip_wave_table::level (float speed) const
+{
+    const float limit = 0.5f / std::fabs (speed);
+    std::size_t l = 0;
+    while (l + 1 < _levels && ((_size / 4) >> l) > limit)
+        ++ l;
+    return l;
+}
+
+mip_wave_table::phase_type mip_wave_table::to_phase (float x)
+{
+    const double cycles = x;
+    return to_increment (cycles - std::floor (cycles));
+}
+
+} /* namespace synth */
+} /* namespace psynth */
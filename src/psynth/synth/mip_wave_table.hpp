@@ -0,0 +1,135 @@
+/**
+ *  Time-stamp:  <2011-07-06 19:40:12 raskolnikov>
+ *
+ *  @file        mip_wave_table.hpp
+ *  @author      Juan Pedro Bolivar Puente <raskolnikov@es.gnu.org>
+ *  @date        Wed Jul  6 17:02:45 2011
+ *
+ *  Band-limited wave tables, one per octave.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolivar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_SYNTH_MIP_WAVE_TABLE_H_
+#define PSYNTH_SYNTH_MIP_WAVE_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace psynth
+{
+namespace synth
+{
+
+/**
+ * A set of band-limited versions of a waveform. Level @c n keeps the
+ * harmonics below <tt>size () / 4 >> n</tt>, so there is one level
+ * per octave and an oscillator can pick the one whose harmonics
+ * stay below the Nyquist frequency.
+ *
+ * The phase of the lookups is a 32 bit fixed point number, so it
+ * wraps around for free.
+ */
+class mip_wave_table
+{
+public:
+    typedef std::uint32_t phase_type;
+
+    static const std::size_t default_size = 1 << 12;
+
+    /**
+     * Builds the tables from the function @a func, taking the phase
+     * in [0, 1) and returning the waveform. @a size must be a power
+     * of two.
+     */
+    template <class Func>
+    explicit mip_wave_table (Func func, std::size_t size = default_size);
+
+    std::size_t size () const
+    { return _size; }
+
+    std::size_t levels () const
+    { return _levels; }
+
+    /**
+     * Returns the level to use when advancing @a speed cycles per
+     * frame.
+     */
+    std::size_t level (float speed) const;
+
+    /**
+     * Returns the samples of a level. They are one longer than
+     * size (), the last one repeats the first.
+     */
+    const float* table (std::size_t level) const
+    { return &_data [level * (_size + 1)]; }
+
+    /**
+     * Number of low bits of a phase that are the interpolation
+     * fraction, the high bits are the index in the table.
+     */
+    unsigned frac_bits () const
+    { return _frac_bits; }
+
+    /**
+     * Interpolates the value at @a phase in @a table.
+     */
+    float get (const float* table, phase_type phase) const
+    {
+        const phase_type index = phase >> _frac_bits;
+        const float alpha = (phase & _frac_mask) * _frac_scale;
+        return table [index] + alpha * (table [index + 1] - table [index]);
+    }
+
+    /** Converts a phase in cycles to fixed point. */
+    static phase_type to_phase (float x);
+
+    /** Converts a phase in fixed point to cycles in [0, 1). */
+    static float from_phase (phase_type phase)
+    { return phase * (1.0f / 4294967296.0f); }
+
+    /**
+     * Converts a phase increment in cycles to fixed point. Negative
+     * and large increments are fine as long as they fit in 31 bits of
+     * cycles.
+     */
+    static phase_type to_increment (float speed)
+    { return static_cast<phase_type> (
+            static_cast<std::int64_t> (speed * 4294967296.0)); }
+
+private:
+    void build (const std::vector<float>& wave);
+
+    std::size_t        _size;
+    std::size_t        _levels;
+    unsigned           _frac_bits;
+    phase_type         _frac_mask;
+    float              _frac_scale;
+    std::vector<float> _data;
+};
+
+} /* namespace synth */
+} /* namespace psynth */
+
+#include <psynth/synth/mip_wave_table.tpp>
+
+#endif /* PSYNTH_SYNTH_MIP_WAVE_TABLE_H_ */
@@ -0,0 +1,61 @@
+/**
+ *  Time-stamp:  <2011-07-06 19:40:12 raskolnikov>
+ *
+ *  @file        mip_wave_table.tpp
+ *  @author      Juan Pedro Bolivar Puente <raskolnikov@es.gnu.org>
+ *  @date        Wed Jul  6 17:05:12 2011
+ *
+ *  Band-limited wave tables, one per octave.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolivar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_SYNTH_MIP_WAVE_TABLE_TPP_
+#define PSYNTH_SYNTH_MIP_WAVE_TABLE_TPP_
+
+#include <psynth/synth/mip_wave_table.hpp>
+
+namespace psynth
+{
+namespace synth
+{
+
+/**
+ * The waveform is sampled this many times finer than the tables, so
+ * that the harmonics we keep are not affected by the aliasing of
+ * sampling a discontinuous function.
+ */
+const std::size_t mip_wave_table_oversampling = 4;
+
+template <class Func>
+mip_wave_table::mip_wave_table (Func func, std::size_t size)
+    : _size (size)
+{
+    std::vector<float> wave (size * mip_wave_table_oversampling);
+    for (std::size_t i = 0; i < wave.size (); ++i)
+        wave [i] = func (static_cast<float> (i) / wave.size ());
+    build (wave);
+}
+
+} /* namespace synth */
+} /* namespace psynth */
+
+#endif /* PSYNTH_SYNTH_MIP_WAVE_TABLE_TPP_ */
@@ -0,0 +1,170 @@
+/**
+ *  Time-stamp:  <2011-07-05 20:14:18 raskolnikov>
+ *
+ *  @file        mix.cpp
+ *  @author      Juan Pedro Bolivar Puente <raskolnikov@es.gnu.org>
+ *  @date        Tue Jul  5 18:21:37 2011
+ *
+ *  Mixing kernels for the baseline instruction set and runtime
+ *  dispatch.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolivar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#elif defined (__ARM_NEON) || defined (__ARM_NEON__)
+#define PSYNTH_MIX_NEON 1
+#include <arm_neon.h>
+#endif
+
+#include "synth/mix_kernel.tpp"
+
+namespace psynth
+{
+namespace synth
+{
+
+namespace
+{
+
+struct mix_vec_scalar
+{
+    typedef float type;
+    static constexpr std::size_t width = 1;
+
+    static type load (const float* p)  { return *p; }
+    static void store (float* p, type x) { *p = x; }
+    static type set1 (float x)  { return x; }
+    static type add (type a, type b) { return a + b; }
+    static type mul (type a, type b) { return a * b; }
+    static type min (type a, type b) { return b < a ? b : a; }
+    static type max (type a, type b) { return a < b ? b : a; }
+    static type lanes () { return 0.0f; }
+};
+
+#if defined (__SSE2__)
+
+struct mix_vec_sse2
+{
+    typedef __m128 type;
+    static constexpr std::size_t width = 4;
+
+    static type load (const float* p)  { return _mm_loadu_ps (p); }
+    static void store (float* p, type x) { _mm_storeu_ps (p, x); }
+    static type set1 (float x)  { return _mm_set1_ps (x); }
+    static type add (type a, type b) { return _mm_add_ps (a, b); }
+    static type mul (type a, type b) { return _mm_mul_ps (a, b); }
+    static type min (type a, type b) { return _mm_min_ps (a, b); }
+    static type max (type a, type b) { return _mm_max_ps (a, b); }
+    static type lanes () { return _mm_setr_ps (0.0f, 1.0f, 2.0f, 3.0f); }
+};
+
+#elif defined (PSYNTH_MIX_NEON)
+
+struct mix_vec_neon
+{
+    typedef float32x4_t type;
+    static constexpr std::size_t width = 4;
+
+    static type load (const float* p)  { return vld1q_f32 (p); }
+    static void store (float* p, type x) { vst1q_f32 (p, x); }
+    static type set1 (float x)  { return vdupq_n_f32 (x); }
+    static type add (type a, type b) { return vaddq_f32 (a, b); }
+    static type mul (type a, type b) { return vmulq_f32 (a, b); }
+    static type min (type a, type b) { return vminq_f32 (a, b); }
+    static type max (type a, type b) { return vmaxq_f32 (a, b); }
+    static type lanes ()
+    {
+        static const float l [4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+        return vld1q_f32 (l);
+    }
+};
+
+#endif
+
+const detail::mix_kernel_table& select_mix_kernels ()
+{
+#if defined (__SSE2__)
+    static const auto baseline = make_mix_kernel_table<mix_vec_sse2> ("sse2");
+#elif defined (PSYNTH_MIX_NEON)
+    static const auto baseline = make_mix_kernel_table<mix_vec_neon> ("neon");
+#else
+    static const auto baseline = make_mix_kernel_table<mix_vec_scalar> ("scalar");
+#endif
+
+#ifdef PSYNTH_HAVE_MIX_AVX2
+    if (__builtin_cpu_supports ("avx2"))
+        return detail::mix_kernels_avx2 ();
+#endif
+
+    return baseline;
+}
+
+const detail::mix_kernel_table& mix_kernels ()
+{
+    static const detail::mix_kernel_table& table = select_mix_kernels ();
+    return table;
+}
+
+detail::mix_fn mix_kernel_for (mix_op op, bool mod, bool env)
+{
+    return mix_kernels ().fn [int (op)] [mod + 2 * env];
+}
+
+} /* anonymous namespace */
+
+void mix_block (mix_op op, float* dst, const float* src,
+                float gain, std::size_t n)
+{
+    mix_kernel_for (op, false, false) (
+        dst, src, 0, gain, mix_ramp {1.0f, 0.0f}, mix_ramp {1.0f, 0.0f}, n);
+}
+
+void mix_block (mix_op op, float* dst, const float* src,
+                const float* mod, float gain, std::size_t n)
+{
+    mix_kernel_for (op, true, false) (
+        dst, src, mod, gain, mix_ramp {1.0f, 0.0f}, mix_ramp {1.0f, 0.0f}, n);
+}
+
+void mix_block (mix_op op, float* dst, const float* src,
+                float gain, mix_ramp env, std::size_t n)
+{
+    mix_kernel_for (op, false, true) (
+        dst, src, 0, gain, mix_ramp {1.0f, 0.0f}, env, n);
+}
+
+void mix_block (mix_op op, float* dst, const float* src,
+                const float* mod, float gain,
+                mix_ramp mod_env, mix_ramp env, std::size_t n)
+{
+    mix_kernel_for (op, true, true) (
+        dst, src, mod, gain, mod_env, env, n);
+}
+
+const char* mix_block_isa ()
+{
+    return mix_kernels ().name;
+}
+
+} /* namespace synth */
+} /* namespace psynth */
@@ -0,0 +1,96 @@
+/**
+ *  Time-stamp:  <2011-07-05 20:14:02 raskolnikov>
+ *
+ *  @file        mix.hpp
+ *  @author      Juan Pedro Bolivar Puente <raskolnikov@es.gnu.org>
+ *  @date        Tue Jul  5 17:32:51 2011
+ *
+ *  Vectorized mixing kernels.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolivar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_SYNTH_MIX_H_
+#define PSYNTH_SYNTH_MIX_H_
+
+#include <cstddef>
+
+namespace psynth
+{
+namespace synth
+{
+
+/**
+ * How a source is combined into the destination.
+ */
+enum class mix_op
+{
+    sum,     /**< dst += src * gain */
+    product, /**< dst *= src * gain */
+    assign   /**< dst = src * gain, the first source of a mix. */
+};
+
+/**
+ * A linear ramp clamped to [0, 1], as produced by an envelope that
+ * does not change direction during a block. Sample @c i of the ramp
+ * is <tt>start + i * delta</tt>.
+ */
+struct mix_ramp
+{
+    float start;
+    float delta;
+};
+
+/**
+ * Mixes @a n samples of @a src into @a dst scaled by @a gain.
+ */
+void mix_block (mix_op op, float* dst, const float* src,
+                float gain, std::size_t n);
+
+/**
+ * Mixes @a src scaled by <tt>gain + gain * mod[i]</tt>.
+ */
+void mix_block (mix_op op, float* dst, const float* src,
+                const float* mod, float gain, std::size_t n);
+
+/**
+ * Mixes @a src scaled by @a gain and the @a env ramp.
+ */
+void mix_block (mix_op op, float* dst, const float* src,
+                float gain, mix_ramp env, std::size_t n);
+
+/**
+ * Mixes @a src scaled by <tt>gain + gain * mod[i] * mod_env[i]</tt>
+ * and the @a env ramp.
+ */
+void mix_block (mix_op op, float* dst, const float* src,
+                const float* mod, float gain,
+                mix_ramp mod_env, mix_ramp env, std::size_t n);
+
+/**
+ * Name of the instruction set of the kernels chosen for this CPU.
+ */
+const char* mix_block_isa ();
+
+} /* namespace synth */
+} /* namespace psynth */
+
+#endif /* PSYNTH_SYNTH_MIX_H_ */
@@ -0,0 +1,74 @@
+/**
+ *  Time-stamp:  <2011-07-05 20:14:25 raskolnikov>
+ *
+ *  @file        mix_avx2.cpp
+ *  @author      Juan Pedro Bolivar Puente <raskolnikov@es.gnu.org>
+ *  @date        Tue Jul  5 18:58:03 2011
+ *
+ *  AVX2 mixing kernels. This file is compiled with AVX2 enabled, the
+ *  kernels are only used when the CPU supports it.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolivar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <immintrin.h>
+
+#include "synth/mix_kernel.tpp"
+
+namespace psynth
+{
+namespace synth
+{
+
+namespace
+{
+
+struct mix_vec_avx2
+{
+    typedef __m256 type;
+    static constexpr std::size_t width = 8;
+
+    static type load (const float* p)  { return _mm256_loadu_ps (p); }
+    static void store (float* p, type x) { _mm256_storeu_ps (p, x); }
+    static type set1 (float x)  { return _mm256_set1_ps (x); }
+    static type add (type a, type b) { return _mm256_add_ps (a, b); }
+    static type mul (type a, type b) { return _mm256_mul_ps (a, b); }
+    static type min (type a, type b) { return _mm256_min_ps (a, b); }
+    static type max (type a, type b) { return _mm256_max_ps (a, b); }
+    static type lanes ()
+    { return _mm256_setr_ps (0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f); }
+};
+
+} /* anonymous namespace */
+
+namespace detail
+{
+
+const mix_kernel_table& mix_kernels_avx2 ()
+{
+    static const auto table = make_mix_kernel_table<mix_vec_avx2> ("avx2");
+    return table;
+}
+
+} /* namespace detail */
+
+} /* namespace synth */
+} /* namespace psynth */
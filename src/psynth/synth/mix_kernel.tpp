@@ -0,0 +1,188 @@
+/**
+ *  Time-stamp:  <2011-07-05 20:14:10 raskolnikov>
+ *
+ *  @file        mix_kernel.tpp
+ *  @author      Juan Pedro Bolivar Puente <raskolnikov@es.gnu.org>
+ *  @date        Tue Jul  5 17:50:12 2011
+ *
+ *  Mixing kernels, generic over the vector instruction set.
+ *
+ *  This is only meant to be included by the translation units that
+ *  implement the kernels for one instruction set. Everything that is
+ *  instantiated here must have internal linkage, otherwise the linker
+ *  could pick code built for a instruction set that the CPU lacks.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolivar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_SYNTH_MIX_KERNEL_TPP_
+#define PSYNTH_SYNTH_MIX_KERNEL_TPP_
+
+#include <psynth/synth/mix.hpp>
+
+namespace psynth
+{
+namespace synth
+{
+namespace detail
+{
+
+typedef void (*mix_fn) (float* dst, const float* src, const float* mod,
+                        float gain, mix_ramp mod_env, mix_ramp env,
+                        std::size_t n);
+
+/**
+ * The kernels for one instruction set, indexed by the operation and
+ * by <tt>modulated + 2 * enveloped</tt>.
+ */
+struct mix_kernel_table
+{
+    const char* name;
+    mix_fn      fn [3][4];
+};
+
+const mix_kernel_table& mix_kernels_avx2 ();
+
+} /* namespace detail */
+
+namespace
+{
+
+/*
+ * Vector traits V provide a type, its width, and load, store, set1,
+ * add, mul, min, max and lanes (0, 1, 2...) operations.
+ */
+
+template <class V>
+typename V::type mix_ramp_value (typename V::type idx,
+                                 typename V::type start,
+                                 typename V::type delta)
+{
+    return V::min (V::max (V::add (start, V::mul (idx, delta)),
+                           V::set1 (0.0f)),
+                   V::set1 (1.0f));
+}
+
+float mix_ramp_value (float idx, float start, float delta)
+{
+    const float val = start + idx * delta;
+    return val < 0.0f ? 0.0f : val > 1.0f ? 1.0f : val;
+}
+
+/*
+ * The operations are done in the same order as in the scalar code
+ * that these kernels replaced, so that the results do not change
+ * when the gains are constant.
+ */
+template <class V, mix_op Op, bool Mod, bool Env>
+void mix_kernel (float* dst, const float* src, const float* mod,
+                 float gain, mix_ramp mod_env, mix_ramp env,
+                 std::size_t n)
+{
+    typedef typename V::type vec;
+
+    const vec vgain      = V::set1 (gain);
+    const vec vmod_start = V::set1 (mod_env.start);
+    const vec vmod_delta = V::set1 (mod_env.delta);
+    const vec venv_start = V::set1 (env.start);
+    const vec venv_delta = V::set1 (env.delta);
+    const vec vwidth     = V::set1 (float (V::width));
+
+    vec idx = V::lanes ();
+    std::size_t i = 0;
+
+    for (; i + V::width <= n; i += V::width)
+    {
+        vec x = V::load (src + i);
+
+        if (Mod)
+        {
+            vec m = V::mul (vgain, V::load (mod + i));
+            if (Env)
+                m = V::mul (m, mix_ramp_value<V> (idx, vmod_start, vmod_delta));
+            x = V::mul (x, V::add (vgain, m));
+        }
+        else
+            x = V::mul (x, vgain);
+
+        if (Env)
+            x = V::mul (x, mix_ramp_value<V> (idx, venv_start, venv_delta));
+
+        if (Op == mix_op::assign)
+            V::store (dst + i, x);
+        else
+        {
+            const vec d = V::load (dst + i);
+            V::store (dst + i, Op == mix_op::sum ? V::add (d, x) : V::mul (d, x));
+        }
+        idx = V::add (idx, vwidth);
+    }
+
+    for (; i < n; ++i)
+    {
+        float x = src [i];
+
+        if (Mod)
+        {
+            float m = gain * mod [i];
+            if (Env)
+                m = m * mix_ramp_value (float (i), mod_env.start, mod_env.delta);
+            x = x * (gain + m);
+        }
+        else
+            x = x * gain;
+
+        if (Env)
+            x = x * mix_ramp_value (float (i), env.start, env.delta);
+
+        dst [i] =
+            Op == mix_op::assign ? x :
+            Op == mix_op::sum    ? dst [i] + x : dst [i] * x;
+    }
+}
+
+template <class V>
+detail::mix_kernel_table make_mix_kernel_table (const char* name)
+{
+    return detail::mix_kernel_table {
+        name, {
+            { &mix_kernel<V, mix_op::sum, false, false>,
+              &mix_kernel<V, mix_op::sum, true,  false>,
+              &mix_kernel<V, mix_op::sum, false, true>,
+              &mix_kernel<V, mix_op::sum, true,  true> },
+            { &mix_kernel<V, mix_op::product, false, false>,
+              &mix_kernel<V, mix_op::product, true,  false>,
+              &mix_kernel<V, mix_op::product, false, true>,
+              &mix_kernel<V, mix_op::product, true,  true> },
+            { &mix_kernel<V, mix_op::assign, false, false>,
+              &mix_kernel<V, mix_op::assign, true,  false>,
+              &mix_kernel<V, mix_op::assign, false, true>,
+              &mix_kernel<V, mix_op::assign, true,  true> }
+        }
+    };
+}
+
+} /* anonymous namespace */
+
+} /* namespace synth */
+} /* namespace psynth */
+
+#endif /* PSYNTH_SYNTH_MIX_KERNEL_TPP_ */
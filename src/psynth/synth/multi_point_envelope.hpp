@@ -38,9 +38,11 @@
 #define PSYNTH_SYNTH_MULTI_POINT_ENVELOPE_H
 
 #include <vector>
+#include <algorithm>
 #include <psynth/sound/forwards.hpp>
 #include <psynth/sound/algorithm.hpp>
 #include <psynth/synth/envelope.hpp>
+#include <psynth/synth/util.hpp>
 
 namespace psynth
 {
@@ -122,9 +124,10 @@ template <class Range,
 class multi_point_envelope : public envelope<Range>
 {
 public:
-    typedef Range                      range;
-    typedef typename Range::value_type value_type;
-    typedef ValuesPtr                  values_ptr;
+    typedef Range                                    range;
+    typedef typename Range::value_type               value_type;
+    typedef typename sound::sample_type<Range>::type sample_type;
+    typedef ValuesPtr                                values_ptr;
 
     multi_point_envelope (values_ptr val)
 	: _val (val)
@@ -167,16 +170,35 @@ public:
     value_type update (std::size_t sample);
 
     void update (const range& samples)
-    {
-        generate_frames (samples, [&] () -> value_type {
-                return this->multi_point_envelope::update ();
-            });
-    }
+    { fill (samples); }
+
+    /**
+     * Writes the values that update () would return for each frame of
+     * @a samples and advances the envelope as much. Each segment
+     * between two points is computed in closed form.
+     */
+    template <class Range2>
+    void fill (const Range2& samples);
+
+    /**
+     * Multiplies every frame of @a samples by the value that update ()
+     * would return for it and advances the envelope as much.
+     */
+    template <class Range2>
+    void apply (const Range2& samples);
 
     bool finished ()
     { return _cur_point >= _val->size() - 1; }
 
 private:
+    /**
+     * Walks the envelope over [first, last). @a set is called with
+     * an iterator and the value for it, @a rest with the remaining
+     * range once the envelope has finished and its value.
+     */
+    template <class Iterator, class SetFn, class RestFn>
+    void evaluate (Iterator first, Iterator last, SetFn set, RestFn rest);
+
     values_ptr    _val;
     std::size_t   _cur_point;
     float         _time;
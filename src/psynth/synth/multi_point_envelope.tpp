@@ -84,6 +84,87 @@ multi_point_envelope<R, Vp>::update (std::size_t sample)
     return val;
 }
 
+template <class R, class Vp>
+template <class Iterator, class SetFn, class RestFn>
+void multi_point_envelope<R, Vp>::evaluate (Iterator first, Iterator last,
+                                             SetFn set, RestFn rest)
+{
+    const float factor = _val->_factor;
+
+    while (first != last)
+    {
+        if (finished ())
+        {
+            // update () keeps returning the last point from now on.
+            _time = 0.0f;
+            rest (first, last, float (_val->get (_val->size () - 1).val));
+            return;
+        }
+
+        const auto& a = _val->get (_cur_point);
+        const auto& b = _val->get (_cur_point + 1);
+        const std::size_t left = last - first;
+        const float span = b.dt - _time;
+
+        std::size_t steps = 0;
+        if (factor > 0.0f && b.dt > a.dt && span >= factor)
+            steps = span >= factor * left ? left : std::size_t (span / factor);
+
+        if (steps == 0)
+        {
+            // The next frame crosses a point, step over it like update ().
+            set (first, float ((sample_type) update (1)));
+            ++first;
+            continue;
+        }
+
+        const float a_val = a.val;
+        const float slope = (float (b.val) - a_val) / (b.dt - a.dt);
+        const float start = _time - a.dt;
+        for (std::size_t i = 1; i <= steps; ++i, ++first)
+            set (first, a_val + slope * (start + i * factor));
+        _time += steps * factor;
+    }
+}
+
+template <class R, class Vp>
+template <class Range2>
+void multi_point_envelope<R, Vp>::fill (const Range2& samples)
+{
+    typedef typename Range2::value_type frame_type;
+    typedef typename Range2::iterator   iterator;
+
+    evaluate (
+        samples.begin (), samples.end (),
+        [] (iterator it, float val) {
+            *it = frame_type (sample_type (val));
+        },
+        [] (iterator first, iterator last, float val) {
+            std::fill (first, last, frame_type (sample_type (val)));
+        });
+}
+
+template <class R, class Vp>
+template <class Range2>
+void multi_point_envelope<R, Vp>::apply (const Range2& samples)
+{
+    typedef typename Range2::value_type frame_type;
+    typedef typename Range2::iterator   iterator;
+
+    evaluate (
+        samples.begin (), samples.end (),
+        [] (iterator it, float val) {
+            *it = scale_frame<frame_type> (*it, val);
+        },
+        [] (iterator first, iterator last, float val) {
+            if (val == 0.0f)
+                std::fill (first, last, frame_type (sample_type (val)));
+            else if (val != 1.0f)
+                for (; first != last; ++first)
+                    *first = scale_frame<frame_type> (*first, val);
+        });
+}
+
 } /* namespace synth */
 } /* namespace psynth */
 
@@ -15,7 +15,7 @@
 #include <cmath>
 #include <psynth/base/misc.hpp>
 #include <psynth/sound/typedefs.hpp>
-#include <psynth/synth/wave_table.hpp>
+#include <psynth/synth/mip_wave_table.hpp>
 
 namespace psynth
 {
@@ -92,13 +92,14 @@ class oscillator
 {
 public:
     /** @todo Parametrize? */
-    static const std::size_t default_table_size = 1 << 12;
+    static const std::size_t default_table_size =
+        mip_wave_table::default_size;
 
     oscillator (std::size_t frame_rate,
                 float       freq       = 220.0f,
 		float       ampl       = 1.0f,
 		float       phase      = 0.0f,
-		bool        wave_table = true)
+		bool        wave_table = false)
         : _frame_rate (frame_rate)
         , _speed (freq / frame_rate)
         , _x (phase)
@@ -107,8 +108,8 @@ public:
         , _phase (phase)
         , _wave_table (wave_table)
     {
-	if (wave_table && !s_table_init)
-	    initialize_table ();
+	if (wave_table)
+	    table ();
     }
 
     void restart ()
@@ -126,13 +127,25 @@ public:
     void set_phase (float phase)
     { _x += phase - _phase; _phase = phase; }
 
+    /**
+     * Chooses between reading band-limited tables or evaluating the
+     * generator for every frame, which aliases. The tables are meant
+     * for audio rate; at control rate their ripple around the edges
+     * would show up in whatever is modulated.
+     */
     void set_wave_table (bool wave_table)
     {
-	if (wave_table && !s_table_init)
-	    initialize_table ();
+	if (wave_table)
+	    table ();
 	_wave_table = wave_table;
     }
 
+    /**
+     * The tables of the generator, shared by all the oscillators. It
+     * is built on first use.
+     */
+    static const mip_wave_table& table ();
+
     template <class Range1>
     void update (const Range1& out_buf);
 
@@ -146,9 +159,6 @@ public:
     void update_am (const Range1& out_buf, const Range2& mod_buf);
 
 private:
-    static wave_table<sound::mono32sf_buffer> s_wave_table;
-    static bool                               s_table_init;
-
     Generator   _gen;
     std::size_t _frame_rate;
     float       _speed;
@@ -157,8 +167,6 @@ private:
     float       _ampl;
     float       _phase;
     bool        _wave_table;
-
-    void initialize_table ();
 };
 
 } /* namespace synth */
@@ -39,21 +39,11 @@ namespace psynth
 namespace synth
 {
 
-template <typename G>
-wave_table<sound::mono32sf_buffer> oscillator<G>::s_wave_table;
-
-template <typename G>
-bool oscillator<G>::s_table_init = false;
-
-
-/**
- * @todo This is not reentrant!
- */
 template <class G>
-void oscillator<G>::initialize_table ()
+const mip_wave_table& oscillator<G>::table ()
 {
-    s_wave_table.fill (default_table_size, _gen);
-    s_table_init = true;
+    static const mip_wave_table tables ((G ()), default_table_size);
+    return tables;
 }
 
 template <class G>
@@ -62,6 +52,23 @@ void oscillator<G>::update (const Range1& out_buf)
 {
     typedef typename Range1::value_type frame_type;
 
+    if (_wave_table)
+    {
+        const mip_wave_table& tables = table ();
+        const float* wave = tables.table (tables.level (_speed));
+        const auto inc = mip_wave_table::to_increment (_speed);
+        auto phase = mip_wave_table::to_phase (_x);
+
+        generate_frames (out_buf, [&] () -> frame_type {
+                frame_type ret { tables.get (wave, phase) * this->_ampl };
+                phase += inc;
+                return ret;
+            });
+
+        _x = mip_wave_table::from_phase (phase);
+        return;
+    }
+
     generate_frames (out_buf, [&] () -> frame_type {
             frame_type ret { this->_gen (this->_x) * this->_ampl };
             this->_x += this->_speed;
@@ -71,6 +78,10 @@ void oscillator<G>::update (const Range1& out_buf)
     _x = base::phase (_x);
 }
 
+/**
+ * The table is chosen for the carrier frequency. Deep modulations
+ * may still alias.
+ */
 template <class G>
 template <class Range1, class Range2>
 void oscillator<G>::update_fm (const Range1& out_buf, const Range2& mod_buf)
@@ -78,6 +89,23 @@ void oscillator<G>::update_fm (const Range1& out_buf, const Range2& mod_buf)
     typedef typename Range2::value_type modval;
     typedef typename Range1::value_type outval;
 
+    if (_wave_table)
+    {
+        const mip_wave_table& tables = table ();
+        const float* wave = tables.table (tables.level (_speed));
+        auto phase = mip_wave_table::to_phase (_x);
+
+        transform_frames (mod_buf, out_buf, [&] (modval m) -> outval {
+                auto ret = tables.get (wave, phase) * this->_ampl;
+                phase += mip_wave_table::to_increment (
+                    this->_speed + this->_speed * (sound::bits32sf) (m));
+                return outval { ret };
+            });
+
+        _x = mip_wave_table::from_phase (phase);
+        return;
+    }
+
     transform_frames (mod_buf, out_buf, [&] (modval m) -> outval {
             auto ret = this->_gen (this->_x) * this->_ampl;
             this->_x += (this->_freq + this->_freq * (sound::bits32sf) (m))
@@ -94,6 +122,25 @@ void oscillator<G>::update_pm (const Range1& out_buf, const Range2& mod_buf)
     typedef typename Range2::value_type modval;
     typedef typename Range1::value_type outval;
 
+    if (_wave_table)
+    {
+        const mip_wave_table& tables = table ();
+        const float* wave = tables.table (tables.level (_speed));
+        const auto inc = mip_wave_table::to_increment (_speed);
+        auto phase = mip_wave_table::to_phase (_x);
+
+        transform_frames (mod_buf, out_buf, [&] (modval m) -> outval {
+                auto ret = tables.get (
+                    wave, phase + mip_wave_table::to_increment (
+                        (sound::bits32sf) m)) * this->_ampl;
+                phase += inc;
+                return outval { ret };
+            });
+
+        _x = mip_wave_table::from_phase (phase);
+        return;
+    }
+
     transform_frames (mod_buf, out_buf, [&] (modval m) -> outval {
             auto ret = this->_gen (this->_x + (sound::bits32sf) m) * this->_ampl;
             this->_x += this->_speed;
@@ -109,6 +156,24 @@ void oscillator<G>::update_am (const Range1& out_buf, const Range2& mod_buf)
     typedef typename Range2::value_type modval;
     typedef typename Range1::value_type outval;
 
+    if (_wave_table)
+    {
+        const mip_wave_table& tables = table ();
+        const float* wave = tables.table (tables.level (_speed));
+        const auto inc = mip_wave_table::to_increment (_speed);
+        auto phase = mip_wave_table::to_phase (_x);
+
+        transform_frames (mod_buf, out_buf, [&] (modval m) -> outval {
+                auto ret = tables.get (wave, phase) * this->_ampl *
+                    (sound::bits32sf) m;
+                phase += inc;
+                return outval { ret };
+            });
+
+        _x = mip_wave_table::from_phase (phase);
+        return;
+    }
+
     transform_frames (mod_buf, out_buf, [&] (modval m) -> outval {
             auto ret = this->_gen (this->_x) * this->_ampl * (sound::bits32sf) m;
             this->_x += this->_speed;
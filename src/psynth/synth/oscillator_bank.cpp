@@ -0,0 +1,222 @@
+/**
+ *  Time-stamp:  <2011-07-07 19:52:48 raskolnikov>
+ *
+ *  @file        oscillator_bank.cpp
+ *  @author      Juan Pedro Bolivar Puente <raskolnikov@es.gnu.org>
+ *  @date        Thu Jul  7 17:20:08 2011
+ *
+ *  A bank of wave table oscillators rendered together.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolivar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+#if defined (__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "synth/oscillator.hpp"
+#include "synth/oscillator_bank.hpp"
+
+namespace psynth
+{
+namespace synth
+{
+
+namespace
+{
+
+static_assert (oscillator_bank::lanes == 4,
+               "the lookups below are written for four voices");
+
+typedef float bank_lanes
+__attribute__ ((vector_size (oscillator_bank::lanes * sizeof (float))));
+
+typedef oscillator_bank::phase_type bank_phases
+__attribute__ ((vector_size (oscillator_bank::lanes *
+                             sizeof (oscillator_bank::phase_type))));
+
+/** Frames mixed at once, their partial sums live in the stack. */
+const std::size_t chunk_size = 64;
+
+template <class Vector, class T>
+inline Vector load_lanes (const T* src)
+{
+    Vector v;
+    std::memcpy (&v, src, sizeof (v));
+    return v;
+}
+
+template <class T, class Vector>
+inline void store_lanes (T* dst, Vector v)
+{
+    std::memcpy (dst, &v, sizeof (v));
+}
+
+/**
+ * Converts the interpolation fractions, which are always below 2^31,
+ * to floating point.
+ */
+inline bank_lanes fraction_lanes (bank_phases x)
+{
+#if defined (__SSE2__)
+    return _mm_cvtepi32_ps ((__m128i) x);
+#else
+    return bank_lanes { float (x [0]), float (x [1]),
+                        float (x [2]), float (x [3]) };
+#endif
+}
+
+} /* anonymous namespace */
+
+oscillator_bank::oscillator_bank (std::size_t frame_rate, std::size_t voices)
+    : _frame_rate (frame_rate)
+    , _voices (voices)
+{
+    for (std::size_t w = 0; w < num_waves; ++w)
+        tables (wave (w));
+
+    const std::size_t padded = (voices + lanes - 1) / lanes * lanes;
+    _phase.resize (padded, 0);
+    _increment.resize (padded, 0);
+    _amplitude.resize (padded, 0.0f);
+    _table.resize (padded, tables (wave::sine).table (0));
+    _frequency.resize (voices, 0.0f);
+    _wave.resize (voices, wave::sine);
+}
+
+const mip_wave_table& oscillator_bank::tables (wave w)
+{
+    switch (w)
+    {
+    case wave::square:   return oscillator<square_generator>::table ();
+    case wave::triangle: return oscillator<triangle_generator>::table ();
+    case wave::sawtooth: return oscillator<sawtooth_generator>::table ();
+    case wave::moogsaw:  return oscillator<moogsaw_generator>::table ();
+    case wave::exp:      return oscillator<exp_generator>::table ();
+    default:             return oscillator<sine_generator>::table ();
+    }
+}
+
+void oscillator_bank::restart ()
+{
+    std::fill (_phase.begin (), _phase.end (), 0);
+}
+
+void oscillator_bank::set_frame_rate (std::size_t frame_rate)
+{
+    _frame_rate = frame_rate;
+    for (std::size_t v = 0; v < _voices; ++v)
+        update_voice (v);
+}
+
+void oscillator_bank::set_frequency (std::size_t voice, float freq)
+{
+    if (_frequency [voice] != freq)
+    {
+        _frequency [voice] = freq;
+        update_voice (voice);
+    }
+}
+
+void oscillator_bank::set_wave (std::size_t voice, wave w)
+{
+    if (_wave [voice] != w)
+    {
+        _wave [voice] = w;
+        update_voice (voice);
+    }
+}
+
+void oscillator_bank::update_voice (std::size_t voice)
+{
+    const float speed = _frequency [voice] / _frame_rate;
+    const mip_wave_table& t = tables (_wave [voice]);
+
+    _increment [voice] = mip_wave_table::to_increment (speed);
+    _table [voice]     = t.table (t.level (speed));
+}
+
+/*
+ * Every lane of the partial sums belongs to a different group of
+ * voices, they are only added together once all the groups have been
+ * computed. All the tables have the same size, so the phases of all
+ * the voices split the same way into index and fraction.
+ */
+void oscillator_bank::update (float* out, std::size_t n)
+{
+    const unsigned frac_bits = tables (wave::sine).frac_bits ();
+    const phase_type frac_one = phase_type (1) << frac_bits;
+    const bank_phases mask = bank_phases {} + (frac_one - 1);
+    const bank_lanes scale = bank_lanes {} + 1.0f / frac_one;
+
+    bank_lanes mix [chunk_size];
+
+    while (n > 0)
+    {
+        const std::size_t len = std::min (n, chunk_size);
+        std::fill (mix, mix + len, bank_lanes {});
+
+        for (std::size_t v = 0; v < _phase.size (); v += lanes)
+        {
+            const bank_lanes  ampl = load_lanes<bank_lanes> (&_amplitude [v]);
+            const bank_phases inc  = load_lanes<bank_phases> (&_increment [v]);
+            bank_phases phase = load_lanes<bank_phases> (&_phase [v]);
+
+            if (ampl [0] != 0.0f || ampl [1] != 0.0f ||
+                ampl [2] != 0.0f || ampl [3] != 0.0f)
+            {
+                const float* t0 = _table [v];
+                const float* t1 = _table [v + 1];
+                const float* t2 = _table [v + 2];
+                const float* t3 = _table [v + 3];
+
+                for (std::size_t i = 0; i < len; ++i)
+                {
+                    const bank_phases idx = phase >> frac_bits;
+                    const bank_lanes alpha = fraction_lanes (phase & mask) * scale;
+                    const bank_lanes a = bank_lanes {
+                        t0 [idx [0]], t1 [idx [1]], t2 [idx [2]], t3 [idx [3]] };
+                    const bank_lanes b = bank_lanes {
+                        t0 [idx [0] + 1], t1 [idx [1] + 1],
+                        t2 [idx [2] + 1], t3 [idx [3] + 1] };
+
+                    mix [i] += (a + alpha * (b - a)) * ampl;
+                    phase += inc;
+                }
+            }
+            else
+                phase += inc * phase_type (len);
+
+            store_lanes (&_phase [v], phase);
+        }
+
+        for (std::size_t i = 0; i < len; ++i)
+            out [i] = (mix [i][0] + mix [i][1]) + (mix [i][2] + mix [i][3]);
+
+        out += len;
+        n   -= len;
+    }
+}
+
+} /* namespace synth */
+} /* namespace psynth */
@@ -0,0 +1,127 @@
+/**
+ *  Time-stamp:  <2011-07-07 19:52:31 raskolnikov>
+ *
+ *  @file        oscillator_bank.hpp
+ *  @author      Juan Pedro Bolivar Puente <raskolnikov@es.gnu.org>
+ *  @date        Thu Jul  7 17:20:08 2011
+ *
+ *  A bank of wave table oscillators rendered together.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolivar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_SYNTH_OSCILLATOR_BANK_H_
+#define PSYNTH_SYNTH_OSCILLATOR_BANK_H_
+
+#include <cstddef>
+#include <vector>
+
+#include <psynth/synth/mip_wave_table.hpp>
+
+namespace psynth
+{
+namespace synth
+{
+
+/**
+ * A set of oscillators whose outputs are summed. The voices are
+ * stored as one array per property, so that several of them are
+ * computed with every vector instruction, and they read the same
+ * band-limited tables as synth::oscillator.
+ */
+class oscillator_bank
+{
+public:
+    typedef mip_wave_table::phase_type phase_type;
+
+    enum class wave
+    {
+        sine,
+        square,
+        triangle,
+        sawtooth,
+        moogsaw,
+        exp
+    };
+
+    static const std::size_t num_waves = 6;
+
+    /** Voices computed together. */
+    static const std::size_t lanes = 4;
+
+    /**
+     * Creates a bank of @a voices silent sine voices. The tables of
+     * all the waves are built here if they did not exist yet.
+     */
+    oscillator_bank (std::size_t frame_rate, std::size_t voices);
+
+    std::size_t voices () const
+    { return _voices; }
+
+    void restart ();
+
+    void set_frame_rate (std::size_t frame_rate);
+
+    void set_frequency (std::size_t voice, float freq);
+
+    void set_amplitude (std::size_t voice, float ampl)
+    { _amplitude [voice] = ampl; }
+
+    void set_wave (std::size_t voice, wave w);
+
+    /**
+     * Writes the sum of the voices in the first channel of @a out_buf
+     * and copies it to the rest, which must be planar.
+     */
+    template <class Range>
+    void update (const Range& out_buf);
+
+    /**
+     * Writes the sum of the voices in @a n samples of @a out.
+     */
+    void update (float* out, std::size_t n);
+
+private:
+    static const mip_wave_table& tables (wave w);
+
+    void update_voice (std::size_t voice);
+
+    std::size_t _frame_rate;
+    std::size_t _voices;
+
+    /*
+     * Padded to a multiple of lanes, the extra voices are silent.
+     */
+    std::vector<phase_type>   _phase;
+    std::vector<phase_type>   _increment;
+    std::vector<float>        _amplitude;
+    std::vector<const float*> _table;
+
+    std::vector<float> _frequency;
+    std::vector<wave>  _wave;
+};
+
+} /* namespace synth */
+} /* namespace psynth */
+
+#include <psynth/synth/oscillator_bank.tpp>
+
+#endif /* PSYNTH_SYNTH_OSCILLATOR_BANK_H_ */
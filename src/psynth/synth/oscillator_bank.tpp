@@ -0,0 +1,64 @@
+/**
+ *  Time-stamp:  <2011-07-07 19:52:40 raskolnikov>
+ *
+ *  @file        oscillator_bank.tpp
+ *  @author      Juan Pedro Bolivar Puente <raskolnikov@es.gnu.org>
+ *  @date        Thu Jul  7 17:20:08 2011
+ *
+ *  A bank of wave table oscillators rendered together.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolivar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PSYNTH_SYNTH_OSCILLATOR_BANK_TPP_
+#define PSYNTH_SYNTH_OSCILLATOR_BANK_TPP_
+
+#include <algorithm>
+
+#include <psynth/sound/frame.hpp>
+#include <psynth/synth/oscillator_bank.hpp>
+
+namespace psynth
+{
+namespace synth
+{
+
+template <class Range>
+void oscillator_bank::update (const Range& out_buf)
+{
+    typedef typename Range::value_type frame_type;
+    constexpr std::size_t num_channels =
+        sound::num_samples<frame_type>::value;
+
+    const std::size_t n = out_buf.size ();
+    if (n == 0)
+        return;
+
+    float* first = (float*) &out_buf [0][0];
+    update (first, n);
+    for (std::size_t c = 1; c < num_channels; ++c)
+        std::copy (first, first + n, (float*) &out_buf [0][c]);
+}
+
+} /* namespace synth */
+} /* namespace psynth */
+
+#endif /* PSYNTH_SYNTH_OSCILLATOR_BANK_TPP_ */
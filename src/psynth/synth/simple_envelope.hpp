@@ -33,9 +33,12 @@
 #ifndef PSYNTH_SYNTH_SIMPLE_ENVELOPE_H
 #define PSYNTH_SYNTH_SIMPLE_ENVELOPE_H
 
+#include <algorithm>
+
 #include <psynth/sound/forwards.hpp>
 #include <psynth/sound/algorithm.hpp>
 #include <psynth/synth/envelope.hpp>
+#include <psynth/synth/util.hpp>
 
 namespace psynth
 {
@@ -109,19 +112,76 @@ public:
     }
 
     void update (const range& samples)
+    { fill (samples); }
+
+    template <class Range2>
+    void update (const Range2& samples)
+    { fill (samples); }
+
+    /**
+     * Writes the values that update () would return for each frame of
+     * @a samples and advances the envelope as much. The ramp is
+     * computed in closed form and the frames after it reaches its end
+     * are filled with a constant.
+     */
+    template <class Range2>
+    void fill (const Range2& samples)
     {
-        sound::generate_frames (samples, [&] () -> value_type {
-                return this->simple_envelope::update ();
-            });
+        typedef typename Range2::value_type frame_type;
+        const std::size_t n = samples.size ();
+        const std::size_t ramp = ramp_length (n);
+        const float start = _val;
+
+        auto it = samples.begin ();
+        for (std::size_t i = 0; i < ramp; ++i, ++it)
+            *it = frame_type (sample_type (ramp_value (start, i)));
+
+        update (n);
+        std::fill (it, samples.end (), frame_type (_val));
     }
 
+    /**
+     * Multiplies every frame of @a samples by the value that update ()
+     * would return for it and advances the envelope as much. Nothing
+     * is done to the frames once the envelope rests at its maximum.
+     */
     template <class Range2>
-    void update (const Range2& samples)
+    void apply (const Range2& samples)
     {
-        sound::generate_frames (samples, [&] () {
-                return typename Range2::value_type (
-                    this->simple_envelope::update ());
-            });
+        typedef typename Range2::value_type frame_type;
+        const sample_type one  =
+            sound::sample_traits<sample_type>::max_value ();
+        const sample_type zero =
+            sound::sample_traits<sample_type>::zero_value ();
+        const std::size_t n = samples.size ();
+        const std::size_t ramp = ramp_length (n);
+        const float start = _val;
+
+        auto it = samples.begin ();
+        for (std::size_t i = 0; i < ramp; ++i, ++it)
+            *it = scale_frame<frame_type> (*it, ramp_value (start, i));
+
+        update (n);
+        if (_val == zero)
+            std::fill (it, samples.end (), frame_type (zero));
+        else if (_val != one)
+            for (; it != samples.end (); ++it)
+                *it = scale_frame<frame_type> (*it, _val);
+    }
+
+    /**
+     * Whether the envelope will keep its current value, because it is
+     * not moving or it has reached the end it was moving to.
+     */
+    bool flat () const
+    {
+        const sample_type one  =
+            sound::sample_traits<sample_type>::max_value ();
+        const sample_type zero =
+            sound::sample_traits<sample_type>::zero_value ();
+        return _curr_dt == 0.0f ||
+            (_curr_dt > 0.0f && _val >= one) ||
+            (_curr_dt < 0.0f && _val <= zero);
     }
 
     void press ()
@@ -133,7 +193,28 @@ public:
     bool finished ()
     { return _val <= 0.0f; }
 
+    /** The value that the next update () returns. */
+    sample_type value () const
+    { return _val; }
+
+    /** Change per sample, before clamping. */
+    float delta () const
+    { return _curr_dt; }
+
 private:
+    /** Number of the next @a n values that lie on the ramp. */
+    std::size_t ramp_length (std::size_t n) const
+    {
+        if (flat ())
+            return 0;
+        const float end   = _curr_dt > 0.0f ? 1.0f : 0.0f;
+        const float steps = (end - float (_val)) / _curr_dt;
+        return steps < n ? std::size_t (steps) + 1 : n;
+    }
+
+    float ramp_value (float start, std::size_t i) const
+    { return std::min (std::max (start + _curr_dt * i, 0.0f), 1.0f); }
+
     float       _rise_dt;
     float       _fall_dt;
     float       _curr_dt;
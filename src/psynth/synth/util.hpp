@@ -59,6 +59,19 @@ std::size_t find_hill (const Range& data, std::size_t start)
     return start;
 }
 
+/**
+ * Returns @a frame with all its samples multiplied by @a factor.
+ */
+template <class Frame>
+Frame scale_frame (Frame frame, float factor)
+{
+    typedef typename sound::sample_type<Frame>::type sample_type;
+    static_transform (frame, frame, [&] (sample_type s) -> sample_type {
+            return s * factor;
+        });
+    return frame;
+}
+
 template <class R1, class R2, class R3>
 void mix (const R1& src1, const R2& src2, const R3& dst)
 {
@@ -276,6 +276,26 @@ public:
 	    m_node_mgr.set_info (info);
     }
 
+    void set_num_threads (std::size_t num_threads) {
+	m_node_mgr.set_num_threads (num_threads);
+    }
+
+    void set_render_ahead (std::size_t frames) {
+	m_output->set_render_ahead (frames);
+    }
+
+    io::render_ahead_stats get_render_stats () const {
+	return m_output->get_render_stats ();
+    }
+
+    std::vector<graph::node_dsp_stats> get_dsp_stats () const {
+	return m_node_mgr.get_dsp_stats ();
+    }
+
+    void reset_dsp_stats () {
+	m_node_mgr.reset_dsp_stats ();
+    }
+
     void register_node_factory (graph::node_factory& f) {
 	m_nodfact.register_factory (f);
     }
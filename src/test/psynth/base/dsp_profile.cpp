@@ -0,0 +1,102 @@
+/**
+ *  @file        dsp_profile.cpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Sun Jul 10 12:41:30 2011
+ *
+ *  @brief Tests for the dsp_profile class.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include <psynth/base/dsp_profile.hpp>
+
+BOOST_AUTO_TEST_SUITE(base_dsp_profile_test_suite)
+
+using namespace psynth::base;
+
+BOOST_AUTO_TEST_CASE(dsp_profile_test_empty)
+{
+    dsp_profile p;
+    dsp_stats s = p.stats (1.0);
+    BOOST_CHECK_EQUAL (s.blocks, 0);
+    BOOST_CHECK_EQUAL (s.mean_ns, 0);
+    BOOST_CHECK_EQUAL (s.p99_ns, 0);
+    BOOST_CHECK_EQUAL (s.max_ns, 0);
+}
+
+BOOST_AUTO_TEST_CASE(dsp_profile_test_stats)
+{
+    dsp_profile p;
+    for (int i = 0; i < 990; ++i)
+        p.add (1000);
+    for (int i = 0; i < 10; ++i)
+        p.add (100000);
+
+    dsp_stats s = p.stats (1.0);
+    BOOST_CHECK_EQUAL (s.blocks, 1000);
+    BOOST_CHECK_EQUAL (s.mean_ns, 1990);
+    BOOST_CHECK_EQUAL (s.max_ns, 100000);
+    BOOST_CHECK (s.p99_ns >= 1000);
+    BOOST_CHECK (s.p99_ns <= 1250);
+
+    p.add (100000);
+    BOOST_CHECK (p.stats (1.0).p99_ns >= 100000);
+    BOOST_CHECK (p.stats (1.0).p99_ns <= 125000);
+
+    // Conversion of the ticks
+    BOOST_CHECK_EQUAL (p.stats (2.0).max_ns, 200000);
+
+    p.reset_stats ();
+    BOOST_CHECK_EQUAL (p.stats (1.0).blocks, 0);
+    BOOST_CHECK_EQUAL (p.stats (1.0).max_ns, 0);
+}
+
+BOOST_AUTO_TEST_CASE(dsp_profile_test_small)
+{
+    dsp_profile p;
+    p.add (0);
+    p.add (3);
+    p.add (5);
+
+    dsp_stats s = p.stats (1.0);
+    BOOST_CHECK_EQUAL (s.blocks, 3);
+    BOOST_CHECK_EQUAL (s.max_ns, 5);
+    BOOST_CHECK_EQUAL (s.p99_ns, 5);
+}
+
+BOOST_AUTO_TEST_CASE(dsp_profile_test_scope)
+{
+    dsp_profile p;
+    {
+        dsp_profile_scope scope (p);
+        std::this_thread::sleep_for (std::chrono::milliseconds (1));
+    }
+
+    dsp_stats s = p.stats ();
+    BOOST_CHECK_EQUAL (s.blocks, 1);
+    BOOST_CHECK (s.max_ns >= 900000);
+    BOOST_CHECK (s.max_ns < 1000000000);
+    BOOST_CHECK_EQUAL (s.mean_ns, s.max_ns);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,174 @@
+/**
+ *  @file        event_ring.cpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Fri Jul  8 19:40:12 2011
+ *
+ *  @brief Tests for the event_ring class.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <psynth/base/event_ring.hpp>
+
+BOOST_AUTO_TEST_SUITE(base_event_ring_test_suite)
+
+struct test_base
+{
+    static int alive;
+    test_base () { ++alive; }
+    virtual ~test_base () { --alive; }
+    virtual int value () const = 0;
+};
+
+int test_base::alive = 0;
+
+struct test_value : test_base
+{
+    int val;
+    test_value (int v) : val (v) {}
+    int value () const { return val; }
+};
+
+struct test_except : test_base
+{
+    test_except () { throw std::logic_error ("except"); }
+    int value () const { return -1; }
+};
+
+typedef psynth::base::event_ring<test_base, 64> test_ring;
+
+BOOST_AUTO_TEST_CASE(event_ring_test_order)
+{
+    test_ring q (3);
+    BOOST_CHECK_EQUAL (q.capacity (), 4);
+    BOOST_CHECK_EQUAL (q.empty (), true);
+
+    BOOST_CHECK_EQUAL (q.push_back<test_value> (1), true);
+    BOOST_CHECK_EQUAL (q.push_back<test_value> (2), true);
+    BOOST_CHECK_EQUAL (q.empty (), false);
+
+    std::vector<int> seen;
+    BOOST_CHECK_EQUAL (q.consume ([&] (test_base& x) {
+                seen.push_back (x.value ());
+            }), 2);
+
+    BOOST_CHECK_EQUAL (seen.size (), 2);
+    BOOST_CHECK_EQUAL (seen [0], 1);
+    BOOST_CHECK_EQUAL (seen [1], 2);
+    BOOST_CHECK_EQUAL (q.empty (), true);
+    BOOST_CHECK_EQUAL (test_base::alive, 0);
+}
+
+BOOST_AUTO_TEST_CASE(event_ring_test_overflow)
+{
+    test_ring q (2);
+
+    BOOST_CHECK_EQUAL (q.push_back<test_value> (1), true);
+    BOOST_CHECK_EQUAL (q.push_back<test_value> (2), true);
+    BOOST_CHECK_EQUAL (q.push_back<test_value> (3), false);
+    BOOST_CHECK_EQUAL (q.overflowed (), 1);
+
+    int sum = 0;
+    q.consume ([&] (test_base& x) { sum += x.value (); });
+    BOOST_CHECK_EQUAL (sum, 3);
+
+    // The ring wraps around after consuming.
+    for (int i = 0; i < 10; ++i)
+    {
+        BOOST_CHECK_EQUAL (q.push_back<test_value> (i), true);
+        q.consume ([&] (test_base& x) { BOOST_CHECK_EQUAL (x.value (), i); });
+    }
+    BOOST_CHECK_EQUAL (q.overflowed (), 1);
+}
+
+BOOST_AUTO_TEST_CASE(event_ring_test_consume_snapshot)
+{
+    test_ring q (4);
+    q.push_back<test_value> (1);
+
+    std::size_t count = q.consume ([&] (test_base&) {
+            q.push_back<test_value> (2);
+        });
+
+    BOOST_CHECK_EQUAL (count, 1);
+    BOOST_CHECK_EQUAL (q.empty (), false);
+}
+
+BOOST_AUTO_TEST_CASE(event_ring_test_dropped)
+{
+    {
+        test_ring q (4);
+        q.push_back<test_value> (1);
+        q.push_back<test_value> (2);
+        BOOST_CHECK_EQUAL (q.clear (), 2);
+        BOOST_CHECK_EQUAL (q.dropped (), 2);
+        BOOST_CHECK_EQUAL (test_base::alive, 0);
+
+        q.push_back<test_value> (3);
+        BOOST_CHECK_EQUAL (test_base::alive, 1);
+    }
+    BOOST_CHECK_EQUAL (test_base::alive, 0);
+}
+
+BOOST_AUTO_TEST_CASE(event_ring_test_except)
+{
+    test_ring q (4);
+
+    BOOST_CHECK_THROW (q.push_back<test_except> (), std::logic_error);
+    q.push_back<test_value> (1);
+
+    std::size_t count = q.consume ([&] (test_base& x) {
+            BOOST_CHECK_EQUAL (x.value (), 1);
+        });
+    BOOST_CHECK_EQUAL (count, 1);
+    BOOST_CHECK_EQUAL (q.empty (), true);
+}
+
+BOOST_AUTO_TEST_CASE(event_ring_test_producers)
+{
+    const int producers = 4;
+    const int per_producer = 10000;
+
+    test_ring q (64);
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p)
+        threads.push_back (std::thread ([&] {
+                    for (int i = 1; i <= per_producer; ++i)
+                        while (!q.push_back<test_value> (i));
+                }));
+
+    long sum = 0;
+    long expected = long (producers) * per_producer * (per_producer + 1) / 2;
+    while (sum < expected)
+        q.consume ([&] (test_base& x) { sum += x.value (); });
+
+    for (auto& t : threads)
+        t.join ();
+
+    BOOST_CHECK_EQUAL (sum, expected);
+    BOOST_CHECK_EQUAL (q.empty (), true);
+    BOOST_CHECK_EQUAL (test_base::alive, 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
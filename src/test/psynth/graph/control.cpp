@@ -224,4 +224,50 @@ BOOST_AUTO_TEST_CASE(test_out_control_non_fundamental_attach)
     BOOST_CHECK_EQUAL (ctl->out.str (), std::string ("(0,0)"));
 }
 
+struct split_control_node : public sink_node
+{
+    in_control<int> in;
+    std::vector<std::pair<std::size_t, int> > pieces;
+
+    split_control_node ()
+        : in ("input", this, 0)
+    {}
+
+    void rt_do_process (rt_process_context& ctx)
+    {
+        rt_split_block (ctx.block_size (), { &in },
+                        [&] (std::size_t start, std::size_t size) {
+                            pieces.push_back (std::make_pair (
+                                                  start, in.rt_get ()));
+                        });
+    }
+};
+
+BOOST_AUTO_TEST_CASE(test_in_control_timestamped_attach)
+{
+    auto ctl = std::make_shared<split_control_node> ();
+
+    processor p;
+    p.root ()->add (ctl);
+    p.start ();
+    p.rt_request_process ();
+
+    const std::size_t block = p.context ().block_size ();
+    ctl->pieces.clear ();
+    ctl->in.set (1, 10);
+    ctl->in.set (2, block + 20);
+
+    p.rt_request_process ();
+    p.rt_request_process ();
+    p.rt_request_process ();
+
+    typedef std::pair<std::size_t, int> piece;
+    std::vector<piece> expected {
+        piece (0, 0), piece (10, 1),
+        piece (0, 1), piece (20, 2),
+        piece (0, 2) };
+    BOOST_CHECK (ctl->pieces == expected);
+    BOOST_CHECK_EQUAL (ctl->in.rt_get (), 2);
+}
+
 BOOST_AUTO_TEST_SUITE_END ();
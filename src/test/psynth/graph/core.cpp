@@ -29,6 +29,10 @@
  */
 
 #include <iostream>
+#include <sstream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
 #include <boost/test/unit_test.hpp>
 #include <boost/mpl/vector.hpp>
 
@@ -36,9 +40,24 @@
 #include <psynth/new_graph/sink_node.hpp>
 #include <psynth/new_graph/processor.hpp>
 #include <psynth/new_graph/core/patch.hpp>
+#include <psynth/new_graph/core/patch_file.hpp>
+#include <psynth/new_graph/core/passive_output.hpp>
+#include <psynth/new_graph/offline_render.hpp>
+#include <psynth/io/output.hpp>
 
 using namespace psynth::graph;
 
+struct recording_output : public psynth::io::output<audio_range>
+{
+    std::vector<float> samples;
+    std::size_t put (const const_range& data)
+    {
+        for (std::size_t i = 0; i < data.size (); ++i)
+            samples.push_back (psynth::sound::semantic_at_c<0> (data [i]));
+        return data.size ();
+    }
+};
+
 BOOST_AUTO_TEST_SUITE(graph_core_test_suite);
 
 BOOST_AUTO_TEST_CASE(test_port_todo)
@@ -46,4 +65,102 @@ BOOST_AUTO_TEST_CASE(test_port_todo)
     BOOST_CHECK (1);
 }
 
+BOOST_AUTO_TEST_CASE (test_oscillator_bank_voices)
+{
+    auto& factory = node_factory::self ();
+    auto bank = factory.create ("audio_oscillator_bank");
+
+    BOOST_CHECK_NO_THROW (bank->out ("output"));
+    BOOST_CHECK_NO_THROW (bank->param ("frequency-0").set<float> (220.0f));
+    BOOST_CHECK_NO_THROW (bank->param ("amplitude-7").set<float> (0.5f));
+    BOOST_CHECK_NO_THROW (bank->param ("wave-3").set<int> (2));
+    BOOST_CHECK_THROW (bank->param ("frequency-8"), node_component_error);
+    BOOST_CHECK_EQUAL (bank->param ("frequency-0").get<float> (), 220.0f);
+    bank->param ("amplitude-7").set<float> (0.0f);
+
+    // The voices must sound like separate oscillator nodes.
+    const char* names [] = { "audio_sine_oscillator",
+                             "audio_triangle_oscillator",
+                             "audio_sawtooth_oscillator" };
+    const int   waves []       = { 0, 2, 3 };
+    const float frequencies [] = { 220.0f, 330.0f, 550.0f };
+    const float amplitudes []  = { 0.5f, 0.25f, 0.125f };
+    const std::size_t voices = 3;
+
+    processor p (0, 64);
+    p.root ()->add (bank);
+    auto bank_out = std::make_shared<recording_output> ();
+    connect (bank, "output",
+             p.root ()->add (core::new_passive_output (bank_out)), "input");
+
+    std::vector<std::shared_ptr<recording_output> > osc_outs;
+    for (std::size_t i = 0; i < voices; ++i)
+    {
+        const auto suffix = "-" + std::to_string (i);
+        bank->param ("wave" + suffix).set<int> (waves [i]);
+        bank->param ("frequency" + suffix).set<float> (frequencies [i]);
+        bank->param ("amplitude" + suffix).set<float> (amplitudes [i]);
+
+        auto osc = p.root ()->add (factory.create (names [i]));
+        osc->param ("frequency").set<float> (frequencies [i]);
+        osc->param ("amplitude").set<float> (amplitudes [i]);
+
+        osc_outs.push_back (std::make_shared<recording_output> ());
+        connect (osc, "output",
+                 p.root ()->add (core::new_passive_output (osc_outs.back ())),
+                 "input");
+    }
+
+    render_offline (p, 64);
+    BOOST_CHECK_EQUAL (bank_out->samples.size (), 64);
+
+    float peak = 0.0f;
+    for (std::size_t i = 0; i < bank_out->samples.size (); ++i)
+    {
+        float sum = 0.0f;
+        for (auto& out : osc_outs)
+            sum += out->samples.at (i);
+        BOOST_CHECK_SMALL (bank_out->samples [i] - sum, 1e-4f);
+        peak = std::max (peak, std::abs (sum));
+    }
+    BOOST_CHECK (peak > 0.1f);
+}
+
+struct counting_output : public psynth::io::output<audio_range>
+{
+    std::size_t frames = 0;
+    std::size_t put (const const_range& data)
+    { return frames += data.size (), data.size (); }
+};
+
+BOOST_AUTO_TEST_CASE (test_patch_file_render)
+{
+    std::istringstream desc (
+        "# A quiet sine\n"
+        "node osc audio_sine_oscillator\n"
+        "param osc frequency 220\n"
+        "param osc amplitude 0.5\n"
+        "\n"
+        "node out audio_patch_out_port\n"
+        "param out port-name output\n"
+        "connect osc output out input\n");
+
+    auto patch  = core::load_patch (desc);
+    auto device = std::make_shared<counting_output> ();
+
+    processor p (0, 64);
+    auto out = p.root ()->add (core::new_passive_output (device));
+    p.root ()->add (patch);
+    connect (patch, "output", out, "input");
+
+    auto stats = render_offline (p, 1000);
+    BOOST_CHECK_EQUAL (device->frames, 1000);
+    BOOST_CHECK_EQUAL (stats.frames, 1000);
+    BOOST_CHECK_EQUAL (p.context ().block_size (), 64);
+    BOOST_CHECK (!p.is_running ());
+
+    std::istringstream bad ("node osc no_such_node\n");
+    BOOST_CHECK_THROW (core::load_patch (bad), core::patch_file_error);
+}
+
 BOOST_AUTO_TEST_SUITE_END ();
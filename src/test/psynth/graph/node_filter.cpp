@@ -0,0 +1,104 @@
+/**
+ *  Time-stamp:  <2011-07-20 12:14:36 raskolnikov>
+ *
+ *  @file        node_filter.cpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Wed Jul 20 11:32:08 2011
+ *
+ *  @brief Unit tests for the filter node of the old graph.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cmath>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+#include <psynth/graph/node_manager.hpp>
+#include <psynth/graph/node_oscillator.hpp>
+#include <psynth/graph/node_filter.hpp>
+#include <psynth/graph/node_output.hpp>
+
+using namespace psynth;
+using namespace psynth::graph;
+
+namespace
+{
+
+/** Keeps the first channel of the watched input. */
+struct recording_watch : public watch
+{
+    std::vector<float> data;
+
+    void update (const audio_const_range& buf)
+    {
+        for (std::size_t i = 0; i < buf.size (); ++i)
+            data.push_back (buf [i][0]);
+    }
+};
+
+} /* anonymous namespace */
+
+BOOST_AUTO_TEST_SUITE (graph_node_filter_test_suite);
+
+BOOST_AUTO_TEST_CASE (test_node_filter_unmodulate)
+{
+    // The link fades out in less than two blocks, within the last
+    // sweep of the coefficients of the second.
+    const audio_info info (44100, 32, 2);
+
+    node_manager mgr;
+    node_audio_oscillator* osc = new node_audio_oscillator (info);
+    node_lfo* lfo = new node_lfo (info);
+    node_filter* filter = new node_filter (info);
+    node_output* out = new node_output (info);
+    mgr.add_node (base::mgr_ptr<node0> (osc), 0);
+    mgr.add_node (base::mgr_ptr<node0> (lfo), 1);
+    mgr.add_node (base::mgr_ptr<node0> (filter), 2);
+    mgr.add_node (base::mgr_ptr<node0> (out), 3);
+
+    filter->connect_in (node0::LINK_AUDIO, node_filter::IN_A_INPUT, osc, 0);
+    filter->connect_in (node0::LINK_CONTROL, node_filter::IN_C_CUTOFF, lfo, 0);
+    out->connect_in (node0::LINK_AUDIO, node_output::IN_A_INPUT, filter, 0);
+    filter->param (node_filter::PARAM_CONTROL_STEP).set (int (info.block_size));
+
+    recording_watch* rec = new recording_watch;
+    out->attach_watch (node0::LINK_AUDIO, node_output::IN_A_INPUT, rec);
+
+    for (int i = 0; i < 32; ++i)
+        mgr.update ();
+
+    // The cutoff is swept back to the parameter while the link fades
+    // out, then the filter is not modulated any more.
+    filter->connect_in (node0::LINK_CONTROL, node_filter::IN_C_CUTOFF, 0, 0);
+    for (int i = 0; i < 1024; ++i)
+        mgr.update ();
+
+    float peak = 0.0f;
+    for (std::size_t i = 0; i < rec->data.size (); ++i)
+        peak = std::isfinite (rec->data [i]) ?
+            std::max (peak, std::fabs (rec->data [i])) : INFINITY;
+
+    BOOST_CHECK_EQUAL (rec->data.size (), 1056 * info.block_size);
+    BOOST_CHECK_LT (peak, 4.0f);
+}
+
+BOOST_AUTO_TEST_SUITE_END ();
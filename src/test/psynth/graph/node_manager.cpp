@@ -0,0 +1,133 @@
+/**
+ *  Time-stamp:  <2011-07-20 13:02:51 raskolnikov>
+ *
+ *  @file        node_manager.cpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Wed Jul 20 12:40:17 2011
+ *
+ *  @brief Unit tests for the node manager of the old graph.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+#include <boost/test/unit_test.hpp>
+
+#include <psynth/graph/node_manager.hpp>
+#include <psynth/graph/node_oscillator.hpp>
+#include <psynth/graph/node_filter.hpp>
+#include <psynth/graph/node_echo.hpp>
+#include <psynth/graph/node_mixer.hpp>
+#include <psynth/graph/node_output.hpp>
+
+using namespace psynth;
+using namespace psynth::graph;
+
+namespace
+{
+
+/** Keeps both channels of the watched input. */
+struct recording_watch : public watch
+{
+    std::vector<float> data;
+
+    void update (const audio_const_range& buf)
+    {
+        for (std::size_t i = 0; i < buf.size (); ++i) {
+            data.push_back (buf [i][0]);
+            data.push_back (buf [i][1]);
+        }
+    }
+};
+
+const int num_output_nodes = 7;
+
+/**
+ * Renders a chain of oscillator, filter, echo and mixer, with the
+ * first oscillator also read by a second mixer and an LFO modulating
+ * the filter.
+ */
+std::vector<float> render_chain (std::size_t num_threads,
+                                 std::size_t& num_shared)
+{
+    const audio_info info (44100, 64, 2);
+
+    node_manager mgr;
+    mgr.set_num_threads (num_threads);
+
+    node_audio_oscillator* osc1 = new node_audio_oscillator (info);
+    node_audio_oscillator* osc2 = new node_audio_oscillator (info);
+    node_lfo*              lfo  = new node_lfo (info);
+    node_filter*           filt = new node_filter (info);
+    node_echo*             echo = new node_echo (info);
+    node_audio_mixer*      mix1 = new node_audio_mixer (info);
+    node_audio_mixer*      mix2 = new node_audio_mixer (info);
+    node_output*           out  = new node_output (info);
+
+    int id = 0;
+    for (node0* n : { (node0*) osc1, (node0*) osc2, (node0*) lfo,
+                (node0*) filt, (node0*) echo, (node0*) mix1,
+                (node0*) mix2, (node0*) out })
+        mgr.add_node (base::mgr_ptr<node0> (n), id++);
+
+    osc2->param (node_oscillator::PARAM_FREQUENCY).set (330.0f);
+
+    filt->connect_in (node0::LINK_AUDIO, node_filter::IN_A_INPUT, osc1, 0);
+    filt->connect_in (node0::LINK_CONTROL, node_filter::IN_C_CUTOFF, lfo, 0);
+    echo->connect_in (node0::LINK_AUDIO, node_echo::IN_A_INPUT, filt, 0);
+    mix2->connect_in (node0::LINK_AUDIO, 0, osc1, 0);
+    mix2->connect_in (node0::LINK_AUDIO, 1, osc2, 0);
+    mix1->connect_in (node0::LINK_AUDIO, 0, echo, 0);
+    mix1->connect_in (node0::LINK_AUDIO, 1, mix2, 0);
+    out->connect_in (node0::LINK_AUDIO, node_output::IN_A_INPUT, mix1, 0);
+
+    recording_watch* rec = new recording_watch;
+    out->attach_watch (node0::LINK_AUDIO, node_output::IN_A_INPUT, rec);
+
+    for (int i = 0; i < 64; ++i)
+        mgr.update ();
+
+    num_shared = mgr.get_num_shared_buffers ();
+    return rec->data;
+}
+
+} /* anonymous namespace */
+
+BOOST_AUTO_TEST_SUITE (graph_node_manager_test_suite);
+
+BOOST_AUTO_TEST_CASE (test_node_manager_share_buffers)
+{
+    std::size_t serial_shared = 0;
+    std::size_t parallel_shared = 0;
+
+    const std::vector<float> serial = render_chain (1, serial_shared);
+    const std::vector<float> parallel = render_chain (2, parallel_shared);
+
+    // The parallel plan keeps a buffer for every output.
+    BOOST_CHECK_EQUAL (parallel_shared, 0);
+    BOOST_CHECK_GT (serial_shared, 0);
+    BOOST_CHECK_LT (serial_shared, num_output_nodes);
+
+    BOOST_CHECK_EQUAL (serial.size (), 64 * 64 * 2);
+    BOOST_CHECK (serial == parallel);
+}
+
+BOOST_AUTO_TEST_SUITE_END ();
@@ -35,6 +35,7 @@
 #include <psynth/new_graph/node.hpp>
 #include <psynth/new_graph/sink_node.hpp>
 #include <psynth/new_graph/processor.hpp>
+#include <psynth/new_graph/buffer_port.hpp>
 #include <psynth/new_graph/core/patch.hpp>
 
 using namespace psynth::graph;
@@ -61,6 +62,29 @@ struct counting_sink : public sink_node
     { ++count; }
 };
 
+struct sized_sink : public sink_node
+{
+    audio_out_port out;
+    std::size_t block_size;
+    std::size_t frame_rate;
+    sized_sink () : out ("output", this), block_size (0), frame_rate (0) {}
+    void rt_on_context_update (rt_process_context& ctx)
+    {
+        block_size = ctx.block_size ();
+        frame_rate = ctx.frame_rate ();
+    }
+    void rt_do_process (rt_process_context& ctx)
+    { BOOST_CHECK_EQUAL (out.rt_out_range ().size (), ctx.block_size ()); }
+};
+
+struct port_sink : public sink_node
+{
+    audio_in_port  in;
+    audio_out_port out;
+    port_sink () : in ("input", this), out ("output", this) {}
+    void rt_do_process (rt_process_context& ctx) {}
+};
+
 BOOST_AUTO_TEST_SUITE(graph_processor_test_suite);
 
 BOOST_AUTO_TEST_CASE(test_processor)
@@ -204,4 +228,67 @@ BOOST_AUTO_TEST_CASE (test_processor_errors)
     // Should stop on destroy
 }
 
+BOOST_AUTO_TEST_CASE (test_processor_context_update)
+{
+    processor p;
+    auto n = std::make_shared<sized_sink> ();
+    p.root ()->add (n);
+    BOOST_CHECK_EQUAL (n->block_size, default_block_size);
+
+    p.set_block_size (128);
+    p.set_frame_rate (48000);
+    BOOST_CHECK_EQUAL (p.context ().block_size (), 128);
+    BOOST_CHECK_EQUAL (n->block_size, 128);
+    BOOST_CHECK_EQUAL (n->frame_rate, 48000);
+    p.rt_request_process ();
+
+    p.start ();
+    p.set_block_size (1024);
+    BOOST_CHECK_EQUAL (n->block_size, 128);
+    p.rt_request_process ();
+    BOOST_CHECK_EQUAL (p.context ().block_size (), 1024);
+    BOOST_CHECK_EQUAL (n->block_size, 1024);
+    BOOST_CHECK_EQUAL (n->out.rt_out_range ().size (), 1024);
+
+    // The second change must not undo the pending first one.
+    p.set_block_size (256);
+    p.set_frame_rate (22050);
+    p.rt_request_process ();
+    BOOST_CHECK_EQUAL (p.context ().block_size (), 256);
+    BOOST_CHECK_EQUAL (p.context ().frame_rate (), 22050);
+    BOOST_CHECK_EQUAL (n->block_size, 256);
+    BOOST_CHECK_EQUAL (n->frame_rate, 22050);
+    BOOST_CHECK_EQUAL (n->out.rt_out_range ().size (), 256);
+
+    p.set_frame_rate (44100);
+    p.set_block_size (512);
+    p.set_block_size (64);
+    p.rt_request_process ();
+    BOOST_CHECK_EQUAL (p.context ().block_size (), 64);
+    BOOST_CHECK_EQUAL (p.context ().frame_rate (), 44100);
+    BOOST_CHECK_EQUAL (n->frame_rate, 44100);
+    BOOST_CHECK_EQUAL (n->out.rt_out_range ().size (), 64);
+    p.stop ();
+}
+
+BOOST_AUTO_TEST_CASE (test_processor_full_queue_connect)
+{
+    processor p;
+    auto a = std::make_shared<port_sink> ();
+    auto b = std::make_shared<port_sink> ();
+    p.root ()->add (a);
+    p.root ()->add (b);
+
+    p.start ();
+    b->in.connect (a->out);
+    while (p.context ().push_rt_event (
+               make_rt_event ([] (rt_process_context&) {})));
+
+    // Disconnecting can not be dropped even if the queue is full.
+    b->in.disconnect ();
+    p.rt_request_process ();
+    BOOST_CHECK (!b->in.rt_connected ());
+    p.stop ();
+}
+
 BOOST_AUTO_TEST_SUITE_END ();
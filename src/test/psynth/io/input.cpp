@@ -29,7 +29,10 @@
  */
 
 #include <cstdio>
+#include <condition_variable>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 #include <boost/mpl/list.hpp>
@@ -48,6 +51,7 @@
 #include <psynth/sound/output.hpp>
 #include <psynth/io/input.hpp>
 #include <psynth/io/buffered_input.hpp>
+#include <psynth/io/prefetch_pool.hpp>
 
 #ifdef PSYNTH_HAVE_PCM
 #include <psynth/io/file_input.hpp>
@@ -196,6 +200,109 @@ BOOST_AUTO_TEST_CASE_TEMPLATE (buffered_async_input_test, RangePair,
     do_test_async_buffered_input<src_range, dst_range> () ();
 }
 
+namespace
+{
+
+/** Records the order of the refills in a shared log. */
+struct logging_stream : public psynth::io::prefetch_stream
+{
+    logging_stream (int id, std::vector<int>& log, std::mutex& mutex)
+        : _id (id), _log (log), _mutex (mutex) {}
+
+    void prefetch ()
+    {
+        std::unique_lock<std::mutex> lock (_mutex);
+        _log.push_back (_id);
+    }
+
+    int               _id;
+    std::vector<int>& _log;
+    std::mutex&       _mutex;
+};
+
+/** Keeps the pool thread busy until released. */
+struct blocking_stream : public psynth::io::prefetch_stream
+{
+    blocking_stream () : _running (false), _released (false) {}
+
+    void prefetch ()
+    {
+        std::unique_lock<std::mutex> lock (_mutex);
+        _running = true;
+        _cond.notify_all ();
+        while (!_released)
+            _cond.wait (lock);
+    }
+
+    void wait_running ()
+    {
+        std::unique_lock<std::mutex> lock (_mutex);
+        while (!_running)
+            _cond.wait (lock);
+    }
+
+    void release ()
+    {
+        std::unique_lock<std::mutex> lock (_mutex);
+        _released = true;
+        _cond.notify_all ();
+    }
+
+    bool                    _running;
+    bool                    _released;
+    std::mutex              _mutex;
+    std::condition_variable _cond;
+};
+
+} /* anonymous namespace */
+
+BOOST_AUTO_TEST_CASE (prefetch_pool_test)
+{
+    using namespace psynth;
+    typedef io::prefetch_pool_impl::clock clock;
+
+    io::prefetch_pool_impl pool (1);
+    std::vector<int> log;
+    std::mutex log_mutex;
+
+    blocking_stream blocker;
+    logging_stream a (0, log, log_mutex);
+    logging_stream b (1, log, log_mutex);
+    logging_stream c (2, log, log_mutex);
+
+    const clock::time_point now = clock::now ();
+    pool.request (blocker, now);
+    blocker.wait_running ();
+
+    // Served by time to underrun and merged when repeated
+    pool.request (a, now + std::chrono::milliseconds (30));
+    pool.request (b, now + std::chrono::milliseconds (10));
+    pool.request (c, now + std::chrono::milliseconds (20));
+    pool.request (a, now + std::chrono::milliseconds (5));
+    pool.request (b, now + std::chrono::milliseconds (50));
+    BOOST_CHECK_EQUAL (pool.pending (), 3);
+
+    blocker.release ();
+    while (pool.pending ())
+        std::this_thread::yield ();
+
+    // Waits for the refill in progress
+    pool.cancel (blocker);
+    pool.cancel (a);
+    pool.cancel (b);
+    pool.cancel (c);
+    pool.set_num_threads (2);
+
+    std::unique_lock<std::mutex> lock (log_mutex);
+    BOOST_CHECK_EQUAL (log.size (), 3);
+    if (log.size () == 3)
+    {
+        BOOST_CHECK_EQUAL (log [0], 0);
+        BOOST_CHECK_EQUAL (log [1], 1);
+        BOOST_CHECK_EQUAL (log [2], 2);
+    }
+}
+
 #ifdef PSYNTH_HAVE_PCM
 
 typedef mpl::filter_view<input_test_types,
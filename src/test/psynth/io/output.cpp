@@ -27,6 +27,8 @@
  */
 
 #include <cstdio>
+#include <cstdlib>
+#include <utility>
 #include <thread>
 
 #include <boost/test/unit_test.hpp>
@@ -218,6 +220,95 @@ BOOST_AUTO_TEST_CASE_TEMPLATE (buffered_async_output_test, RangePair,
     do_test_async_buffered_output<src_range, dst_range> () ();
 }
 
+BOOST_AUTO_TEST_CASE (deadline_monitor_test)
+{
+    using namespace psynth;
+
+    io::deadline_monitor mon;
+
+    // Without frame rate only callbacks are counted
+    mon.begin_callback ();
+    mon.end_callback (64);
+    BOOST_CHECK_EQUAL (mon.stats ().callbacks, 1);
+    BOOST_CHECK_EQUAL (mon.stats ().max_load, 0);
+
+    mon.set_frame_rate (1000);
+    mon.begin_callback ();
+    mon.end_callback (1000);
+    mon.begin_callback ();
+    std::this_thread::sleep_for (std::chrono::milliseconds (5));
+    mon.end_callback (1);
+    mon.add_xrun ();
+    mon.add_recovery ();
+
+    io::deadline_stats stats = mon.stats ();
+    BOOST_CHECK_EQUAL (stats.callbacks, 3);
+    BOOST_CHECK_EQUAL (stats.late, 1);
+    BOOST_CHECK_EQUAL (stats.xruns, 1);
+    BOOST_CHECK_EQUAL (stats.recoveries, 1);
+    BOOST_CHECK (stats.max_load >= 5);
+    BOOST_CHECK_EQUAL (stats.headroom [io::deadline_stats::headroom_buckets - 2], 1);
+    BOOST_CHECK_EQUAL (stats.headroom [io::deadline_stats::headroom_buckets - 1], 1);
+
+    mon.reset_stats ();
+    stats = mon.stats ();
+    BOOST_CHECK_EQUAL (stats.callbacks, 0);
+    BOOST_CHECK_EQUAL (stats.late, 0);
+    BOOST_CHECK_EQUAL (stats.headroom [io::deadline_stats::headroom_buckets - 1], 0);
+}
+
+BOOST_AUTO_TEST_CASE (dithering_output_test)
+{
+    using namespace psynth;
+
+    typedef sound::stereo32sf_range src_range;
+    typedef sound::stereo16s_range  dst_range;
+
+    const std::size_t buffer_size = 512;
+
+    sound::stereo32sf_buffer buf (buffer_size);
+    sound::stereo16s_buffer  plain (buffer_size);
+    for (std::size_t i = 0; i < buffer_size; ++i)
+        range (buf) [i] = sound::stereo32sf_frame (
+            float (i) / buffer_size - .5f, .5f - float (i) / buffer_size);
+    copy_and_convert_frames (range (buf), range (plain));
+
+    io::buffered_output<src_range, io::dummy_output<dst_range>,
+                        sound::dither_converter> out;
+    out.set_buffer_size (buffer_size);
+
+    // Without dither it is the usual conversion
+    out.set_dither_mode (sound::dither_mode::none);
+    out.put (range (buf));
+    BOOST_CHECK (equal_frames (const_range (plain), const_range (out.buffer ())));
+
+    // The noise never moves a sample more than one step, or a few
+    // with noise shaping
+    const std::pair<sound::dither_mode, int> modes [] = {
+        { sound::dither_mode::tpdf, 1 },
+        { sound::dither_mode::shaped, 6 }
+    };
+    for (auto m : modes)
+    {
+        out.set_dither_mode (m.first);
+        out.put (range (buf));
+
+        int max_error = 0;
+        bool changed = false;
+        for (std::size_t i = 0; i < buffer_size; ++i)
+            for (int k = 0; k < 2; ++k)
+            {
+                const int error = std::abs (
+                    int (const_range (out.buffer ()) [i][k]) -
+                    int (const_range (plain) [i][k]));
+                max_error = std::max (max_error, error);
+                changed = changed || error;
+            }
+        BOOST_CHECK (max_error <= m.second);
+        BOOST_CHECK (changed);
+    }
+}
+
 #ifdef PSYNTH_HAVE_ALSA
 
 typedef mpl::filter_view<output_test_types,
@@ -0,0 +1,163 @@
+/**
+ *  @file        sample_cache.cpp
+ *  @author      Juan Pedro Bolívar Puente <raskolnikov@es.gnu.org>
+ *  @date        Tue Jul 12 19:02:51 2011
+ *
+ *  @brief Tests for the sample cache.
+ */
+
+/*
+ *  Copyright (C) 2011 Juan Pedro Bolívar Puente
+ *
+ *  This file is part of Psychosynth.
+ *
+ *  Psychosynth is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  Psychosynth is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <psynth/version.hpp>
+#include <psynth/base/scope_guard.hpp>
+#include <psynth/sound/buffer.hpp>
+#include <psynth/io/sample_cache.hpp>
+
+#ifdef PSYNTH_HAVE_WAV
+#include <psynth/io/file_output.hpp>
+#endif
+
+BOOST_AUTO_TEST_SUITE (io_sample_cache_test_suite);
+
+using namespace psynth;
+namespace fs = boost::filesystem;
+
+namespace
+{
+
+/** A sample whose frames are 0, 1, 2... on the left channel. */
+io::sample_data_ptr make_ramp (std::size_t length)
+{
+    sound::stereo32sf_planar_buffer buf (length);
+    for (std::size_t i = 0; i < length; ++i)
+    {
+        range (buf) [i][0] = float (i);
+        range (buf) [i][1] = -float (i);
+    }
+    return io::sample_data_ptr (
+        new io::sample_data (44100, const_range (buf)));
+}
+
+} /* anonymous namespace */
+
+BOOST_AUTO_TEST_CASE (sample_cursor_forward_test)
+{
+    io::sample_cursor cursor;
+    sound::stereo32sf_buffer buf (5);
+    BOOST_CHECK (cursor.empty ());
+    BOOST_CHECK_EQUAL (cursor.take (range (buf)), 0);
+
+    io::sample_data_ptr data = make_ramp (3);
+    cursor.swap_data (data);
+    BOOST_CHECK (!data);
+    BOOST_CHECK_EQUAL (cursor.frame_rate (), 44100);
+
+    BOOST_CHECK_EQUAL (cursor.take (range (buf)), 5);
+    const float expected [] = { 0, 1, 2, 0, 1 };
+    for (std::size_t i = 0; i < 5; ++i)
+    {
+        BOOST_CHECK_EQUAL (float (range (buf) [i][0]), expected [i]);
+        BOOST_CHECK_EQUAL (float (range (buf) [i][1]), -expected [i]);
+    }
+    BOOST_CHECK_EQUAL (cursor.position (), 2);
+}
+
+BOOST_AUTO_TEST_CASE (sample_cursor_backwards_test)
+{
+    io::sample_cursor cursor;
+    io::sample_data_ptr data = make_ramp (3);
+    cursor.swap_data (data);
+    cursor.set_backwards (true);
+
+    sound::stereo32sf_buffer buf (5);
+    BOOST_CHECK_EQUAL (cursor.take (range (buf)), 5);
+    const float expected [] = { 2, 1, 0, 2, 1 };
+    for (std::size_t i = 0; i < 5; ++i)
+        BOOST_CHECK_EQUAL (float (range (buf) [i][0]), expected [i]);
+
+    cursor.set_backwards (false);
+    BOOST_CHECK_EQUAL (cursor.take (sub_range (range (buf), 0, 2)), 2);
+    BOOST_CHECK_EQUAL (float (range (buf) [0][0]), 1);
+    BOOST_CHECK_EQUAL (float (range (buf) [1][0]), 2);
+}
+
+BOOST_AUTO_TEST_CASE (sample_cache_missing_test)
+{
+    io::sample_cache_impl cache;
+    BOOST_CHECK_THROW (cache.get ("/this/does/not/exist.wav"),
+                       io::file_error);
+    BOOST_CHECK_EQUAL (cache.size (), 0);
+}
+
+#ifdef PSYNTH_HAVE_WAV
+
+BOOST_AUTO_TEST_CASE (sample_cache_share_test)
+{
+    const fs::path dir = fs::temp_directory_path () /
+        fs::unique_path ("psynth-sample-cache-%%%%%%%%");
+    const fs::path file = dir / "ramp.wav";
+    PSYNTH_ON_BLOCK_EXIT ([&] { fs::remove_all (dir); });
+    fs::create_directories (dir);
+
+    const std::size_t length = 1000;
+    io::sample_data_ptr ramp = make_ramp (length);
+    {
+        sound::stereo32sf_buffer buf (length);
+        copy_frames (ramp->range (), range (buf));
+        io::file_output<sound::stereo32sf_range> out (
+            file.string (), io::file_fmt::wav, 44100);
+        out.put (range (buf));
+    }
+
+    {
+        io::sample_cache_impl cache;
+        io::sample_data_ptr a = cache.get (file.string ());
+        io::sample_data_ptr b = cache.get (file.string ());
+        BOOST_CHECK_EQUAL (a, b);
+        BOOST_CHECK_EQUAL (cache.size (), 1);
+        BOOST_CHECK (!a->is_mapped ());
+        BOOST_CHECK_EQUAL (a->length (), length);
+        BOOST_CHECK_EQUAL (a->frame_rate (), 44100);
+        BOOST_CHECK (equal_frames (a->range (), ramp->range ()));
+
+        a.reset ();
+        b.reset ();
+        BOOST_CHECK_EQUAL (cache.size (), 0);
+    }
+
+    // Spilled to the disk and mapped again by a later cache
+    for (int i = 0; i < 2; ++i)
+    {
+        io::sample_cache_impl cache;
+        cache.set_disk_path (dir / "cache");
+        io::sample_data_ptr a = cache.get (file.string ());
+        BOOST_CHECK (a->is_mapped ());
+        BOOST_CHECK_EQUAL (a->length (), length);
+        BOOST_CHECK (equal_frames (a->range (), ramp->range ()));
+    }
+}
+
+#endif /* PSYNTH_HAVE_WAV */
+
+BOOST_AUTO_TEST_SUITE_END ();
@@ -79,6 +79,7 @@
 
 #include <psynth/sound/typedefs.hpp>
 #include <psynth/sound/output.hpp>
+#include <psynth/sound/buffer_allocator.hpp>
 
 using namespace psynth::sound;
 using namespace std;
@@ -642,4 +643,88 @@ BOOST_AUTO_TEST_CASE (test_buffer_static_checks)
     }
 }
 
+typedef mpl::vector<bits8, bits16s, bits32sf> copy_frames_test_types;
+
+BOOST_AUTO_TEST_CASE_TEMPLATE (test_copy_frames_layouts, Sample,
+                               copy_frames_test_types)
+{
+    typedef frame<Sample, stereo_layout>   stereo_frame;
+    typedef frame<Sample, rlstereo_layout> rlstereo_frame;
+
+    // Not a multiple of the vector size, so the last frames are
+    // copied one by one.
+    const std::size_t size = 37;
+    buffer<stereo_frame, false>   src (size);
+    buffer<stereo_frame, false>   dst (size);
+    buffer<rlstereo_frame, false> rl (size);
+    buffer<stereo_frame, true>    planar (size);
+
+    for (std::size_t i = 0; i < size; ++i)
+        range (src) [i] = stereo_frame (Sample (i), Sample (100 - i));
+
+    // Every copy below must take the vectorized kernels.
+    typedef typename buffer<stereo_frame, false>::const_range   src_range;
+    typedef typename buffer<rlstereo_frame, false>::range       rl_range;
+    typedef typename buffer<rlstereo_frame, false>::const_range rl_const_range;
+    typedef typename buffer<stereo_frame, true>::range          planar_range;
+    typedef typename buffer<stereo_frame, true>::const_range    planar_const_range;
+    typedef typename buffer<stereo_frame, false>::range         dst_range;
+    namespace detail = psynth::sound::detail;
+    BOOST_CHECK ((detail::has_simd_copy_frames<src_range, rl_range>::value));
+    BOOST_CHECK ((detail::has_simd_copy_frames<
+                      rl_const_range, planar_range>::value));
+    BOOST_CHECK ((detail::has_simd_copy_frames<
+                      planar_const_range, dst_range>::value));
+
+    copy_frames (const_range (src), range (rl));
+    copy_frames (const_range (rl), range (planar));
+    copy_frames (const_range (planar), range (dst));
+
+    BOOST_CHECK (equal_frames (const_range (src), const_range (dst)));
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        BOOST_CHECK (at_c<0> (range (rl) [i]) == Sample (100 - i));
+        BOOST_CHECK (at_c<1> (range (rl) [i]) == Sample (i));
+        BOOST_CHECK (stereo_frame (range (planar) [i]) == range (src) [i]);
+    }
+}
+
+BOOST_AUTO_TEST_CASE (test_buffer_allocators)
+{
+    typedef buffer<stereo32sf_frame, true,
+                   aligned_allocator<unsigned char> > aligned_buffer;
+    typedef buffer<stereo32sf_frame, true,
+                   arena_allocator<unsigned char> > arena_buffer;
+
+    // An odd size, so the second plane needs padding.
+    const std::size_t size = 37;
+    aligned_buffer abuf (size);
+    for (std::size_t i = 0; i < 2; ++i)
+        BOOST_CHECK_EQUAL (
+            std::size_t (planar_range_get_raw_data (range (abuf), i))
+            % cache_line_size, 0);
+
+    buffer_arena_ptr arena = std::make_shared<buffer_arena> ();
+    {
+        arena_buffer a (size, 0, arena);
+        arena_buffer b (size, 0, arena);
+        BOOST_CHECK_EQUAL (arena->num_slabs (), 1);
+        BOOST_CHECK_EQUAL (arena->in_use () % cache_line_size, 0);
+        BOOST_CHECK (arena->in_use () >= 2 * 2 * size * sizeof (bits32sf));
+
+        const std::size_t end = std::size_t (
+            planar_range_get_raw_data (range (a), 1) + size);
+        const std::size_t next = std::size_t (
+            planar_range_get_raw_data (range (b), 0));
+        BOOST_CHECK (next >= end);
+        BOOST_CHECK_EQUAL (next % cache_line_size, 0);
+    }
+    BOOST_CHECK_EQUAL (arena->in_use (), 0);
+
+    arena_buffer heap (size);
+    BOOST_CHECK_EQUAL (
+        std::size_t (planar_range_get_raw_data (range (heap), 0))
+        % cache_line_size, 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END ();
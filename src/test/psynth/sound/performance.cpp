@@ -68,6 +68,7 @@
 #include <psynth/sound/buffer.hpp>
 #include <psynth/sound/typedefs.hpp>
 #include <psynth/sound/algorithm.hpp>
+#include <psynth/sound/channel_convert.hpp>
 #include <psynth/sound/output.hpp>
 
 using namespace psynth::sound;
@@ -674,6 +675,71 @@ void test_transform (std::size_t trials)
     BOOST_CHECK (equal_frames (range (bufp2), range (bufn2)));
 }
 
+// copy_and_convert()
+template <typename Range1, typename Range2>
+struct copy_and_convert_psynth
+{
+    Range1 _v1;
+    Range2 _v2;
+
+    copy_and_convert_psynth (const Range1& v1_in, const Range2& v2_in)
+	: _v1 (v1_in), _v2 (v2_in) {}
+
+    void operator () () const
+    {
+	copy_and_convert_frames (_v1, _v2);
+    }
+};
+
+// the converted range hides the frame types so no kernel is used
+template <typename Range1, typename Range2>
+struct copy_and_convert_generic
+{
+    Range1 _v1;
+    Range2 _v2;
+
+    copy_and_convert_generic (const Range1& v1_in, const Range2& v2_in)
+	: _v1 (v1_in), _v2 (v2_in) {}
+
+    void operator () () const
+    {
+	copy_frames (
+	    channel_converted_range<typename Range2::value_type> (_v1), _v2);
+    }
+};
+
+template <typename Range1, typename Range2>
+void test_copy_and_convert (std::size_t trials)
+{
+    // not a multiple of the vector width so the tails run too
+    const std::size_t size = buffer_size - 3;
+
+    stereo32sf_planar_buffer ramp (size);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+	const float x = -1.0f + 2.0f * i / (size - 1);
+	range (ramp) [i] = stereo32sf_frame (x, -x * 0.7f);
+    }
+
+    buffer<typename Range1::value_type,is_planar<Range1>::value> buf1 (size);
+    buffer<typename Range2::value_type,is_planar<Range2>::value> bufp (size);
+    buffer<typename Range2::value_type,is_planar<Range2>::value> bufn (size);
+    copy_and_convert_generic<stereo32sf_planar_range, Range1> (
+	range (ramp), range (buf1)) ();
+
+    BOOST_TEST_MESSAGE (
+	"kernel: " << measure_time (
+	    copy_and_convert_psynth<Range1, Range2> (
+		range (buf1), range (bufp)), trials));
+
+    BOOST_TEST_MESSAGE (
+	"generic: " << measure_time (
+	    copy_and_convert_generic<Range1, Range2> (
+		range (buf1), range (bufn)), trials));
+
+    BOOST_CHECK (equal_frames (range (bufp), range (bufn)));
+}
+
 BOOST_AUTO_TEST_SUITE (sound_performance_test_suite);
 
 BOOST_AUTO_TEST_CASE (test_fill_frames_performance)
@@ -728,6 +794,34 @@ BOOST_AUTO_TEST_CASE (test_copy_frames_performance)
     test_copy<stereo8_planar_range,stereo8_range>(num_trials);
 }
 
+BOOST_AUTO_TEST_CASE (test_copy_and_convert_frames_performance)
+{
+    BOOST_TEST_MESSAGE (
+	"Test copy_and_convert_frames() between stereo32sf_planar_buffer and "
+	"stereo16s_buffer");
+    test_copy_and_convert<stereo32sf_planar_range, stereo16s_range>(num_trials);
+
+    BOOST_TEST_MESSAGE (
+	"Test copy_and_convert_frames() between stereo32sf_planar_buffer and "
+	"stereo32s_buffer");
+    test_copy_and_convert<stereo32sf_planar_range, stereo32s_range>(num_trials);
+
+    BOOST_TEST_MESSAGE (
+	"Test copy_and_convert_frames() between stereo16s_buffer and "
+	"stereo32sf_planar_buffer");
+    test_copy_and_convert<stereo16s_range, stereo32sf_planar_range>(num_trials);
+
+    BOOST_TEST_MESSAGE (
+	"Test copy_and_convert_frames() between stereo32sf_buffer and "
+	"stereo32sf_planar_buffer");
+    test_copy_and_convert<stereo32sf_range, stereo32sf_planar_range>(num_trials);
+
+    BOOST_TEST_MESSAGE (
+	"Test copy_and_convert_frames() between stereo32sf_planar_buffer and "
+	"stereo32sf_buffer");
+    test_copy_and_convert<stereo32sf_planar_range, stereo32sf_range>(num_trials);
+}
+
 BOOST_AUTO_TEST_CASE (test_transform_frames_performance)
 {
     BOOST_TEST_MESSAGE (
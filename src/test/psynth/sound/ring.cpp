@@ -29,6 +29,7 @@
  */
 
 #include <iostream>
+#include <thread>
 
 #include <boost/test/unit_test.hpp>
 
@@ -37,6 +38,7 @@
 
 #include <psynth/sound/dynamic_ring_buffer.hpp>
 #include <psynth/sound/ring_buffer.hpp>
+#include <psynth/sound/spsc_ring_buffer.hpp>
 
 using namespace psynth::sound;
 
@@ -102,6 +104,31 @@ BOOST_AUTO_TEST_CASE (test_ring_buffer_iterator)
 
 }
 
+BOOST_AUTO_TEST_CASE (test_ring_buffer_backwards)
+{
+    stereo32sf_planar_buffer buf (buffer_size);
+    stereo32sf_ring_buffer rring (buffer_size * 1.3);
+    stereo32sf_ring_buffer::range ring (range (rring));
+    ring.set_backwards ();
+    auto reader = ring.begin_pos ();
+
+    // Blocks are stored as given but read from their end.
+    ring.write (sample_range);
+    ring.read (reader, range (buf));
+    BOOST_CHECK (equal_frames (range (buf), flipped_range (sample_range)));
+
+    // The data wraps around the beginning of the buffer now.
+    ring.write (sample_range);
+    BOOST_CHECK_EQUAL (ring.read (reader, range (buf), buffer_size / 2),
+                       (std::ptrdiff_t) buffer_size / 2);
+    BOOST_CHECK_EQUAL (ring.read_and_convert (
+                           reader,
+                           sub_range (range (buf), buffer_size / 2,
+                                      buffer_size / 2)),
+                       (std::ptrdiff_t) buffer_size / 2);
+    BOOST_CHECK (equal_frames (range (buf), flipped_range (sample_range)));
+}
+
 typedef
 dynamic_buffer<boost::mpl::vector<
 		   mono8_buffer, stereo16_planar_buffer> > some_buffer;
@@ -146,4 +173,90 @@ BOOST_AUTO_TEST_CASE (test_dynamic_ring_buffer)
 				       sample_range))));
 }
 
+BOOST_AUTO_TEST_CASE (test_spsc_ring_buffer)
+{
+    stereo32sf_planar_buffer buf (buffer_size);
+    fill_frames (range (buf), stereo32sf_frame (.0f));
+
+    stereo32sf_planar_spsc_ring_buffer rring (buffer_size * 1.3);
+    auto& ring = range (rring);
+
+    BOOST_CHECK_EQUAL (ring.write (sample_range), (std::ptrdiff_t) buffer_size);
+    BOOST_CHECK_EQUAL (ring.read (range (buf)), (std::ptrdiff_t) buffer_size);
+    BOOST_CHECK (equal_frames (range (buf), sample_range));
+    BOOST_CHECK_EQUAL (ring.read_available (), 0);
+
+    // The data wraps around the end of the buffer now.
+    ring.write (sample_range);
+    BOOST_CHECK_EQUAL (ring.read_available (), (std::ptrdiff_t) buffer_size);
+    BOOST_CHECK_EQUAL (
+        ring.sub_buffer_one (buffer_size).size () +
+        ring.sub_buffer_two (buffer_size).size (),
+        (std::ptrdiff_t) buffer_size);
+    ring.read (range (buf));
+    BOOST_CHECK (equal_frames (range (buf), sample_range));
+
+    // Unread data is never overwritten.
+    ring.write (sample_range);
+    BOOST_CHECK_EQUAL (ring.write (sample_range),
+                       ring.size () - (std::ptrdiff_t) buffer_size);
+    BOOST_CHECK_EQUAL (ring.write_available (), 0);
+    ring.read (range (buf));
+    BOOST_CHECK (equal_frames (range (buf), sample_range));
+}
+
+BOOST_AUTO_TEST_CASE (test_spsc_ring_buffer_threads)
+{
+    const std::size_t total_frames = 1 << 20;
+    const std::size_t max_chunk    = 97;
+
+    mono32sf_spsc_ring_buffer rring (331);
+    auto& ring = range (rring);
+
+    std::thread producer ([&] {
+            mono32sf_buffer buf (max_chunk);
+            std::size_t written = 0;
+            std::size_t chunk   = 1;
+            while (written < total_frames) {
+                chunk = (chunk * 7 + 3) % max_chunk + 1;
+                const std::size_t n = std::min (chunk, total_frames - written);
+                for (std::size_t i = 0; i < n; ++i)
+                    range (buf) [i] = mono32sf_frame (float (written + i));
+
+                std::size_t done = 0;
+                while (done < n) {
+                    const std::size_t count = ring.write (
+                        sub_range (range (buf), done, n - done));
+                    if (!count)
+                        std::this_thread::yield ();
+                    done += count;
+                }
+                written += n;
+            }
+        });
+
+    std::size_t errors = 0;
+    std::thread consumer ([&] {
+            mono32sf_buffer buf (max_chunk);
+            std::size_t read  = 0;
+            std::size_t chunk = 1;
+            while (read < total_frames) {
+                chunk = (chunk * 5 + 1) % max_chunk + 1;
+                const std::size_t count = ring.read (range (buf), chunk);
+                if (!count)
+                    std::this_thread::yield ();
+                for (std::size_t i = 0; i < count; ++i)
+                    if (!(range (buf) [i] == mono32sf_frame (float (read + i))))
+                        ++ errors;
+                read += count;
+            }
+        });
+
+    producer.join ();
+    consumer.join ();
+
+    BOOST_CHECK_EQUAL (errors, 0);
+    BOOST_CHECK_EQUAL (ring.read_available (), 0);
+}
+
 BOOST_AUTO_TEST_SUITE_END ();